@@ -31,7 +31,6 @@ main(int argc, char **argv)
 
     struct stat stats;
     int stats_res;
-    c2b_pipeset_t pipes;
 
     /* setup */
     c2b_init_globals();
@@ -48,14 +47,15 @@ main(int argc, char **argv)
         c2b_print_usage(stderr);
         return ENODATA; /* No message is available on the STREAM head read queue (POSIX.1) */
     }
+    c2b_init_global_src_map(&stats);
+    c2b_set_pipe_capacity(STDIN_FILENO, c2b_pipe_capacity());
+    c2b_set_pipe_capacity(STDOUT_FILENO, c2b_pipe_capacity());
     c2b_test_dependencies();
-    c2b_init_pipeset(&pipes, MAX_PIPES);
 
     /* convert */
-    c2b_init_conversion(&pipes);
+    c2b_init_conversion();
 
     /* clean-up */
-    c2b_delete_pipeset(&pipes);
     c2b_delete_globals();
 
 #ifdef DEBUG
@@ -65,7 +65,7 @@ main(int argc, char **argv)
 }
 
 static void
-c2b_init_conversion(c2b_pipeset_t *p)
+c2b_init_conversion()
 {
 #ifdef DEBUG
     fprintf(stderr, "--- c2b_init_conversion() - enter ---\n");
@@ -74,31 +74,31 @@ c2b_init_conversion(c2b_pipeset_t *p)
     switch(c2b_globals.input_format_idx)
         {
         case BAM_FORMAT:
-            c2b_init_bam_conversion(p);
+            c2b_init_bam_conversion();
             break;
         case GFF_FORMAT:
-            c2b_init_gff_conversion(p);
+            c2b_init_gff_conversion();
             break;
         case GTF_FORMAT:
-            c2b_init_gtf_conversion(p);
+            c2b_init_gtf_conversion();
             break;
         case GVF_FORMAT:
-            c2b_init_gvf_conversion(p);
+            c2b_init_gvf_conversion();
             break;
         case PSL_FORMAT:
-            c2b_init_psl_conversion(p);
+            c2b_init_psl_conversion();
             break;
         case RMSK_FORMAT:
-            c2b_init_rmsk_conversion(p);
+            c2b_init_rmsk_conversion();
             break;
         case SAM_FORMAT:
-            c2b_init_sam_conversion(p);
+            c2b_init_sam_conversion();
             break;
         case VCF_FORMAT:
-            c2b_init_vcf_conversion(p);
+            c2b_init_vcf_conversion();
             break;
         case WIG_FORMAT:
-            c2b_init_wig_conversion(p);
+            c2b_init_wig_conversion();
             break;
         default:
             fprintf(stderr, "Error: Currently unsupported format\n");
@@ -112,782 +112,363 @@ c2b_init_conversion(c2b_pipeset_t *p)
 }
 
 static void
-c2b_init_gff_conversion(c2b_pipeset_t *p)
+c2b_init_gff_conversion()
 {
-    c2b_init_generic_conversion(p, &c2b_line_convert_gff_to_bed_unsorted);
+    c2b_init_generic_conversion(&c2b_block_convert_gff_to_bed_unsorted);
 }
 
 static void
-c2b_init_gtf_conversion(c2b_pipeset_t *p)
+c2b_init_gtf_conversion()
 {
-    c2b_init_generic_conversion(p, &c2b_line_convert_gtf_to_bed_unsorted);
+    c2b_init_generic_conversion(&c2b_block_convert_gtf_to_bed_unsorted);
 }
 
 static void
-c2b_init_gvf_conversion(c2b_pipeset_t *p)
+c2b_init_gvf_conversion()
 {
-    /* GVF format conversion uses the GFF functor */
-    c2b_init_generic_conversion(p, &c2b_line_convert_gff_to_bed_unsorted);
+    /* GVF format conversion uses the GFF converter */
+    c2b_init_generic_conversion(&c2b_block_convert_gff_to_bed_unsorted);
 }
 
 static void
-c2b_init_psl_conversion(c2b_pipeset_t *p)
+c2b_init_psl_conversion()
 {
-    c2b_init_generic_conversion(p, &c2b_line_convert_psl_to_bed_unsorted);
+    c2b_init_generic_conversion(&c2b_block_convert_psl_to_bed_unsorted);
 }
 
 static void
-c2b_init_rmsk_conversion(c2b_pipeset_t *p)
+c2b_init_rmsk_conversion()
 {
-    c2b_init_generic_conversion(p, &c2b_line_convert_rmsk_to_bed_unsorted);
+    c2b_init_generic_conversion(&c2b_block_convert_rmsk_to_bed_unsorted);
 }
 
 static void
-c2b_init_sam_conversion(c2b_pipeset_t *p)
+c2b_init_sam_conversion()
 {
-    c2b_init_generic_conversion(p, (!c2b_globals.split_flag ?
-                                    &c2b_line_convert_sam_to_bed_unsorted_without_split_operation :
-                                    &c2b_line_convert_sam_to_bed_unsorted_with_split_operation));
+    c2b_init_generic_conversion((!c2b_globals.split_flag ?
+                                    &c2b_block_convert_sam_to_bed_unsorted_without_split_operation :
+                                    &c2b_block_convert_sam_to_bed_unsorted_with_split_operation));
 }
 
 static void
-c2b_init_vcf_conversion(c2b_pipeset_t *p)
+c2b_init_vcf_conversion()
 {
-    c2b_init_generic_conversion(p, &c2b_line_convert_vcf_to_bed_unsorted);
+    c2b_init_generic_conversion(&c2b_block_convert_vcf_to_bed_unsorted);
 }
 
 static void
-c2b_init_wig_conversion(c2b_pipeset_t *p)
+c2b_init_wig_conversion()
 {
-    c2b_init_generic_conversion(p, &c2b_line_convert_wig_to_bed_unsorted);
+    c2b_init_generic_conversion(&c2b_block_convert_wig_to_bed_unsorted);
 }
 
 static void
-c2b_init_generic_conversion(c2b_pipeset_t *p, void(*to_bed_line_functor)(char *, ssize_t *, char *, ssize_t))
+c2b_init_generic_conversion(void(*to_bed_block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *))
 {
 #ifdef DEBUG
     fprintf(stderr, "--- c2b_init_generic_conversion() - enter ---\n");
 #endif
 
-    pthread_t cat2generic_thread; 
-    pthread_t generic2bed_unsorted_thread; 
-    pthread_t bed_unsorted2stdout_thread;
-    pthread_t bed_unsorted2bed_sorted_thread;
-    pthread_t bed_sorted2stdout_thread;
-    pthread_t bed_sorted2starch_thread;
-    pthread_t starch2stdout_thread;
-    c2b_pipeline_stage_t cat2generic_stage;
-    c2b_pipeline_stage_t generic2bed_unsorted_stage;
-    c2b_pipeline_stage_t bed_unsorted2stdout_stage;
-    c2b_pipeline_stage_t bed_unsorted2bed_sorted_stage;
-    c2b_pipeline_stage_t bed_sorted2stdout_stage;
-    c2b_pipeline_stage_t bed_sorted2starch_stage;
-    c2b_pipeline_stage_t starch2stdout_stage;
-    char cat2generic_cmd[C2B_MAX_LINE_LENGTH_VALUE];
-    char bed_unsorted2bed_sorted_cmd[C2B_MAX_LINE_LENGTH_VALUE];
-    char bed_sorted2starch_cmd[C2B_MAX_LINE_LENGTH_VALUE];
-    void (*generic2bed_unsorted_line_functor)(char *, ssize_t *, char *, ssize_t) = to_bed_line_functor;
-    int errsv = 0;
-
-    if ((!c2b_globals.sort->is_enabled) && (c2b_globals.output_format_idx == BED_FORMAT)) {
-        cat2generic_stage.pipeset = p;
-        cat2generic_stage.line_functor = NULL;
-        cat2generic_stage.src = -1;
-        cat2generic_stage.dest = 0;
-        cat2generic_stage.description = "Generic data from stdin";
-        cat2generic_stage.pid = 0;
-        cat2generic_stage.status = 0;
-        
-        generic2bed_unsorted_stage.pipeset = p;
-        generic2bed_unsorted_stage.line_functor = generic2bed_unsorted_line_functor;
-        generic2bed_unsorted_stage.src = 0;
-        generic2bed_unsorted_stage.dest = 1;
-        generic2bed_unsorted_stage.description = "Generic data to unsorted BED";
-        generic2bed_unsorted_stage.pid = 0;
-        generic2bed_unsorted_stage.status = 0;
-
-        bed_unsorted2stdout_stage.pipeset = p;
-        bed_unsorted2stdout_stage.line_functor = NULL;
-        bed_unsorted2stdout_stage.src = 1;
-        bed_unsorted2stdout_stage.dest = -1;
-        bed_unsorted2stdout_stage.description = "Unsorted BED to stdout";
-        bed_unsorted2stdout_stage.pid = 0;
-        bed_unsorted2stdout_stage.status = 0;
-    }
-    else if (c2b_globals.output_format_idx == BED_FORMAT) {
-        cat2generic_stage.pipeset = p;
-        cat2generic_stage.line_functor = NULL;
-        cat2generic_stage.src = -1;
-        cat2generic_stage.dest = 0;
-        cat2generic_stage.description = "Generic data from stdin"; 
-        cat2generic_stage.pid = 0;
-        cat2generic_stage.status = 0;
-        
-        generic2bed_unsorted_stage.pipeset = p;
-        generic2bed_unsorted_stage.line_functor = generic2bed_unsorted_line_functor;
-        generic2bed_unsorted_stage.src = 0;
-        generic2bed_unsorted_stage.dest = 1;
-        generic2bed_unsorted_stage.description = "Generic data to unsorted BED";
-        generic2bed_unsorted_stage.pid = 0;
-        generic2bed_unsorted_stage.status = 0;
-        
-        bed_unsorted2bed_sorted_stage.pipeset = p;
-        bed_unsorted2bed_sorted_stage.line_functor = NULL;
-        bed_unsorted2bed_sorted_stage.src = 1;
-        bed_unsorted2bed_sorted_stage.dest = 2;
-        bed_unsorted2bed_sorted_stage.description = "Unsorted BED to sorted BED";
-        bed_unsorted2bed_sorted_stage.pid = 0;
-        bed_unsorted2bed_sorted_stage.status = 0;
-
-        bed_sorted2stdout_stage.pipeset = p;
-        bed_sorted2stdout_stage.line_functor = NULL;
-        bed_sorted2stdout_stage.src = 2;
-        bed_sorted2stdout_stage.dest = -1;
-        bed_sorted2stdout_stage.description = "Sorted BED to stdout";
-        bed_sorted2stdout_stage.pid = 0;
-        bed_sorted2stdout_stage.status = 0;
-    }
-    else if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        cat2generic_stage.pipeset = p;
-        cat2generic_stage.line_functor = NULL;
-        cat2generic_stage.src = -1;
-        cat2generic_stage.dest = 0;
-        cat2generic_stage.description = "Generic data from stdin";
-        cat2generic_stage.pid = 0;
-        cat2generic_stage.status = 0;
-        
-        generic2bed_unsorted_stage.pipeset = p;
-        generic2bed_unsorted_stage.line_functor = generic2bed_unsorted_line_functor;
-        generic2bed_unsorted_stage.src = 0;
-        generic2bed_unsorted_stage.dest = 1;
-        generic2bed_unsorted_stage.description = "Generic data to unsorted BED";
-        generic2bed_unsorted_stage.pid = 0;
-        generic2bed_unsorted_stage.status = 0;
-
-        bed_unsorted2bed_sorted_stage.pipeset = p;
-        bed_unsorted2bed_sorted_stage.line_functor = NULL;
-        bed_unsorted2bed_sorted_stage.src = 1;
-        bed_unsorted2bed_sorted_stage.dest = 2;
-        bed_unsorted2bed_sorted_stage.description = "Unsorted BED to sorted BED";
-        bed_unsorted2bed_sorted_stage.pid = 0;
-        bed_unsorted2bed_sorted_stage.status = 0;
-
-        bed_sorted2starch_stage.pipeset = p;
-        bed_sorted2starch_stage.line_functor = NULL;
-        bed_sorted2starch_stage.src = 2;
-        bed_sorted2starch_stage.dest = 3;
-        bed_sorted2stdout_stage.description = "Sorted BED to Starch";
-        bed_sorted2starch_stage.pid = 0;
-        bed_sorted2starch_stage.status = 0;
-
-        starch2stdout_stage.pipeset = p;
-        starch2stdout_stage.line_functor = NULL;
-        starch2stdout_stage.src = 3;
-        starch2stdout_stage.dest = -1;
-        starch2stdout_stage.description = "Starch to stdout";
-        starch2stdout_stage.pid = 0;
-        starch2stdout_stage.status = 0;
-    }
-    else {
-        fprintf(stderr, "Error: Unknown conversion parameter combination\n");
-        c2b_print_usage(stderr);
-        exit(ENOTSUP); /* Operation not supported (POSIX.1) */
-    }
+    c2b_stage_graph_t graph;
 
     /*
-       We open pid_t (process) instances to handle data in a specified order. 
+       XYZ -> BED (unsorted) [-> BED (sorted)] [-> Starch]
     */
 
-    c2b_cmd_cat_stdin(cat2generic_cmd);
+    c2b_init_graph(&graph);
+    c2b_graph_append_stage(&graph, SOURCE_STAGE, "Generic data from stdin", NULL, NULL);
+    c2b_graph_append_stage(&graph, CONVERT_STAGE, "Generic data to unsorted BED", to_bed_block_converter, NULL);
+    c2b_graph_append_output_stages(&graph);
+    c2b_run_graph(&graph);
+
 #ifdef DEBUG
-    fprintf(stderr, "Debug: c2b_cmd_cat_stdin: [%s]\n", cat2generic_cmd);
+    fprintf(stderr, "--- c2b_init_generic_conversion() - exit  ---\n");
 #endif
+}
 
-    generic2bed_unsorted_stage.pid = c2b_popen4(cat2generic_cmd,
-                                                p->in[0],
-                                                p->out[0],
-                                                p->err[0],
-                                                POPEN4_FLAG_NONE);
-
-    if (waitpid(generic2bed_unsorted_stage.pid, 
-                &generic2bed_unsorted_stage.status, 
-                WNOHANG | WUNTRACED) == -1) {
-        errsv = errno;
-        fprintf(stderr, "Error: Generic stdin stage waitpid() call failed (%s)\n", (errsv == ECHILD ? "ECHILD" : (errsv == EINTR ? "EINTR" : "EINVAL")));
-        exit(errsv);
-    }
-
-    if (c2b_globals.sort->is_enabled) {
-        c2b_cmd_sort_bed(bed_unsorted2bed_sorted_cmd);
+static void
+c2b_init_bam_conversion()
+{
 #ifdef DEBUG
-        fprintf(stderr, "Debug: c2b_cmd_sort_bed: [%s]\n", bed_unsorted2bed_sorted_cmd);
+    fprintf(stderr, "--- c2b_init_bam_conversion() - enter ---\n");
 #endif
 
-        bed_unsorted2bed_sorted_stage.pid = c2b_popen4(bed_unsorted2bed_sorted_cmd,
-                                                       p->in[2],
-                                                       p->out[2],
-                                                       p->err[2],
-                                                       POPEN4_FLAG_NONE);
+    c2b_stage_graph_t graph;
+    void (*sam2bed_unsorted_block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *) = NULL;
 
-        if (waitpid(bed_unsorted2bed_sorted_stage.pid, 
-                    &bed_unsorted2bed_sorted_stage.status, 
-                    WNOHANG | WUNTRACED) == -1) {
-            errsv = errno;
-            fprintf(stderr, "Error: Sort stage waitpid() call failed (%s)\n", (errsv == ECHILD ? "ECHILD" : (errsv == EINTR ? "EINTR" : "EINVAL")));
-            exit(errsv);
-        }
-    }
+    sam2bed_unsorted_block_converter = (!c2b_globals.split_flag ?
+                                        &c2b_block_convert_sam_to_bed_unsorted_without_split_operation :
+                                        &c2b_block_convert_sam_to_bed_unsorted_with_split_operation);
+
+    /*
+       BAM -> SAM -> BED (unsorted) [-> BED (sorted)] [-> Starch]
+    */
+
+    c2b_init_graph(&graph);
+    c2b_graph_append_stage(&graph, SOURCE_STAGE, "BAM data from stdin", NULL, NULL);
+    c2b_graph_append_stage(&graph, DECODE_STAGE, "BAM data from stdin to SAM", NULL, &c2b_cmd_bam_to_sam);
+    c2b_graph_append_stage(&graph, CONVERT_STAGE, "SAM to unsorted BED", sam2bed_unsorted_block_converter, NULL);
+    c2b_graph_append_output_stages(&graph);
+    c2b_run_graph(&graph);
 
-    if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        c2b_cmd_starch_bed(bed_sorted2starch_cmd);
 #ifdef DEBUG
-        fprintf(stderr, "Debug: c2b_cmd_starch_bed: [%s]\n", bed_sorted2starch_cmd);
+    fprintf(stderr, "--- c2b_init_bam_conversion() - exit  ---\n");
 #endif
+}
 
-        bed_sorted2starch_stage.pid = c2b_popen4(bed_sorted2starch_cmd,
-                                                 p->in[3],
-                                                 p->out[3],
-                                                 p->err[3],
-                                                 POPEN4_FLAG_NONE);
+static void
+c2b_init_graph(c2b_stage_graph_t *g)
+{
+    g->num_nodes = 0;
+}
 
-        if (waitpid(bed_sorted2starch_stage.pid, 
-                    &bed_sorted2starch_stage.status, 
-                    WNOHANG | WUNTRACED) == -1) {
-            errsv = errno;
-            fprintf(stderr, "Error: Compression stage waitpid() call failed (%s)\n", (errsv == ECHILD ? "ECHILD" : (errsv == EINTR ? "EINTR" : "EINVAL")));
-            exit(errsv);
-        }
+static void
+c2b_graph_append_stage(c2b_stage_graph_t *g, c2b_stage_kind_t kind, char *description, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), void (*cmd)(char **))
+{
+    c2b_stage_node_t *node = NULL;
+
+    if (g->num_nodes == C2B_MAX_STAGES_VALUE) {
+        fprintf(stderr, "Error: Too many stages in conversion pipeline (at most %d)\n", C2B_MAX_STAGES_VALUE);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
 
-#ifdef DEBUG
-    c2b_debug_pipeset(p, MAX_PIPES);
-#endif
+    node = &g->nodes[g->num_nodes++];
+    node->kind = kind;
+    node->description = description;
+    node->block_converter = block_converter;
+    node->cmd = cmd;
+}
 
-    /*
-       Once we have the desired process instances, we create and join
-       threads for their ordered execution.
-    */
+static void
+c2b_graph_append_output_stages(c2b_stage_graph_t *g)
+{
+    if ((c2b_globals.output_format_idx != BED_FORMAT) && (c2b_globals.output_format_idx != STARCH_FORMAT)) {
+        fprintf(stderr, "Error: Unknown conversion parameter combination\n");
+        c2b_print_usage(stderr);
+        exit(ENOTSUP); /* Operation not supported (POSIX.1) */
+    }
 
-    if ((!c2b_globals.sort->is_enabled) && (c2b_globals.output_format_idx == BED_FORMAT)) {
-        pthread_create(&cat2generic_thread,
-                       NULL,
-                       c2b_read_bytes_from_stdin,
-                       &cat2generic_stage);
-        pthread_create(&generic2bed_unsorted_thread,
-                       NULL,
-                       c2b_process_intermediate_bytes_by_lines,
-                       &generic2bed_unsorted_stage);
-        pthread_create(&bed_unsorted2stdout_thread,
-                       NULL,
-                       c2b_write_in_bytes_to_stdout,
-                       &bed_unsorted2stdout_stage);
-    }
-    else if (c2b_globals.output_format_idx == BED_FORMAT) {
-        pthread_create(&cat2generic_thread,
-                       NULL,
-                       c2b_read_bytes_from_stdin,
-                       &cat2generic_stage);
-        pthread_create(&generic2bed_unsorted_thread,
-                       NULL,
-                       c2b_process_intermediate_bytes_by_lines,
-                       &generic2bed_unsorted_stage);
-        pthread_create(&bed_unsorted2bed_sorted_thread,
-                       NULL,
-                       c2b_write_in_bytes_to_in_process,
-                       &bed_unsorted2bed_sorted_stage);
-        pthread_create(&bed_sorted2stdout_thread,
-                       NULL,
-                       c2b_write_out_bytes_to_stdout,
-                       &bed_sorted2stdout_stage);
-    }
-    else if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        pthread_create(&cat2generic_thread,
-                       NULL,
-                       c2b_read_bytes_from_stdin,
-                       &cat2generic_stage);
-        pthread_create(&generic2bed_unsorted_thread,
-                       NULL,
-                       c2b_process_intermediate_bytes_by_lines,
-                       &generic2bed_unsorted_stage);
-        pthread_create(&bed_unsorted2bed_sorted_thread,
-                       NULL,
-                       c2b_write_in_bytes_to_in_process,
-                       &bed_unsorted2bed_sorted_stage);
-        pthread_create(&bed_sorted2starch_thread,
-                       NULL,
-                       c2b_write_out_bytes_to_in_process,
-                       &bed_sorted2starch_stage);
-        pthread_create(&starch2stdout_thread,
-                       NULL,
-                       c2b_write_out_bytes_to_stdout,
-                       &starch2stdout_stage);
-    }
-
-    if ((!c2b_globals.sort->is_enabled) && (c2b_globals.output_format_idx == BED_FORMAT)) {
-        pthread_join(cat2generic_thread, (void **) NULL);
-        pthread_join(generic2bed_unsorted_thread, (void **) NULL);
-        pthread_join(bed_unsorted2stdout_thread, (void **) NULL);
-    }
-    else if (c2b_globals.output_format_idx == BED_FORMAT) {
-        pthread_join(cat2generic_thread, (void **) NULL);
-        pthread_join(generic2bed_unsorted_thread, (void **) NULL);
-        pthread_join(bed_unsorted2bed_sorted_thread, (void **) NULL);
-        pthread_join(bed_sorted2stdout_thread, (void **) NULL);
-    }
-    else if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        pthread_join(cat2generic_thread, (void **) NULL);
-        pthread_join(generic2bed_unsorted_thread, (void **) NULL);
-        pthread_join(bed_unsorted2bed_sorted_thread, (void **) NULL);
-        pthread_join(bed_sorted2starch_thread, (void **) NULL);
-        pthread_join(starch2stdout_thread, (void **) NULL);
+    /* Starch output is always sorted, and the sorter compresses it in process */
+    if (c2b_globals.output_format_idx == STARCH_FORMAT) {
+        c2b_graph_append_stage(g, SORT_STAGE, "Unsorted BED to Starch", NULL, NULL);
+        c2b_graph_append_stage(g, SINK_STAGE, "Starch to stdout", NULL, NULL);
+        return;
     }
 
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_generic_conversion() - exit  ---\n");
-#endif
+    if (c2b_globals.sort->is_enabled) {
+        c2b_graph_append_stage(g, SORT_STAGE, "Unsorted BED to sorted BED", NULL, NULL);
+    }
+
+    c2b_graph_append_stage(g, 
+                           SINK_STAGE, 
+                           (c2b_globals.sort->is_enabled ? "Sorted BED to stdout" : "Unsorted BED to stdout"), 
+                           NULL, 
+                           NULL);
+}
+
+static inline boolean
+c2b_stage_is_in_process(c2b_stage_kind_t kind)
+{
+    return ((kind == CONVERT_STAGE) || (kind == FILTER_STAGE) || (kind == SORT_STAGE)) ? kTrue : kFalse;
 }
 
 static void
-c2b_init_bam_conversion(c2b_pipeset_t *p)
+c2b_run_graph(c2b_stage_graph_t *g)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_bam_conversion() - enter ---\n");
-#endif
+    c2b_pipeset_t pipes;
+    c2b_pipeline_stage_t stages[C2B_MAX_STAGE_THREADS_VALUE];
+    void * (*stage_runners[C2B_MAX_STAGE_THREADS_VALUE])(void *);
+    pthread_t stage_threads[C2B_MAX_STAGE_THREADS_VALUE];
+    unsigned int pipe_idxs[C2B_MAX_STAGES_VALUE];
+    pid_t pids[C2B_MAX_STAGES_VALUE];
+    int statuses[C2B_MAX_STAGES_VALUE];
+    char *args[C2B_MAX_ARGUMENTS_VALUE];
+    c2b_stage_node_t *node = NULL;
+    c2b_stage_node_t *converter_node = NULL;
+    c2b_stage_node_t *sort_node = NULL;
+    c2b_sorter_t sorter;
+    size_t num_pipes = 0;
+    size_t num_stages = 0;
+    size_t node_idx = 0;
+    size_t segment_start = 0;
+    size_t segment_end = 0;
+    size_t stage_idx = 0;
+    unsigned int src = 0;
+    unsigned int dest = 0;
+    int errsv = 0;
 
-    pthread_t bam2sam_thread; 
-    pthread_t sam2bed_unsorted_thread; 
-    pthread_t bed_unsorted2stdout_thread;
-    pthread_t bed_unsorted2bed_sorted_thread;
-    pthread_t bed_sorted2stdout_thread;
-    pthread_t bed_sorted2starch_thread;
-    pthread_t starch2stdout_thread;
-    c2b_pipeline_stage_t bam2sam_stage;
-    c2b_pipeline_stage_t sam2bed_unsorted_stage;
-    c2b_pipeline_stage_t bed_unsorted2stdout_stage;
-    c2b_pipeline_stage_t bed_unsorted2bed_sorted_stage;
-    c2b_pipeline_stage_t bed_sorted2stdout_stage;
-    c2b_pipeline_stage_t bed_sorted2starch_stage;
-    c2b_pipeline_stage_t starch2stdout_stage;
-    char bam2sam_cmd[C2B_MAX_LINE_LENGTH_VALUE];
-    char bed_unsorted2bed_sorted_cmd[C2B_MAX_LINE_LENGTH_VALUE];
-    char bed_sorted2starch_cmd[C2B_MAX_LINE_LENGTH_VALUE];
-    void (*sam2bed_unsorted_line_functor)(char *, ssize_t *, char *, ssize_t) = NULL;
-    int errsv = errno;
-
-    sam2bed_unsorted_line_functor = (!c2b_globals.split_flag ?
-                                     &c2b_line_convert_sam_to_bed_unsorted_without_split_operation :
-                                     &c2b_line_convert_sam_to_bed_unsorted_with_split_operation);
-
-    if ((!c2b_globals.sort->is_enabled) && (c2b_globals.output_format_idx == BED_FORMAT)) {
-        bam2sam_stage.pipeset = p;
-        bam2sam_stage.line_functor = NULL;
-        bam2sam_stage.src = -1;
-        bam2sam_stage.dest = 0;
-        bam2sam_stage.description = "BAM data from stdin to SAM";
-        bam2sam_stage.pid = 0;
-        bam2sam_stage.status = 0;
-        
-        sam2bed_unsorted_stage.pipeset = p;
-        sam2bed_unsorted_stage.line_functor = sam2bed_unsorted_line_functor;
-        sam2bed_unsorted_stage.src = 0;
-        sam2bed_unsorted_stage.dest = 1;
-        sam2bed_unsorted_stage.description = "SAM to unsorted BED";
-        sam2bed_unsorted_stage.pid = 0;
-        sam2bed_unsorted_stage.status = 0;
-
-        bed_unsorted2stdout_stage.pipeset = p;
-        bed_unsorted2stdout_stage.line_functor = NULL;
-        bed_unsorted2stdout_stage.src = 1;
-        bed_unsorted2stdout_stage.dest = -1;
-        bed_unsorted2stdout_stage.description = "Unsorted BED to stdout";
-        bed_unsorted2stdout_stage.pid = 0;
-        bed_unsorted2stdout_stage.status = 0;
-    }
-    else if (c2b_globals.output_format_idx == BED_FORMAT) {
-        bam2sam_stage.pipeset = p;
-        bam2sam_stage.line_functor = NULL;
-        bam2sam_stage.src = -1;
-        bam2sam_stage.dest = 0;
-        bam2sam_stage.description = "BAM data from stdin to SAM";
-        bam2sam_stage.pid = 0;
-        bam2sam_stage.status = 0;
-        
-        sam2bed_unsorted_stage.pipeset = p;
-        sam2bed_unsorted_stage.line_functor = sam2bed_unsorted_line_functor;
-        sam2bed_unsorted_stage.src = 0;
-        sam2bed_unsorted_stage.dest = 1;
-        sam2bed_unsorted_stage.description = "SAM to unsorted BED";
-        sam2bed_unsorted_stage.pid = 0;
-        sam2bed_unsorted_stage.status = 0;
-        
-        bed_unsorted2bed_sorted_stage.pipeset = p;
-        bed_unsorted2bed_sorted_stage.line_functor = NULL;
-        bed_unsorted2bed_sorted_stage.src = 1;
-        bed_unsorted2bed_sorted_stage.dest = 2;
-        bed_unsorted2bed_sorted_stage.description = "Unsorted BED to sorted BED";
-        bed_unsorted2bed_sorted_stage.pid = 0;
-        bed_unsorted2bed_sorted_stage.status = 0;
-
-        bed_sorted2stdout_stage.pipeset = p;
-        bed_sorted2stdout_stage.line_functor = NULL;
-        bed_sorted2stdout_stage.src = 2;
-        bed_sorted2stdout_stage.dest = -1;
-        bed_sorted2stdout_stage.description = "Sorted BED to stdout";
-        bed_sorted2stdout_stage.pid = 0;
-        bed_sorted2stdout_stage.status = 0;
-    }
-    else if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        bam2sam_stage.pipeset = p;
-        bam2sam_stage.line_functor = NULL;
-        bam2sam_stage.src = -1;
-        bam2sam_stage.dest = 0;
-        bam2sam_stage.description = "BAM data from stdin to SAM";
-        bam2sam_stage.pid = 0;
-        bam2sam_stage.status = 0;
-        
-        sam2bed_unsorted_stage.pipeset = p;
-        sam2bed_unsorted_stage.line_functor = sam2bed_unsorted_line_functor;
-        sam2bed_unsorted_stage.src = 0;
-        sam2bed_unsorted_stage.dest = 1;
-        sam2bed_unsorted_stage.description = "SAM to unsorted BED";
-        sam2bed_unsorted_stage.pid = 0;
-        sam2bed_unsorted_stage.status = 0;
-
-        bed_unsorted2bed_sorted_stage.pipeset = p;
-        bed_unsorted2bed_sorted_stage.line_functor = NULL;
-        bed_unsorted2bed_sorted_stage.src = 1;
-        bed_unsorted2bed_sorted_stage.dest = 2;
-        bed_unsorted2bed_sorted_stage.description = "Unsorted BED to sorted BED";
-        bed_unsorted2bed_sorted_stage.pid = 0;
-        bed_unsorted2bed_sorted_stage.status = 0;
-
-        bed_sorted2starch_stage.pipeset = p;
-        bed_sorted2starch_stage.line_functor = NULL;
-        bed_sorted2starch_stage.src = 2;
-        bed_sorted2starch_stage.dest = 3;
-        bed_sorted2starch_stage.description = "Sorted BED to Starch";
-        bed_sorted2starch_stage.pid = 0;
-        bed_sorted2starch_stage.status = 0;
-
-        starch2stdout_stage.pipeset = p;
-        starch2stdout_stage.line_functor = NULL;
-        starch2stdout_stage.src = 3;
-        starch2stdout_stage.dest = -1;
-        starch2stdout_stage.description = "Starch to stdout";
-        starch2stdout_stage.pid = 0;
-        starch2stdout_stage.status = 0;
-    }
-    else {
-        fprintf(stderr, "Error: Unknown BAM conversion parameter combination\n");
+    if ((g->num_nodes < 2) || (g->nodes[0].kind != SOURCE_STAGE) || (g->nodes[g->num_nodes - 1].kind != SINK_STAGE)) {
+        fprintf(stderr, "Error: Conversion pipeline must run from a source stage to a sink stage\n");
         c2b_print_usage(stderr);
-        exit(ENOTSUP); /* Operation not supported (POSIX.1) */
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
 
     /*
-       We open pid_t (process) instances to handle data in a specified order. 
+       Each child process stage gets a pipe of its own. A sort stage runs in
+       this process, through a sorter fed by the converter before it.
     */
 
-    c2b_cmd_bam_to_sam(bam2sam_cmd);
-#ifdef DEBUG
-    fprintf(stderr, "Debug: c2b_cmd_bam_to_sam: [%s]\n", bam2sam_cmd);
-#endif
-
-    bam2sam_stage.pid = c2b_popen4(bam2sam_cmd,
-                                   p->in[0],
-                                   p->out[0],
-                                   p->err[0],
-                                   POPEN4_FLAG_NONE);
+    c2b_init_sorter(&sorter);
 
-    if (waitpid(bam2sam_stage.pid, 
-                &bam2sam_stage.status, 
-                WNOHANG | WUNTRACED) == -1) {
-        errsv = errno;
-        fprintf(stderr, "Error: BAM-to-SAM stage waitpid() call failed (%s)\n", (errsv == ECHILD ? "ECHILD" : (errsv == EINTR ? "EINTR" : "EINVAL")));
-        exit(errsv);
+    for (node_idx = 1; node_idx < g->num_nodes - 1; node_idx++) {
+        pipe_idxs[node_idx] = (unsigned int) -1;
+        pids[node_idx] = 0;
+        statuses[node_idx] = 0;
+        if (!c2b_stage_is_in_process(g->nodes[node_idx].kind)) {
+            pipe_idxs[node_idx] = num_pipes++;
+        }
+    }
+    pipes.num = 0;
+    if (num_pipes > 0) {
+        c2b_init_pipeset(&pipes, num_pipes);
     }
 
-    if (c2b_globals.sort->is_enabled) {
-        c2b_cmd_sort_bed(bed_unsorted2bed_sorted_cmd);
+    /*
+       We open pid_t (process) instances to handle data in a specified order. 
+    */
+
+    for (node_idx = 1; node_idx < g->num_nodes - 1; node_idx++) {
+        node = &g->nodes[node_idx];
+        if (c2b_stage_is_in_process(node->kind))
+            continue;
+        (*node->cmd)(args);
 #ifdef DEBUG
-        fprintf(stderr, "Debug: c2b_cmd_sort_bed: [%s]\n", bed_unsorted2bed_sorted_cmd);
-#endif
-
-        bed_unsorted2bed_sorted_stage.pid = c2b_popen4(bed_unsorted2bed_sorted_cmd,
-                                                       p->in[2],
-                                                       p->out[2],
-                                                       p->err[2],
-                                                       POPEN4_FLAG_NONE);
-        
-        if (waitpid(bed_unsorted2bed_sorted_stage.pid, 
-                    &bed_unsorted2bed_sorted_stage.status, 
-                    WNOHANG | WUNTRACED) == -1) {
+        c2b_debug_args(node->description, args);
+#endif
+        pids[node_idx] = c2b_popen4(args,
+                                    pipes.in[pipe_idxs[node_idx]],
+                                    pipes.out[pipe_idxs[node_idx]],
+                                    pipes.err[pipe_idxs[node_idx]],
+                                    POPEN4_FLAG_NONE);
+        if (waitpid(pids[node_idx], &statuses[node_idx], WNOHANG | WUNTRACED) == -1) {
             errsv = errno;
-            fprintf(stderr, "Error: Sort stage waitpid() call failed (%s)\n", (errsv == ECHILD ? "ECHILD" : (errsv == EINTR ? "EINTR" : "EINVAL")));
+            fprintf(stderr, "Error: %s stage waitpid() call failed (%s)\n", 
+                    node->description,
+                    (errsv == ECHILD ? "ECHILD" : (errsv == EINTR ? "EINTR" : "EINVAL")));
             exit(errsv);
         }
     }
 
-    if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        c2b_cmd_starch_bed(bed_sorted2starch_cmd);
 #ifdef DEBUG
-        fprintf(stderr, "Debug: c2b_cmd_starch_bed: [%s]\n", bed_sorted2starch_cmd);
+    c2b_debug_pipeset(&pipes, pipes.num);
 #endif
 
-        bed_sorted2starch_stage.pid = c2b_popen4(bed_sorted2starch_cmd,
-                                                 p->in[3],
-                                                 p->out[3],
-                                                 p->err[3],
-                                                 POPEN4_FLAG_NONE);
+    /*
+       Each segment runs from the source or a child process, through any 
+       in-process stages, to the next child process or the sink. The only 
+       child is samtools, upstream of conversion, so a segment either relays
+       stdin into it, or converts (and maybe sorts) on its way to stdout.
+    */
+
+    for (segment_start = 0; segment_start < g->num_nodes - 1; segment_start = segment_end) {
+        converter_node = NULL;
+        sort_node = NULL;
+        for (segment_end = segment_start + 1; c2b_stage_is_in_process(g->nodes[segment_end].kind); segment_end++) {
+            if (g->nodes[segment_end].kind == SORT_STAGE) {
+                if ((!converter_node) || (sort_node)) {
+                    fprintf(stderr, "Error: Conversion pipeline stage [%s] must follow a converter or filter\n", g->nodes[segment_end].description);
+                    c2b_print_usage(stderr);
+                    exit(ENOTSUP); /* Operation not supported (POSIX.1) */
+                }
+                sort_node = &g->nodes[segment_end];
+                continue;
+            }
+            if (converter_node) {
+                fprintf(stderr, "Error: Conversion pipeline stages [%s] and [%s] cannot share a segment\n", converter_node->description, g->nodes[segment_end].description);
+                c2b_print_usage(stderr);
+                exit(ENOTSUP); /* Operation not supported (POSIX.1) */
+            }
+            converter_node = &g->nodes[segment_end];
+        }
+        node = &g->nodes[segment_end];
+        src = (segment_start == 0) ? (unsigned int) -1 : pipe_idxs[segment_start];
+        dest = (node->kind == SINK_STAGE) ? (unsigned int) -1 : pipe_idxs[segment_end];
 
-        if (waitpid(bed_sorted2starch_stage.pid, 
-                    &bed_sorted2starch_stage.status, 
-                    WNOHANG | WUNTRACED) == -1) {
-            errsv = errno;
-            fprintf(stderr, "Error: Compression stage waitpid() call failed (%s)\n", (errsv == ECHILD ? "ECHILD" : (errsv == EINTR ? "EINTR" : "EINVAL")));
-            exit(errsv);
+        if ((converter_node) ? (node->kind != SINK_STAGE) : ((segment_start != 0) || (node->kind == SINK_STAGE))) {
+            fprintf(stderr, "Error: Conversion pipeline stage [%s] must convert to stdout or relay stdin to a child process\n", node->description);
+            c2b_print_usage(stderr);
+            exit(ENOTSUP); /* Operation not supported (POSIX.1) */
         }
-    }
 
-#ifdef DEBUG
-    c2b_debug_pipeset(p, MAX_PIPES);
-#endif
+        c2b_init_stage(&stages[num_stages], 
+                       &pipes, 
+                       (converter_node ? converter_node->description : node->description), 
+                       src, 
+                       dest, 
+                       (converter_node ? converter_node->block_converter : NULL), 
+                       (sort_node ? &sorter : NULL), 
+                       ((node->kind == SINK_STAGE) ? 0 : pids[segment_end]), 
+                       ((node->kind == SINK_STAGE) ? 0 : statuses[segment_end]));
+        if (converter_node)
+            stage_runners[num_stages++] = c2b_process_intermediate_bytes_by_lines_to_stdout;
+        else
+            stage_runners[num_stages++] = c2b_read_bytes_from_stdin;
+    }
 
     /*
        Once we have the desired process instances, we create and join
        threads for their ordered execution.
     */
 
-    if ((!c2b_globals.sort->is_enabled) && (c2b_globals.output_format_idx == BED_FORMAT)) {
-        pthread_create(&bam2sam_thread,
-                       NULL,
-                       c2b_read_bytes_from_stdin,
-                       &bam2sam_stage);
-        pthread_create(&sam2bed_unsorted_thread,
-                       NULL,
-                       c2b_process_intermediate_bytes_by_lines,
-                       &sam2bed_unsorted_stage);
-        pthread_create(&bed_unsorted2stdout_thread,
-                       NULL,
-                       c2b_write_in_bytes_to_stdout,
-                       &bed_unsorted2stdout_stage);
-    }
-    else if (c2b_globals.output_format_idx == BED_FORMAT) {
-        pthread_create(&bam2sam_thread,
-                       NULL,
-                       c2b_read_bytes_from_stdin,
-                       &bam2sam_stage);
-        pthread_create(&sam2bed_unsorted_thread,
-                       NULL,
-                       c2b_process_intermediate_bytes_by_lines,
-                       &sam2bed_unsorted_stage);
-        pthread_create(&bed_unsorted2bed_sorted_thread,
-                       NULL,
-                       c2b_write_in_bytes_to_in_process,
-                       &bed_unsorted2bed_sorted_stage);
-        pthread_create(&bed_sorted2stdout_thread,
-                       NULL,
-                       c2b_write_out_bytes_to_stdout,
-                       &bed_sorted2stdout_stage);
-    }
-    else if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        pthread_create(&bam2sam_thread,
-                       NULL,
-                       c2b_read_bytes_from_stdin,
-                       &bam2sam_stage);
-        pthread_create(&sam2bed_unsorted_thread,
-                       NULL,
-                       c2b_process_intermediate_bytes_by_lines,
-                       &sam2bed_unsorted_stage);
-        pthread_create(&bed_unsorted2bed_sorted_thread,
-                       NULL,
-                       c2b_write_in_bytes_to_in_process,
-                       &bed_unsorted2bed_sorted_stage);
-        pthread_create(&bed_sorted2starch_thread,
-                       NULL,
-                       c2b_write_out_bytes_to_in_process,
-                       &bed_sorted2starch_stage);
-        pthread_create(&starch2stdout_thread,
-                       NULL,
-                       c2b_write_out_bytes_to_stdout,
-                       &starch2stdout_stage);
-    }
-
-    if ((!c2b_globals.sort->is_enabled) && (c2b_globals.output_format_idx == BED_FORMAT)) {
-        pthread_join(bam2sam_thread, (void **) NULL);
-        pthread_join(sam2bed_unsorted_thread, (void **) NULL);
-        pthread_join(bed_unsorted2stdout_thread, (void **) NULL);
-    }
-    else if (c2b_globals.output_format_idx == BED_FORMAT) {
-        pthread_join(bam2sam_thread, (void **) NULL);
-        pthread_join(sam2bed_unsorted_thread, (void **) NULL);
-        pthread_join(bed_unsorted2bed_sorted_thread, (void **) NULL);
-        pthread_join(bed_sorted2stdout_thread, (void **) NULL);
-    }
-    else if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        pthread_join(bam2sam_thread, (void **) NULL);
-        pthread_join(sam2bed_unsorted_thread, (void **) NULL);
-        pthread_join(bed_unsorted2bed_sorted_thread, (void **) NULL);
-        pthread_join(bed_sorted2starch_thread, (void **) NULL);
-        pthread_join(starch2stdout_thread, (void **) NULL);
+    for (stage_idx = 0; stage_idx < num_stages; stage_idx++) {
+        pthread_create(&stage_threads[stage_idx], NULL, stage_runners[stage_idx], &stages[stage_idx]);
+    }
+    for (stage_idx = 0; stage_idx < num_stages; stage_idx++) {
+        pthread_join(stage_threads[stage_idx], (void **) NULL);
     }
 
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_bam_conversion() - exit  ---\n");
-#endif
-}
+    c2b_delete_sorter(&sorter);
 
-static inline void
-c2b_cmd_cat_stdin(char *cmd)
-{
-    const char *cat_args = " - ";
-    
-    /* /path/to/cat - */
-    memcpy(cmd,
-           c2b_globals.cat->path,
-           strlen(c2b_globals.cat->path) + 1);
-    memcpy(cmd + strlen(c2b_globals.cat->path),
-           cat_args,
-           strlen(cat_args) + 1);
-    cmd[strlen(c2b_globals.cat->path) + strlen(cat_args)] = '\0';
+    if (num_pipes > 0) {
+        c2b_delete_pipeset(&pipes);
+    }
 }
 
-static inline void
-c2b_cmd_bam_to_sam(char *cmd)
+static void
+c2b_init_stage(c2b_pipeline_stage_t *stage, c2b_pipeset_t *pipes, char *description, unsigned int src, unsigned int dest, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), c2b_sorter_t *sorter, pid_t pid, int status)
 {
-    const char *bam2sam_args = " view -h -";
-
-    /* /path/to/samtools view -h - */
-    memcpy(cmd, 
-           c2b_globals.sam->samtools_path, 
-           strlen(c2b_globals.sam->samtools_path) + 1);
-    memcpy(cmd + strlen(c2b_globals.sam->samtools_path), 
-           bam2sam_args, 
-           strlen(bam2sam_args) + 1);
-    cmd[strlen(c2b_globals.sam->samtools_path) + strlen(bam2sam_args)] = '\0';
+    stage->pipeset = pipes;
+    stage->block_converter = block_converter;
+    stage->sorter = sorter;
+    stage->src = src;
+    stage->dest = dest;
+    stage->description = description;
+    stage->pid = pid;
+    stage->status = status;
 }
 
 static inline void
-c2b_cmd_sort_bed(char *cmd)
+c2b_cmd_bam_to_sam(char **args)
 {
-    char sort_bed_args[C2B_MAX_LINE_LENGTH_VALUE];
-    memset(sort_bed_args, 0, C2B_MAX_LINE_LENGTH_VALUE);
+    size_t n = 0;
 
-    /* /path/to/sort-bed [--max-mem <val>] [--tmpdir <path>] - */
-    if (c2b_globals.sort->max_mem_value) {
-        memcpy(sort_bed_args,
-               sort_bed_max_mem_arg, 
-               strlen(sort_bed_max_mem_arg) + 1);
-        memcpy(sort_bed_args + strlen(sort_bed_args), 
-               c2b_globals.sort->max_mem_value, 
-               strlen(c2b_globals.sort->max_mem_value) + 1);
-        sort_bed_args[strlen(sort_bed_max_mem_arg) + strlen(sort_bed_args)] = '\0';
-    }
-    else {
-        memcpy(sort_bed_args, 
-               sort_bed_max_mem_default_arg, 
-               strlen(sort_bed_max_mem_default_arg) + 1);
-        sort_bed_args[strlen(sort_bed_max_mem_default_arg)] = '\0';
-    }
-    if (c2b_globals.sort->sort_tmpdir_path) {
-        memcpy(sort_bed_args + strlen(sort_bed_args),
-               sort_bed_tmpdir_arg,
-               strlen(sort_bed_tmpdir_arg) + 1);
-        memcpy(sort_bed_args + strlen(sort_bed_args),
-               c2b_globals.sort->sort_tmpdir_path,
-               strlen(c2b_globals.sort->sort_tmpdir_path) + 1);
-        sort_bed_args[strlen(sort_bed_args) + strlen(c2b_globals.sort->sort_tmpdir_path)] = '\0';
-    }
-    memcpy(sort_bed_args + strlen(sort_bed_args),
-           sort_bed_stdin,
-           strlen(sort_bed_stdin) + 1);
-    sort_bed_args[strlen(sort_bed_args) + strlen(sort_bed_stdin)] = '\0';
-
-    /* cmd */
-    memcpy(cmd, 
-           c2b_globals.sort->sort_bed_path, 
-           strlen(c2b_globals.sort->sort_bed_path) + 1);
-    memcpy(cmd + strlen(c2b_globals.sort->sort_bed_path), 
-           sort_bed_args, 
-           strlen(sort_bed_args) + 1);
-    cmd[strlen(c2b_globals.sort->sort_bed_path) + strlen(sort_bed_args)] = '\0';
+    /* /path/to/samtools view -h - */
+    args[n++] = c2b_globals.sam->samtools_path;
+    args[n++] = (char *) samtools_view_arg;
+    args[n++] = (char *) samtools_header_arg;
+    args[n++] = (char *) samtools_stdin_arg;
+    args[n] = NULL;
 }
 
-static inline void
-c2b_cmd_starch_bed(char *cmd) 
+static void
+c2b_block_convert_gtf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
 {
-    char starch_args[C2B_MAX_LINE_LENGTH_VALUE];
-    memset(starch_args, 0, C2B_MAX_LINE_LENGTH_VALUE);
-
-    /* /path/to/starch [--bzip2 | --gzip] [--note="xyz..."] - */
-    if (c2b_globals.starch->bzip2) {
-        memcpy(starch_args,
-               starch_bzip2_arg,
-               strlen(starch_bzip2_arg) + 1);
-        starch_args[strlen(starch_bzip2_arg)] = '\0';
-    }
-    else if (c2b_globals.starch->gzip) {
-        memcpy(starch_args,
-               starch_gzip_arg,
-               strlen(starch_gzip_arg) + 1);
-        starch_args[strlen(starch_gzip_arg)] = '\0';
-    }
-
-#ifdef DEBUG
-    fprintf(stderr, "Debug: c2b_globals.starch->bzip2: [%d]\n", c2b_globals.starch->bzip2);
-    fprintf(stderr, "Debug: c2b_globals.starch->gzip: [%d]\n", c2b_globals.starch->gzip);
-    fprintf(stderr, "Debug: c2b_globals.starch->note: [%s]\n", c2b_globals.starch->note);
-    fprintf(stderr, "Debug: starch_args: [%s]\n", starch_args);
-#endif
-
-    if (c2b_globals.starch->note) {
-        memcpy(starch_args + strlen(starch_args),
-               starch_note_prefix_arg,
-               strlen(starch_note_prefix_arg) + 1);
-        memcpy(starch_args + strlen(starch_args),
-               c2b_globals.starch->note,
-               strlen(c2b_globals.starch->note) + 1);
-        memcpy(starch_args + strlen(starch_args),
-               starch_note_suffix_arg,
-               strlen(starch_note_suffix_arg) + 1);
-        starch_args[strlen(starch_args) + strlen(starch_note_prefix_arg) + strlen(c2b_globals.starch->note) + strlen(starch_note_suffix_arg)] = '\0';
-    }
-    memcpy(starch_args + strlen(starch_args),
-           starch_stdin_arg,
-           strlen(starch_stdin_arg) + 1);
-
-#ifdef DEBUG
-    fprintf(stderr, "Debug: starch_args: [%s]\n", starch_args);
-#endif
-
-    /* cmd */
-    memcpy(cmd, 
-           c2b_globals.starch->path, 
-           strlen(c2b_globals.starch->path) + 1);
-    memcpy(cmd + strlen(c2b_globals.starch->path), 
-           starch_args, 
-           strlen(starch_args) + 1);
-    cmd[strlen(c2b_globals.starch->path) + strlen(starch_args)] = '\0';
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_gtf_to_bed_unsorted);
 }
 
 static void
-c2b_line_convert_gtf_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
+c2b_line_convert_gtf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
 {
-    ssize_t gtf_field_offsets[C2B_MAX_FIELD_COUNT_VALUE];
-    int gtf_field_idx = 0;
-    ssize_t current_src_posn = -1;
+    char *src = line->src;
+    ssize_t src_size = line->size;
+    int gtf_field_idx = line->field_idx;
 
-    while (++current_src_posn < src_size) {
-        if ((src[current_src_posn] == c2b_tab_delim) || (src[current_src_posn] == c2b_line_delim)) {
-            gtf_field_offsets[gtf_field_idx++] = current_src_posn;
-        }
-        if (gtf_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
-            fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", gtf_field_idx);
-            c2b_print_usage(stderr);
-            exit(EINVAL); /* Invalid argument (POSIX.1) */
-        }
+    if (gtf_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
+        fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", gtf_field_idx);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
-    gtf_field_offsets[gtf_field_idx] = src_size;
-    gtf_field_offsets[gtf_field_idx + 1] = -1;
 
     /* 
        If number of fields is not in bounds, we may need to exit early
@@ -896,19 +477,13 @@ c2b_line_convert_gtf_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
     if (((gtf_field_idx + 1) < c2b_gtf_field_min) || ((gtf_field_idx + 1) > c2b_gtf_field_max)) {
         if (gtf_field_idx == 0) {
             if (src[0] == c2b_gtf_comment) {
-                if (!c2b_globals.keep_header_flag) {
+                if (!ctx->options->keep_header_flag) {
                     return;
                 }
                 else {
                     /* copy header line to destination stream buffer */
-                    char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                    char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                    memcpy(src_header_line_str, src, src_size);
-                    src_header_line_str[src_size] = '\0';
-                    sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-                    memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-                    *dest_size += strlen(dest_header_line_str);
-                    c2b_globals.header_line_idx++;
+                    c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+                    ctx->header_line_idx++;
                     return;
                 }
             }
@@ -923,132 +498,98 @@ c2b_line_convert_gtf_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         }
     }
 
+    c2b_gtf_t gtf;
+
     /* 0 - seqname */
-    char seqname_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t seqname_size = gtf_field_offsets[0];
-    memcpy(seqname_str, src, seqname_size);
-    seqname_str[seqname_size] = '\0';
+    gtf.seqname = c2b_line_field(line, 0);
 
     /* 1 - source */
-    char source_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t source_size = gtf_field_offsets[1] - gtf_field_offsets[0] - 1;
-    memcpy(source_str, src + gtf_field_offsets[0] + 1, source_size);
-    source_str[source_size] = '\0';
+    gtf.source = c2b_line_field(line, 1);
 
     /* 2 - feature */
-    char feature_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t feature_size = gtf_field_offsets[2] - gtf_field_offsets[1] - 1;
-    memcpy(feature_str, src + gtf_field_offsets[1] + 1, feature_size);
-    feature_str[feature_size] = '\0';
+    gtf.feature = c2b_line_field(line, 2);
 
     /* 3 - start */
-    char start_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t start_size = gtf_field_offsets[3] - gtf_field_offsets[2] - 1;
-    memcpy(start_str, src + gtf_field_offsets[2] + 1, start_size);
-    start_str[start_size] = '\0';
-    uint64_t start_val = strtoull(start_str, NULL, 10);
+    gtf.start = c2b_field_to_uint64(c2b_line_field(line, 3), "GTF start");
 
     /* 4 - end */
-    char end_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t end_size = gtf_field_offsets[4] - gtf_field_offsets[3] - 1;
-    memcpy(end_str, src + gtf_field_offsets[3] + 1, end_size);
-    end_str[end_size] = '\0';
-    uint64_t end_val = strtoull(end_str, NULL, 10);
+    gtf.end = c2b_field_to_uint64(c2b_line_field(line, 4), "GTF end");
 
     /* 5 - score */
-    char score_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t score_size = gtf_field_offsets[5] - gtf_field_offsets[4] - 1;
-    memcpy(score_str, src + gtf_field_offsets[4] + 1, score_size);
-    score_str[score_size] = '\0';
+    gtf.score = c2b_line_field(line, 5);
 
     /* 6 - strand */
-    char strand_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t strand_size = gtf_field_offsets[6] - gtf_field_offsets[5] - 1;
-    memcpy(strand_str, src + gtf_field_offsets[5] + 1, strand_size);
-    strand_str[strand_size] = '\0';
+    gtf.strand = c2b_line_field(line, 6);
 
     /* 7 - frame */
-    char frame_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t frame_size = gtf_field_offsets[7] - gtf_field_offsets[6] - 1;
-    memcpy(frame_str, src + gtf_field_offsets[6] + 1, frame_size);
-    frame_str[frame_size] = '\0';
+    gtf.frame = c2b_line_field(line, 7);
 
     /* 8 - attributes */
-    char attributes_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t attributes_size = gtf_field_offsets[8] - gtf_field_offsets[7] - 1;
-    memcpy(attributes_str, src + gtf_field_offsets[7] + 1, attributes_size);
-    attributes_str[attributes_size] = '\0';
+    gtf.attributes = c2b_line_field(line, 8);
 
     /* 9 - comments */
-    char comments_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t comments_size = 0;
     if (gtf_field_idx == 9) {
-        comments_size = gtf_field_offsets[9] - gtf_field_offsets[8] - 1;
-        memcpy(comments_str, src + gtf_field_offsets[8] + 1, comments_size);
-        comments_str[comments_size] = '\0';
+        gtf.comments = c2b_line_field(line, 9);
+    }
+    else {
+        gtf.comments.str = src + src_size;
+        gtf.comments.size = 0;
     }
-
-    c2b_gtf_t gtf;
-    gtf.seqname = seqname_str;
-    gtf.source = source_str;
-    gtf.feature = feature_str;
-    gtf.start = start_val;
-    gtf.end = end_val;
-    gtf.score = score_str;
-    gtf.strand = strand_str;
-    gtf.frame = frame_str;
-    gtf.attributes = attributes_str;
-    gtf.comments = comments_str;
 
     /* 
-       Fix coordinate indexing, and (if needed) add attribute for zero-length record
+       Fix coordinate indexing, and (if needed) add attribute for zero-length record; 
+       this is the one case where the attributes are copied
     */
 
     if (gtf.start == gtf.end) {
-        gtf.start -= 1;
-        ssize_t trailing_semicolon_fudge = (attributes_str[strlen(attributes_str) - 1] == ';') ? 1 : 0;
-        memcpy(attributes_str + strlen(attributes_str) - trailing_semicolon_fudge, 
+        ssize_t trailing_semicolon_fudge = ((gtf.attributes.size > 0) && (gtf.attributes.str[gtf.attributes.size - 1] == ';')) ? 1 : 0;
+        ssize_t attributes_size = gtf.attributes.size - trailing_semicolon_fudge;
+        char *attributes_str = c2b_alloc_field(ctx, attributes_size + strlen(c2b_gtf_zero_length_insertion_attribute));
+        memcpy(attributes_str, gtf.attributes.str, attributes_size);
+        memcpy(attributes_str + attributes_size, 
                c2b_gtf_zero_length_insertion_attribute, 
                strlen(c2b_gtf_zero_length_insertion_attribute) + 1);
+        gtf.attributes.str = attributes_str;
+        gtf.attributes.size = attributes_size + strlen(c2b_gtf_zero_length_insertion_attribute);
     }
-    else {
-        gtf.start -= 1;
-    }
+    gtf.start -= 1;
 
     /* 
-       Parse ID value out from attributes string
+       Parse ID value out from attributes string; the ID carries over to 
+       later records without one, so it is kept as a copy
     */
 
-    char *attributes_copy = NULL;
-    attributes_copy = malloc(strlen(attributes_str) + 1);
-    if (!attributes_copy) {
-        fprintf(stderr, "Error: Could not allocate space for GFF attributes copy\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
-    memcpy(attributes_copy, attributes_str, strlen(attributes_str) + 1);
-    const char *kv_tok;
     const char *gtf_id_prefix = "gene_id ";
-    char *id_str;
-    while((kv_tok = c2b_strsep(&attributes_copy, ";")) != NULL) {
-        id_str = strstr(kv_tok, gtf_id_prefix);
-        if (id_str) {
+    ssize_t gtf_id_prefix_size = strlen(gtf_id_prefix);
+    const char *attributes_end = gtf.attributes.str + gtf.attributes.size;
+    const char *kv_str = gtf.attributes.str;
+    const char *kv_end = NULL;
+    c2b_field_t kv_tok;
+    while (kv_str) {
+        kv_end = memchr(kv_str, ';', attributes_end - kv_str);
+        kv_tok.str = kv_str;
+        kv_tok.size = (kv_end ? kv_end : attributes_end) - kv_str;
+        if ((c2b_field_find(kv_tok, gtf_id_prefix)) && (kv_tok.size >= gtf_id_prefix_size + 2)) {
             /* we remove quotation marks around ID string value */
-            memcpy(c2b_globals.gtf->id, kv_tok + strlen(gtf_id_prefix) + 1, strlen(kv_tok + strlen(gtf_id_prefix)) - 2);
-            c2b_globals.gtf->id[strlen(kv_tok + strlen(gtf_id_prefix)) - 2] = '\0';
+            ctx->gtf.id_size = kv_tok.size - gtf_id_prefix_size - 2;
+            c2b_grow_buffer(&(ctx->gtf.id), &(ctx->gtf.id_capacity), ctx->gtf.id_size + 1, "GTF ID string");
+            memcpy(ctx->gtf.id, kv_tok.str + gtf_id_prefix_size + 1, ctx->gtf.id_size);
+            ctx->gtf.id[ctx->gtf.id_size] = '\0';
         }
+        kv_str = (kv_end) ? kv_end + 1 : NULL;
     }
-    free(attributes_copy), attributes_copy = NULL;
-    gtf.id = c2b_globals.gtf->id;
+    gtf.id.str = ctx->gtf.id;
+    gtf.id.size = ctx->gtf.id_size;
 
     /* 
        Convert GTF struct to BED string and copy it to destination
     */
 
-    c2b_line_convert_gtf_to_bed(gtf, dest, dest_size);
+    c2b_line_convert_gtf_to_bed(gtf, dest);
 }
 
 static inline void
-c2b_line_convert_gtf_to_bed(c2b_gtf_t g, char *dest_line, ssize_t *dest_size)
+c2b_line_convert_gtf_to_bed(c2b_gtf_t g, c2b_batch_t *dest)
 {
     /* 
        For GTF-formatted data, we use the mapping provided by BEDOPS convention described at:
@@ -1080,75 +621,27 @@ c2b_line_convert_gtf_to_bed(c2b_gtf_t g, char *dest_line, ssize_t *dest_size)
        comments                  11                     -
     */
 
-    if (strlen(g.comments) == 0) {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              g.seqname,
-                              g.start,
-                              g.end,
-                              g.id,
-                              g.score,
-                              g.strand,
-                              g.source,
-                              g.feature,
-                              g.frame,
-                              g.attributes);
-    }
-    else {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              g.seqname,
-                              g.start,
-                              g.end,
-                              g.id,
-                              g.score,
-                              g.strand,
-                              g.source,
-                              g.feature,
-                              g.frame,
-                              g.attributes,
-                              g.comments);
-    }
-}
-
-static void
-c2b_line_convert_gff_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
-{
-    ssize_t gff_field_offsets[C2B_MAX_FIELD_COUNT_VALUE];
-    int gff_field_idx = 0;
-    ssize_t current_src_posn = -1;
-
-    while (++current_src_posn < src_size) {
-        if ((src[current_src_posn] == c2b_tab_delim) || (src[current_src_posn] == c2b_line_delim)) {
-            gff_field_offsets[gff_field_idx++] = current_src_posn;
-        }
-        if (gff_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
-            fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", gff_field_idx);
-            c2b_print_usage(stderr);
-            exit(EINVAL); /* Invalid argument (POSIX.1) */
-        }
+    c2b_batch_append_record(dest, &g, c2b_gtf_columns, sizeof(c2b_gtf_columns) / sizeof(c2b_gtf_columns[0]));
+}
+
+static void
+c2b_block_convert_gff_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
+{
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_gff_to_bed_unsorted);
+}
+
+static void
+c2b_line_convert_gff_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
+{
+    char *src = line->src;
+    ssize_t src_size = line->size;
+    int gff_field_idx = line->field_idx;
+
+    if (gff_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
+        fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", gff_field_idx);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
-    gff_field_offsets[gff_field_idx] = src_size;
-    gff_field_offsets[gff_field_idx + 1] = -1;
 
     /* 
        If number of fields is not in bounds, we may need to exit early
@@ -1156,33 +649,25 @@ c2b_line_convert_gff_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
 
     if (((gff_field_idx + 1) < c2b_gff_field_min) || ((gff_field_idx + 1) > c2b_gff_field_max)) {
         if (gff_field_idx == 0) {
-            char non_interval_str[C2B_MAX_FIELD_LENGTH_VALUE];
-            memcpy(non_interval_str, src, current_src_posn);
-            non_interval_str[current_src_posn] = '\0';
-            char non_int_prefix[C2B_MAX_FIELD_LENGTH_VALUE];
-            strncpy(non_int_prefix, non_interval_str, 2);
-            non_int_prefix[2] = '\0';
+            c2b_field_t non_interval = c2b_line_field(line, 0);
+            c2b_field_t non_int_prefix = non_interval;
+            if (non_int_prefix.size > 2)
+                non_int_prefix.size = 2;
             /* We compare against either of two standard GFF3 or GVF header pragmas */
-            if ((strcmp(non_interval_str, c2b_gff_header) == 0) || 
-                (strcmp(non_interval_str, c2b_gvf_header) == 0) || 
-                (strcmp(non_int_prefix, c2b_gvf_generic_header) == 0)) {
-                if (!c2b_globals.keep_header_flag) {
+            if ((c2b_field_equals(non_interval, c2b_gff_header)) || 
+                (c2b_field_equals(non_interval, c2b_gvf_header)) || 
+                (c2b_field_equals(non_int_prefix, c2b_gvf_generic_header))) {
+                if (!ctx->options->keep_header_flag) {
                     return;
                 }
                 else {
                     /* copy header line to destination stream buffer */
-                    char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                    char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                    memcpy(src_header_line_str, src, src_size);
-                    src_header_line_str[src_size] = '\0';
-                    sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-                    memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-                    *dest_size += strlen(dest_header_line_str);
-                    c2b_globals.header_line_idx++;
+                    c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+                    ctx->header_line_idx++;
                     return;                    
                 }
             }
-            else if (strcmp(non_interval_str, c2b_gff_fasta) == 0) {
+            else if (c2b_field_equals(non_interval, c2b_gff_fasta)) {
                 return;
             }
             else {
@@ -1196,123 +681,86 @@ c2b_line_convert_gff_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         }
     }
 
+    c2b_gff_t gff;
+
     /* 0 - seqid */
-    char seqid_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t seqid_size = gff_field_offsets[0];
-    memcpy(seqid_str, src, seqid_size);
-    seqid_str[seqid_size] = '\0';
+    gff.seqid = c2b_line_field(line, 0);
 
     /* 1 - source */
-    char source_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t source_size = gff_field_offsets[1] - gff_field_offsets[0] - 1;
-    memcpy(source_str, src + gff_field_offsets[0] + 1, source_size);
-    source_str[source_size] = '\0';
+    gff.source = c2b_line_field(line, 1);
 
     /* 2 - type */
-    char type_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t type_size = gff_field_offsets[2] - gff_field_offsets[1] - 1;
-    memcpy(type_str, src + gff_field_offsets[1] + 1, type_size);
-    type_str[type_size] = '\0';
+    gff.type = c2b_line_field(line, 2);
 
     /* 3 - start */
-    char start_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t start_size = gff_field_offsets[3] - gff_field_offsets[2] - 1;
-    memcpy(start_str, src + gff_field_offsets[2] + 1, start_size);
-    start_str[start_size] = '\0';
-    uint64_t start_val = strtoull(start_str, NULL, 10);
+    gff.start = c2b_field_to_uint64(c2b_line_field(line, 3), "GFF start");
 
     /* 4 - end */
-    char end_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t end_size = gff_field_offsets[4] - gff_field_offsets[3] - 1;
-    memcpy(end_str, src + gff_field_offsets[3] + 1, end_size);
-    end_str[end_size] = '\0';
-    uint64_t end_val = strtoull(end_str, NULL, 10);
+    gff.end = c2b_field_to_uint64(c2b_line_field(line, 4), "GFF end");
 
     /* 5 - score */
-    char score_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t score_size = gff_field_offsets[5] - gff_field_offsets[4] - 1;
-    memcpy(score_str, src + gff_field_offsets[4] + 1, score_size);
-    score_str[score_size] = '\0';
+    gff.score = c2b_line_field(line, 5);
 
     /* 6 - strand */
-    char strand_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t strand_size = gff_field_offsets[6] - gff_field_offsets[5] - 1;
-    memcpy(strand_str, src + gff_field_offsets[5] + 1, strand_size);
-    strand_str[strand_size] = '\0';
+    gff.strand = c2b_line_field(line, 6);
 
     /* 7 - phase */
-    char phase_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t phase_size = gff_field_offsets[7] - gff_field_offsets[6] - 1;
-    memcpy(phase_str, src + gff_field_offsets[6] + 1, phase_size);
-    phase_str[phase_size] = '\0';
+    gff.phase = c2b_line_field(line, 7);
 
     /* 8 - attributes */
-    char attributes_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t attributes_size = gff_field_offsets[8] - gff_field_offsets[7] - 1;
-    memcpy(attributes_str, src + gff_field_offsets[7] + 1, attributes_size);
-    attributes_str[attributes_size] = '\0';
-
-    c2b_gff_t gff;
-    gff.seqid = seqid_str;
-    gff.source = source_str;
-    gff.type = type_str;
-    gff.start = start_val;
-    gff.end = end_val;
-    gff.score = score_str;
-    gff.strand = strand_str;
-    gff.phase = phase_str;
-    gff.attributes = attributes_str;
+    gff.attributes = c2b_line_field(line, 8);
 
     /* 
-       Fix coordinate indexing, and (if needed) add attribute for zero-length record
+       Fix coordinate indexing, and (if needed) add attribute for zero-length record; 
+       this is the one case where the attributes are copied
     */
 
     if (gff.start == gff.end) {
-        gff.start -= 1;
-        ssize_t trailing_semicolon_fudge = (attributes_str[strlen(attributes_str) - 1] == ';') ? 1 : 0;
-        memcpy(attributes_str + strlen(attributes_str) - trailing_semicolon_fudge,
+        ssize_t trailing_semicolon_fudge = ((gff.attributes.size > 0) && (gff.attributes.str[gff.attributes.size - 1] == ';')) ? 1 : 0;
+        ssize_t attributes_size = gff.attributes.size - trailing_semicolon_fudge;
+        char *attributes_str = c2b_alloc_field(ctx, attributes_size + strlen(c2b_gff_zero_length_insertion_attribute));
+        memcpy(attributes_str, gff.attributes.str, attributes_size);
+        memcpy(attributes_str + attributes_size,
                c2b_gff_zero_length_insertion_attribute, 
                strlen(c2b_gff_zero_length_insertion_attribute) + 1);
+        gff.attributes.str = attributes_str;
+        gff.attributes.size = attributes_size + strlen(c2b_gff_zero_length_insertion_attribute);
     }
-    else {
-        gff.start -= 1;
-    }
+    gff.start -= 1;
 
     /* 
        Parse ID value out from attributes string
     */
 
-    char *attributes_copy = NULL;
-    attributes_copy = malloc(strlen(attributes_str) + 1);
-    if (!attributes_copy) {
-        fprintf(stderr, "Error: Could not allocate space for GFF attributes copy\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
-    memcpy(attributes_copy, attributes_str, strlen(attributes_str) + 1);
-    const char *kv_tok;
     const char *gff_id_prefix = "ID=";
     const char *gff_null_id = ".";
-    char *id_str = NULL;
-    memcpy(c2b_globals.gff->id, gff_null_id, strlen(gff_null_id) + 1);
-    while ((kv_tok = c2b_strsep(&attributes_copy, ";")) != NULL) {
-        id_str = strstr(kv_tok, gff_id_prefix);
-        if (id_str) {
-            memcpy(c2b_globals.gff->id, kv_tok + strlen(gff_id_prefix), strlen(kv_tok + strlen(gff_id_prefix)) + 1);
-            c2b_globals.gff->id[strlen(kv_tok + strlen(gff_id_prefix)) + 1] = '\0';
+    ssize_t gff_id_prefix_size = strlen(gff_id_prefix);
+    const char *attributes_end = gff.attributes.str + gff.attributes.size;
+    const char *kv_str = gff.attributes.str;
+    const char *kv_end = NULL;
+    c2b_field_t kv_tok;
+    gff.id.str = gff_null_id;
+    gff.id.size = strlen(gff_null_id);
+    while (kv_str) {
+        kv_end = memchr(kv_str, ';', attributes_end - kv_str);
+        kv_tok.str = kv_str;
+        kv_tok.size = (kv_end ? kv_end : attributes_end) - kv_str;
+        if (c2b_field_find(kv_tok, gff_id_prefix)) {
+            gff.id.str = kv_tok.str + gff_id_prefix_size;
+            gff.id.size = kv_tok.size - gff_id_prefix_size;
         }
+        kv_str = (kv_end) ? kv_end + 1 : NULL;
     }
-    free(attributes_copy), attributes_copy = NULL;
-    gff.id = c2b_globals.gff->id;
 
     /* 
        Convert GFF struct to BED string and copy it to destination
     */
 
-    c2b_line_convert_gff_to_bed(gff, dest, dest_size);
+    c2b_line_convert_gff_to_bed(gff, dest);
 }
 
 static inline void
-c2b_line_convert_gff_to_bed(c2b_gff_t g, char *dest_line, ssize_t *dest_size)
+c2b_line_convert_gff_to_bed(c2b_gff_t g, c2b_batch_t *dest)
 {
     /* 
        For GFF- and GVF-formatted data, we use the mapping provided by BEDOPS convention described at:
@@ -1338,48 +786,27 @@ c2b_line_convert_gff_to_bed(c2b_gff_t g, char *dest_line, ssize_t *dest_size)
        attributes                10                     -
     */
 
-    *dest_size += sprintf(dest_line + *dest_size,
-                          "%s\t"                \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%s\t"                \
-                          "%s\t"                \
-                          "%s\t"                \
-                          "%s\t"                \
-                          "%s\t"                \
-                          "%s\t"                \
-                          "%s\n",
-                          g.seqid,
-                          g.start,
-                          g.end,
-                          g.id,
-                          g.score,
-                          g.strand,
-                          g.source,
-                          g.type,
-                          g.phase,
-                          g.attributes);
-}
-
-static void
-c2b_line_convert_psl_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
-{
-    ssize_t psl_field_offsets[C2B_MAX_FIELD_COUNT_VALUE];
-    int psl_field_idx = 0;
-    ssize_t current_src_posn = -1;
-
-    while (++current_src_posn < src_size) {
-        if ((src[current_src_posn] == c2b_tab_delim) || (src[current_src_posn] == c2b_line_delim)) {
-            psl_field_offsets[psl_field_idx++] = current_src_posn;
-        }
-        if (psl_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
-            fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", psl_field_idx);
-            c2b_print_usage(stderr);
-            exit(EINVAL); /* Invalid argument (POSIX.1) */
-        }
+    c2b_batch_append_record(dest, &g, c2b_gff_columns, sizeof(c2b_gff_columns) / sizeof(c2b_gff_columns[0]));
+}
+
+static void
+c2b_block_convert_psl_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
+{
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_psl_to_bed_unsorted);
+}
+
+static void
+c2b_line_convert_psl_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
+{
+    char *src = line->src;
+    ssize_t src_size = line->size;
+    int psl_field_idx = line->field_idx;
+
+    if (psl_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
+        fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", psl_field_idx);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
-    psl_field_offsets[psl_field_idx] = src_size;
-    psl_field_offsets[psl_field_idx + 1] = -1;
 
     /* 
        If number of fields is not in bounds, we may need to exit early
@@ -1387,24 +814,18 @@ c2b_line_convert_psl_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
 
     if (((psl_field_idx + 1) < c2b_psl_field_min) || ((psl_field_idx + 1) > c2b_psl_field_max)) {
         if ((psl_field_idx == 0) || (psl_field_idx == 17)) {
-            if ((c2b_globals.psl->is_headered) && (c2b_globals.keep_header_flag) && (c2b_globals.header_line_idx <= 5)) {
+            if ((ctx->options->psl_is_headered) && (ctx->options->keep_header_flag) && (ctx->header_line_idx <= 5)) {
                 /* copy header line to destination stream buffer */
-                char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                memcpy(src_header_line_str, src, src_size);
-                src_header_line_str[src_size] = '\0';
-                sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-                memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-                *dest_size += strlen(dest_header_line_str);
-                c2b_globals.header_line_idx++;
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+                ctx->header_line_idx++;
                 return;                    
             }
-            else if ((c2b_globals.psl->is_headered) && (c2b_globals.header_line_idx <= 5)) {
-                c2b_globals.header_line_idx++;
+            else if ((ctx->options->psl_is_headered) && (ctx->header_line_idx <= 5)) {
+                ctx->header_line_idx++;
                 return;
             }
             else {
-                fprintf(stderr, "Error: Possible corrupt input on line %u -- if PSL input is headered, use the --headered option\n", c2b_globals.header_line_idx);
+                fprintf(stderr, "Error: Possible corrupt input on line %u -- if PSL input is headered, use the --headered option\n", ctx->header_line_idx);
                 c2b_print_usage(stderr);
                 exit(EINVAL); /* Invalid argument (POSIX.1) */
             }
@@ -1416,15 +837,14 @@ c2b_line_convert_psl_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         }
     }
 
+    c2b_psl_t psl;
+
     /* 0 - matches */
-    char matches_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t matches_size = psl_field_offsets[0];
-    memcpy(matches_str, src, matches_size);
-    matches_str[matches_size] = '\0';
-    uint64_t matches_val = strtoull(matches_str, NULL, 10);
+    c2b_field_t matches_field = c2b_line_field(line, 0);
+    boolean matches_is_number = c2b_parse_uint64(matches_field, &psl.matches);
 
 #ifdef DEBUG
-    fprintf(stderr, "matches_str: [%s]\n", matches_str);
+    fprintf(stderr, "matches: [%.*s]\n", (int) matches_field.size, matches_field.str);
 #endif
 
     /* 
@@ -1432,359 +852,238 @@ c2b_line_convert_psl_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
        lines can mimic a genomic element
     */
 
-    if ((matches_val == 0) && (!isdigit(matches_str[0]))) {
-        if ((c2b_globals.psl->is_headered) && (c2b_globals.keep_header_flag) && (c2b_globals.header_line_idx <= 5)) {
+    if (!matches_is_number) {
+        if ((ctx->options->psl_is_headered) && (ctx->options->keep_header_flag) && (ctx->header_line_idx <= 5)) {
             /* copy header line to destination stream buffer */
-            char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-            char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-            memcpy(src_header_line_str, src, src_size);
-            src_header_line_str[src_size] = '\0';
-            sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-            memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-            *dest_size += strlen(dest_header_line_str);
-            c2b_globals.header_line_idx++;
+            c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+            ctx->header_line_idx++;
         }
         return;
     }
 
     /* 1 - misMatches */
-    char misMatches_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t misMatches_size = psl_field_offsets[1] - psl_field_offsets[0] - 1;
-    memcpy(misMatches_str, src + psl_field_offsets[0] + 1, misMatches_size);
-    misMatches_str[misMatches_size] = '\0';
-    uint64_t misMatches_val = strtoull(misMatches_str, NULL, 10);
-    
+    c2b_field_t misMatches_field = c2b_line_field(line, 1);
+    psl.misMatches = c2b_field_to_uint64(misMatches_field, "PSL misMatches");
+
 #ifdef DEBUG
-    fprintf(stderr, "misMatches_str: [%s]\n", misMatches_str);
+    fprintf(stderr, "misMatches: [%.*s]\n", (int) misMatches_field.size, misMatches_field.str);
 #endif
 
     /* 2 - repMatches */
-    char repMatches_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t repMatches_size = psl_field_offsets[2] - psl_field_offsets[1] - 1;
-    memcpy(repMatches_str, src + psl_field_offsets[1] + 1, repMatches_size);
-    repMatches_str[repMatches_size] = '\0';
-    uint64_t repMatches_val = strtoull(repMatches_str, NULL, 10);
+    c2b_field_t repMatches_field = c2b_line_field(line, 2);
+    psl.repMatches = c2b_field_to_uint64(repMatches_field, "PSL repMatches");
 
 #ifdef DEBUG
-    fprintf(stderr, "repMatches_str: [%s]\n", repMatches_str);
+    fprintf(stderr, "repMatches: [%.*s]\n", (int) repMatches_field.size, repMatches_field.str);
 #endif
 
     /* 3 - nCount */
-    char nCount_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t nCount_size = psl_field_offsets[3] - psl_field_offsets[2] - 1;
-    memcpy(nCount_str, src + psl_field_offsets[2] + 1, nCount_size);
-    nCount_str[nCount_size] = '\0';
-    uint64_t nCount_val = strtoull(nCount_str, NULL, 10);
+    c2b_field_t nCount_field = c2b_line_field(line, 3);
+    psl.nCount = c2b_field_to_uint64(nCount_field, "PSL nCount");
 
 #ifdef DEBUG
-    fprintf(stderr, "nCount_str: [%s]\n", nCount_str);
+    fprintf(stderr, "nCount: [%.*s]\n", (int) nCount_field.size, nCount_field.str);
 #endif
 
     /* 4 - qNumInsert */
-    char qNumInsert_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qNumInsert_size = psl_field_offsets[4] - psl_field_offsets[3] - 1;
-    memcpy(qNumInsert_str, src + psl_field_offsets[3] + 1, qNumInsert_size);
-    qNumInsert_str[qNumInsert_size] = '\0';
-    uint64_t qNumInsert_val = strtoull(qNumInsert_str, NULL, 10);
+    c2b_field_t qNumInsert_field = c2b_line_field(line, 4);
+    psl.qNumInsert = c2b_field_to_uint64(qNumInsert_field, "PSL qNumInsert");
 
 #ifdef DEBUG
-    fprintf(stderr, "qNumInsert_str: [%s]\n", qNumInsert_str);
+    fprintf(stderr, "qNumInsert: [%.*s]\n", (int) qNumInsert_field.size, qNumInsert_field.str);
 #endif
 
     /* 5 - qBaseInsert */
-    char qBaseInsert_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qBaseInsert_size = psl_field_offsets[5] - psl_field_offsets[4] - 1;
-    memcpy(qBaseInsert_str, src + psl_field_offsets[4] + 1, qBaseInsert_size);
-    qBaseInsert_str[qBaseInsert_size] = '\0';
-    uint64_t qBaseInsert_val = strtoull(qBaseInsert_str, NULL, 10);
+    c2b_field_t qBaseInsert_field = c2b_line_field(line, 5);
+    psl.qBaseInsert = c2b_field_to_uint64(qBaseInsert_field, "PSL qBaseInsert");
 
 #ifdef DEBUG
-    fprintf(stderr, "qBaseInsert_str: [%s]\n", qBaseInsert_str);
+    fprintf(stderr, "qBaseInsert: [%.*s]\n", (int) qBaseInsert_field.size, qBaseInsert_field.str);
 #endif
 
     /* 6 - tNumInsert */
-    char tNumInsert_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tNumInsert_size = psl_field_offsets[6] - psl_field_offsets[5] - 1;
-    memcpy(tNumInsert_str, src + psl_field_offsets[5] + 1, tNumInsert_size);
-    tNumInsert_str[tNumInsert_size] = '\0';
-    uint64_t tNumInsert_val = strtoull(tNumInsert_str, NULL, 10);
+    c2b_field_t tNumInsert_field = c2b_line_field(line, 6);
+    psl.tNumInsert = c2b_field_to_uint64(tNumInsert_field, "PSL tNumInsert");
 
 #ifdef DEBUG
-    fprintf(stderr, "tNumInsert_str: [%s]\n", tNumInsert_str);
+    fprintf(stderr, "tNumInsert: [%.*s]\n", (int) tNumInsert_field.size, tNumInsert_field.str);
 #endif
 
     /* 7 - tBaseInsert */
-    char tBaseInsert_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tBaseInsert_size = psl_field_offsets[7] - psl_field_offsets[6] - 1;
-    memcpy(tBaseInsert_str, src + psl_field_offsets[6] + 1, tBaseInsert_size);
-    tBaseInsert_str[tBaseInsert_size] = '\0';
-    uint64_t tBaseInsert_val = strtoull(tBaseInsert_str, NULL, 10);
+    c2b_field_t tBaseInsert_field = c2b_line_field(line, 7);
+    psl.tBaseInsert = c2b_field_to_uint64(tBaseInsert_field, "PSL tBaseInsert");
 
 #ifdef DEBUG
-    fprintf(stderr, "tBaseInsert_str: [%s]\n", tBaseInsert_str);
+    fprintf(stderr, "tBaseInsert: [%.*s]\n", (int) tBaseInsert_field.size, tBaseInsert_field.str);
 #endif
 
     /* 8 - strand */
-    char strand_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t strand_size = psl_field_offsets[8] - psl_field_offsets[7] - 1;
-    memcpy(strand_str, src + psl_field_offsets[7] + 1, strand_size);
-    strand_str[strand_size] = '\0';
+    psl.strand = c2b_line_field(line, 8);
 
 #ifdef DEBUG
-    fprintf(stderr, "strand_str: [%s]\n", strand_str);
+    fprintf(stderr, "strand: [%.*s]\n", (int) psl.strand.size, psl.strand.str);
 #endif
 
     /* 9 - qName */
-    char qName_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qName_size = psl_field_offsets[9] - psl_field_offsets[8] - 1;
-    memcpy(qName_str, src + psl_field_offsets[8] + 1, qName_size);
-    qName_str[qName_size] = '\0';
+    psl.qName = c2b_line_field(line, 9);
 
 #ifdef DEBUG
-    fprintf(stderr, "qName_str: [%s]\n", qName_str);
+    fprintf(stderr, "qName: [%.*s]\n", (int) psl.qName.size, psl.qName.str);
 #endif
 
     /* 10 - qSize */
-    char qSize_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qSize_size = psl_field_offsets[10] - psl_field_offsets[9] - 1;
-    memcpy(qSize_str, src + psl_field_offsets[9] + 1, qSize_size);
-    qSize_str[qSize_size] = '\0';
-    uint64_t qSize_val = strtoull(qSize_str, NULL, 10);
+    c2b_field_t qSize_field = c2b_line_field(line, 10);
+    psl.qSize = c2b_field_to_uint64(qSize_field, "PSL qSize");
 
 #ifdef DEBUG
-    fprintf(stderr, "qSize_str: [%s]\n", qSize_str);
+    fprintf(stderr, "qSize: [%.*s]\n", (int) qSize_field.size, qSize_field.str);
 #endif
 
     /* 11 - qStart */
-    char qStart_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qStart_size = psl_field_offsets[11] - psl_field_offsets[10] - 1;
-    memcpy(qStart_str, src + psl_field_offsets[10] + 1, qStart_size);
-    qStart_str[qStart_size] = '\0';
-    uint64_t qStart_val = strtoull(qStart_str, NULL, 10);
+    c2b_field_t qStart_field = c2b_line_field(line, 11);
+    psl.qStart = c2b_field_to_uint64(qStart_field, "PSL qStart");
 
 #ifdef DEBUG
-    fprintf(stderr, "qStart_str: [%s]\n", qStart_str);
+    fprintf(stderr, "qStart: [%.*s]\n", (int) qStart_field.size, qStart_field.str);
 #endif
 
     /* 12 - qEnd */
-    char qEnd_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qEnd_size = psl_field_offsets[12] - psl_field_offsets[11] - 1;
-    memcpy(qEnd_str, src + psl_field_offsets[11] + 1, qEnd_size);
-    qEnd_str[qEnd_size] = '\0';
-    uint64_t qEnd_val = strtoull(qEnd_str, NULL, 10);
+    c2b_field_t qEnd_field = c2b_line_field(line, 12);
+    psl.qEnd = c2b_field_to_uint64(qEnd_field, "PSL qEnd");
 
 #ifdef DEBUG
-    fprintf(stderr, "qEnd_str: [%s]\n", qEnd_str);
+    fprintf(stderr, "qEnd: [%.*s]\n", (int) qEnd_field.size, qEnd_field.str);
 #endif
 
     /* 13 - tName */
-    char tName_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tName_size = psl_field_offsets[13] - psl_field_offsets[12] - 1;
-    memcpy(tName_str, src + psl_field_offsets[12] + 1, tName_size);
-    tName_str[tName_size] = '\0';
+    psl.tName = c2b_line_field(line, 13);
 
 #ifdef DEBUG
-    fprintf(stderr, "tName_str: [%s]\n", tName_str);
+    fprintf(stderr, "tName: [%.*s]\n", (int) psl.tName.size, psl.tName.str);
 #endif
 
     /* 14 - tSize */
-    char tSize_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tSize_size = psl_field_offsets[14] - psl_field_offsets[13] - 1;
-    memcpy(tSize_str, src + psl_field_offsets[13] + 1, tSize_size);
-    tSize_str[tSize_size] = '\0';
-    uint64_t tSize_val = strtoull(tSize_str, NULL, 10);
+    c2b_field_t tSize_field = c2b_line_field(line, 14);
+    psl.tSize = c2b_field_to_uint64(tSize_field, "PSL tSize");
 
 #ifdef DEBUG
-    fprintf(stderr, "tSize_str: [%s]\n", tSize_str);
+    fprintf(stderr, "tSize: [%.*s]\n", (int) tSize_field.size, tSize_field.str);
 #endif
 
     /* 15 - tStart */
-    char tStart_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tStart_size = psl_field_offsets[15] - psl_field_offsets[14] - 1;
-    memcpy(tStart_str, src + psl_field_offsets[14] + 1, tStart_size);
-    tStart_str[tStart_size] = '\0';
-    uint64_t tStart_val = strtoull(tStart_str, NULL, 10);
+    c2b_field_t tStart_field = c2b_line_field(line, 15);
+    psl.tStart = c2b_field_to_uint64(tStart_field, "PSL tStart");
 
 #ifdef DEBUG
-    fprintf(stderr, "tStart_str: [%s]\n", tStart_str);
+    fprintf(stderr, "tStart: [%.*s]\n", (int) tStart_field.size, tStart_field.str);
 #endif
 
     /* 16 - tEnd */
-    char tEnd_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tEnd_size = psl_field_offsets[16] - psl_field_offsets[15] - 1;
-    memcpy(tEnd_str, src + psl_field_offsets[15] + 1, tEnd_size);
-    tEnd_str[tEnd_size] = '\0';
-    uint64_t tEnd_val = strtoull(tEnd_str, NULL, 10);
+    c2b_field_t tEnd_field = c2b_line_field(line, 16);
+    psl.tEnd = c2b_field_to_uint64(tEnd_field, "PSL tEnd");
 
 #ifdef DEBUG
-    fprintf(stderr, "tEnd_str: [%s]\n", tEnd_str);
+    fprintf(stderr, "tEnd: [%.*s]\n", (int) tEnd_field.size, tEnd_field.str);
 #endif
 
     /* 17 - blockCount */
-    char blockCount_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t blockCount_size = psl_field_offsets[17] - psl_field_offsets[16] - 1;
-    memcpy(blockCount_str, src + psl_field_offsets[16] + 1, blockCount_size);
-    blockCount_str[blockCount_size] = '\0';
-    uint64_t blockCount_val = strtoull(blockCount_str, NULL, 10);
+    c2b_field_t blockCount_field = c2b_line_field(line, 17);
+    psl.blockCount = c2b_field_to_uint64(blockCount_field, "PSL blockCount");
 
 #ifdef DEBUG
-    fprintf(stderr, "blockCount_str: [%s]\n", blockCount_str);
+    fprintf(stderr, "blockCount: [%.*s]\n", (int) blockCount_field.size, blockCount_field.str);
 #endif
 
     /* 18 - blockSizes */
-    char blockSizes_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t blockSizes_size = psl_field_offsets[18] - psl_field_offsets[17] - 1;
-    memcpy(blockSizes_str, src + psl_field_offsets[17] + 1, blockSizes_size);
-    blockSizes_str[blockSizes_size] = '\0';
+    psl.blockSizes = c2b_line_field(line, 18);
 
 #ifdef DEBUG
-    fprintf(stderr, "blockSizes_str: [%s]\n", blockSizes_str);
+    fprintf(stderr, "blockSizes: [%.*s]\n", (int) psl.blockSizes.size, psl.blockSizes.str);
 #endif
 
     /* 19 - qStarts */
-    char qStarts_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qStarts_size = psl_field_offsets[19] - psl_field_offsets[18] - 1;
-    memcpy(qStarts_str, src + psl_field_offsets[18] + 1, qStarts_size);
-    qStarts_str[qStarts_size] = '\0';
+    psl.qStarts = c2b_line_field(line, 19);
 
 #ifdef DEBUG
-    fprintf(stderr, "qStarts_str: [%s]\n", qStarts_str);
+    fprintf(stderr, "qStarts: [%.*s]\n", (int) psl.qStarts.size, psl.qStarts.str);
 #endif
 
     /* 20 - tStarts */
-    char tStarts_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tStarts_size = psl_field_offsets[20] - psl_field_offsets[19] - 1;
-    memcpy(tStarts_str, src + psl_field_offsets[19] + 1, tStarts_size);
-    tStarts_str[tStarts_size] = '\0';
+    psl.tStarts = c2b_line_field(line, 20);
 
 #ifdef DEBUG
-    fprintf(stderr, "tStarts_str: [%s]\n", tStarts_str);
+    fprintf(stderr, "tStarts: [%.*s]\n", (int) psl.tStarts.size, psl.tStarts.str);
 #endif
 
-    c2b_psl_t psl;
-    psl.matches = matches_val;
-    psl.misMatches = misMatches_val;
-    psl.repMatches = repMatches_val;
-    psl.nCount = nCount_val;
-    psl.qNumInsert = qNumInsert_val;
-    psl.qBaseInsert = qBaseInsert_val;
-    psl.tNumInsert = tNumInsert_val;
-    psl.tBaseInsert = tBaseInsert_val;
-    psl.strand = strand_str;
-    psl.qName = qName_str;
-    psl.qSize = qSize_val;
-    psl.qStart = qStart_val;
-    psl.qEnd = qEnd_val;
-    psl.tName = tName_str;
-    psl.tSize = tSize_val;
-    psl.tStart = tStart_val;
-    psl.tEnd = tEnd_val;
-    psl.blockCount = blockCount_val;
-    psl.blockSizes = blockSizes_str;
-    psl.qStarts = qStarts_str;
-    psl.tStarts = tStarts_str;
-
     /* 
        Convert PSL struct to BED string and copy it to destination
     */
 
-    if ((c2b_globals.split_flag) && (blockCount_val > 1)) {
-        if (c2b_globals.psl->block->max_count < blockCount_val) {
+    if ((ctx->options->split_flag) && (psl.blockCount > 1)) {
+        if (ctx->psl.block->max_count < psl.blockCount) {
             fprintf(stderr, "Error: Insufficent PSL block state global size\n");
             exit(ENOMEM); /* Not enough space (POSIX.1) */
         }
         /* parse tStarts_str and blockSizes_str to write per-block elements */
-        c2b_psl_blockSizes_to_ptr(blockSizes_str, blockCount_val);
-        c2b_psl_tStarts_to_ptr(tStarts_str, blockCount_val);
-        for (uint64_t bc_idx = 0; bc_idx < blockCount_val; bc_idx++) {
-            psl.tStart = c2b_globals.psl->block->starts[bc_idx];
-            psl.tEnd = c2b_globals.psl->block->starts[bc_idx] + c2b_globals.psl->block->sizes[bc_idx];
-            c2b_line_convert_psl_to_bed(psl, dest, dest_size);
+        c2b_psl_blockSizes_to_ptr(ctx->psl.block, psl.blockSizes, psl.blockCount);
+        c2b_psl_tStarts_to_ptr(ctx->psl.block, psl.tStarts, psl.blockCount);
+        for (uint64_t bc_idx = 0; bc_idx < psl.blockCount; bc_idx++) {
+            psl.tStart = ctx->psl.block->starts[bc_idx];
+            psl.tEnd = ctx->psl.block->starts[bc_idx] + ctx->psl.block->sizes[bc_idx];
+            c2b_line_convert_psl_to_bed(psl, dest);
         }
     }
     else {
-        c2b_line_convert_psl_to_bed(psl, dest, dest_size);
+        c2b_line_convert_psl_to_bed(psl, dest);
     }
 }
 
 static inline void
-c2b_psl_blockSizes_to_ptr(char *s, uint64_t bc) 
+c2b_psl_blockSizes_to_ptr(c2b_psl_block_t *block, c2b_field_t s, uint64_t bc) 
 {
-    size_t start_bs_offset = 0;
-    size_t end_bs_index = 0;
-    size_t length_bs_offset = 0;
+    ssize_t start_bs_offset = 0;
     uint64_t bc_idx;
-    char bs_arr[C2B_MAX_PSL_BLOCK_SIZES_STRING_LENGTH];
-    char *bs_ptr = NULL;
-    uint64_t bs_val = 0;
+    const char *bs_ptr = NULL;
+    c2b_field_t bs;
 
     for (bc_idx = 0; bc_idx < bc; bc_idx++) {
-        bs_ptr = strchr(s + start_bs_offset, c2b_psl_blockSizes_delimiter);
-#ifdef DEBUG
-        fprintf(stderr, "s: [%s] | bs_ptr: [%s]\n", s, bs_ptr);
-#endif
+        bs_ptr = memchr(s.str + start_bs_offset, c2b_psl_blockSizes_delimiter, s.size - start_bs_offset);
         if (bs_ptr) {
-            end_bs_index = bs_ptr - s;
-#ifdef DEBUG
-            fprintf(stderr, "start_bs_offset: [%zu] | end_bs_index: [%zu]\n", start_bs_offset, end_bs_index);
-#endif
-            length_bs_offset = end_bs_index - start_bs_offset;
-            if (length_bs_offset > C2B_MAX_PSL_BLOCK_SIZES_STRING_LENGTH) {
-                fprintf(stderr, "Error: PSL block size string length too long\n");
-                exit(EINVAL); // Invalid argument (POSIX.1)
-            }
-            memcpy(bs_arr, s + start_bs_offset, length_bs_offset);
-            bs_arr[length_bs_offset] = '\0';
+            bs.str = s.str + start_bs_offset;
+            bs.size = bs_ptr - bs.str;
 #ifdef DEBUG
-            fprintf(stderr, "bs_arr: [%s]\n", bs_arr);
+            fprintf(stderr, "bs: [%.*s]\n", (int) bs.size, bs.str);
 #endif
-            bs_val = strtoull(bs_arr, NULL, 10);
-            c2b_globals.psl->block->sizes[bc_idx] = bs_val;
-            start_bs_offset = end_bs_index + 1;
+            block->sizes[bc_idx] = c2b_field_to_uint64(bs, "PSL block size");
+            start_bs_offset = bs_ptr - s.str + 1;
         }
     }
 }
 
 static inline void
-c2b_psl_tStarts_to_ptr(char *s, uint64_t bc) 
+c2b_psl_tStarts_to_ptr(c2b_psl_block_t *block, c2b_field_t s, uint64_t bc) 
 {
-    size_t start_ts_offset = 0;
-    size_t end_ts_index = 0;
-    size_t length_ts_offset = 0;
+    ssize_t start_ts_offset = 0;
     uint64_t bc_idx;
-    char ts_arr[C2B_MAX_PSL_T_STARTS_STRING_LENGTH];
-    char *ts_ptr = NULL;
-    uint64_t ts_val = 0;
+    const char *ts_ptr = NULL;
+    c2b_field_t ts;
 
     for (bc_idx = 0; bc_idx < bc; bc_idx++) {
-        ts_ptr = strchr(s + start_ts_offset, c2b_psl_tStarts_delimiter);
-#ifdef DEBUG
-        fprintf(stderr, "s: [%s] | ts_ptr: [%s]\n", s, ts_ptr);
-#endif
+        ts_ptr = memchr(s.str + start_ts_offset, c2b_psl_tStarts_delimiter, s.size - start_ts_offset);
         if (ts_ptr) {
-            end_ts_index = ts_ptr - s;
-#ifdef DEBUG
-            fprintf(stderr, "start_ts_offset: [%zu] | end_ts_index: [%zu]\n", start_ts_offset, end_ts_index);
-#endif
-            length_ts_offset = end_ts_index - start_ts_offset;
-            if (length_ts_offset > C2B_MAX_PSL_T_STARTS_STRING_LENGTH) {
-                fprintf(stderr, "Error: PSL block start string length too long\n");
-                exit(EINVAL); // Invalid argument (POSIX.1)
-            }
-            memcpy(ts_arr, s + start_ts_offset, length_ts_offset);
-            ts_arr[length_ts_offset] = '\0';
+            ts.str = s.str + start_ts_offset;
+            ts.size = ts_ptr - ts.str;
 #ifdef DEBUG
-            fprintf(stderr, "ts_arr: [%s]\n", ts_arr);
+            fprintf(stderr, "ts: [%.*s]\n", (int) ts.size, ts.str);
 #endif
-            ts_val = strtoull(ts_arr, NULL, 10);
-            c2b_globals.psl->block->starts[bc_idx] = ts_val;
-            start_ts_offset = end_ts_index + 1;
+            block->starts[bc_idx] = c2b_field_to_uint64(ts, "PSL block start");
+            start_ts_offset = ts_ptr - s.str + 1;
         }
     }
 }
 
 static inline void
-c2b_line_convert_psl_to_bed(c2b_psl_t p, char *dest_line, ssize_t *dest_size)
+c2b_line_convert_psl_to_bed(c2b_psl_t p, c2b_batch_t *dest)
 {
     /* 
        For PSL-formatted data, we use the mapping provided by BEDOPS convention described at:
@@ -1821,59 +1120,25 @@ c2b_line_convert_psl_to_bed(c2b_psl_t p, char *dest_line, ssize_t *dest_size)
        tStarts                   21                     -
     */
 
-    *dest_size += sprintf(dest_line + *dest_size,
-                          "%s\t"                \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%s\t"                \
-                          "%" PRIu64 "\t"       \
-                          "%s\t"                \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%" PRIu64 "\t"       \
-                          "%s\t"                \
-                          "%s\t"                \
-                          "%s\n",
-                          p.tName,
-                          p.tStart,
-                          p.tEnd,
-                          p.qName,
-                          p.matches,
-                          p.strand,
-                          p.qSize,
-                          p.misMatches,
-                          p.repMatches,
-                          p.nCount,
-                          p.qNumInsert,
-                          p.qBaseInsert,
-                          p.tNumInsert,
-                          p.tBaseInsert,
-                          p.qStart,
-                          p.qEnd,
-                          p.tSize,
-                          p.blockCount,
-                          p.blockSizes,
-                          p.qStarts,
-                          p.tStarts);
-}
-
-static void
-c2b_line_convert_rmsk_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
+    c2b_batch_append_record(dest, &p, c2b_psl_columns, sizeof(c2b_psl_columns) / sizeof(c2b_psl_columns[0]));
+}
+
+static void
+c2b_block_convert_rmsk_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
+{
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_rmsk_to_bed_unsorted);
+}
+
+static void
+c2b_line_convert_rmsk_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
 {
     /* 
        RepeatMasker annotation output is space-delimited and can have multiple spaces. We also need to walk
        past the first lines of the the output data to skip the header.
     */
 
+    char *src = line->src;
+    ssize_t src_size = line->size;
     ssize_t rmsk_field_start_offsets[C2B_MAX_FIELD_COUNT_VALUE];
     ssize_t rmsk_field_end_offsets[C2B_MAX_FIELD_COUNT_VALUE];
     int rmsk_field_start_idx = 0;
@@ -1882,11 +1147,11 @@ c2b_line_convert_rmsk_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
 
     while (current_src_posn < src_size) {
         /* within bounds */
-        if (((current_src_posn + 1) < src_size) && (c2b_globals.rmsk->line >= c2b_rmsk_header_line_count)) {
+        if (((current_src_posn + 1) < src_size) && (ctx->rmsk.line >= c2b_rmsk_header_line_count)) {
             /* skip over any initial spaces */
-            while (c2b_globals.rmsk->is_start_of_line) {
+            while (ctx->rmsk.is_start_of_line) {
                 if ((src[current_src_posn] != c2b_space_delim) && (src[current_src_posn] != c2b_line_delim)) {
-                    c2b_globals.rmsk->is_start_of_line = kFalse;
+                    ctx->rmsk.is_start_of_line = kFalse;
                     rmsk_field_start_offsets[rmsk_field_start_idx++] = current_src_posn; /* 0th offset is *start* of actual data */
                     break;
                 }
@@ -1899,14 +1164,14 @@ c2b_line_convert_rmsk_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
             }
             /* if current position is a space delimiter, we keep reading until there are no more spaces */
             if (src[current_src_posn] == c2b_space_delim) {
-                c2b_globals.rmsk->is_start_of_gap = kTrue;
-                if (c2b_globals.rmsk->is_start_of_gap) {
+                ctx->rmsk.is_start_of_gap = kTrue;
+                if (ctx->rmsk.is_start_of_gap) {
                     rmsk_field_end_offsets[rmsk_field_end_idx++] = current_src_posn; /* current offset is end of current field */
                 }
                 /* walk through gap until next field is found */
-                while (c2b_globals.rmsk->is_start_of_gap) {
+                while (ctx->rmsk.is_start_of_gap) {
                     if (src[current_src_posn++] != c2b_space_delim) {
-                        c2b_globals.rmsk->is_start_of_gap = kFalse;
+                        ctx->rmsk.is_start_of_gap = kFalse;
                         rmsk_field_start_offsets[rmsk_field_start_idx++] = current_src_posn - 1; /* current offset is start of next field */
                         if (src[current_src_posn] == c2b_line_delim) {
                             rmsk_field_end_offsets[rmsk_field_end_idx++] = current_src_posn;
@@ -1919,27 +1184,21 @@ c2b_line_convert_rmsk_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
             /* if current position is a line delimiter, we increment some indices */
             else if (src[current_src_posn] == c2b_line_delim) {
                 rmsk_field_end_offsets[rmsk_field_end_idx++] = current_src_posn;
-                c2b_globals.rmsk->line++;
-                c2b_globals.rmsk->is_start_of_line = kTrue;
-                c2b_globals.rmsk->is_start_of_gap = kFalse;
+                ctx->rmsk.line++;
+                ctx->rmsk.is_start_of_line = kTrue;
+                ctx->rmsk.is_start_of_gap = kFalse;
             }
         }
         else {
             if (src[current_src_posn + 1] == c2b_line_delim) {
                 rmsk_field_end_offsets[rmsk_field_end_idx++] = current_src_posn + 1;
-                c2b_globals.rmsk->line++;
-                c2b_globals.rmsk->is_start_of_line = kTrue;
-                c2b_globals.rmsk->is_start_of_gap = kFalse;
-                if (c2b_globals.rmsk->line <= c2b_rmsk_header_line_count) {
-                    if (c2b_globals.keep_header_flag) {
-                        char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                        char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-                        memcpy(src_header_line_str, src, src_size);
-                        src_header_line_str[src_size] = '\0';
-                        sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-                        memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-                        *dest_size += strlen(dest_header_line_str);
-                        c2b_globals.header_line_idx++;
+                ctx->rmsk.line++;
+                ctx->rmsk.is_start_of_line = kTrue;
+                ctx->rmsk.is_start_of_gap = kFalse;
+                if (ctx->rmsk.line <= c2b_rmsk_header_line_count) {
+                    if (ctx->options->keep_header_flag) {
+                        c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+                        ctx->header_line_idx++;
                     }
                     return;
                 }
@@ -1948,8 +1207,8 @@ c2b_line_convert_rmsk_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         current_src_posn++;
     }
 
-    c2b_globals.rmsk->is_start_of_line = kTrue;
-    c2b_globals.rmsk->is_start_of_gap = kFalse;
+    ctx->rmsk.is_start_of_line = kTrue;
+    ctx->rmsk.is_start_of_gap = kFalse;
 
 #ifdef DEBUG
     fprintf(stderr, "rmsk_field_start_idx: %d\n", (int) rmsk_field_start_idx);
@@ -1963,229 +1222,183 @@ c2b_line_convert_rmsk_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
     }
     
     /*  0 - Smith-Waterman score of the match */
-    char sw_score_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t sw_score_start = rmsk_field_start_offsets[0];
-    ssize_t sw_score_end = rmsk_field_end_offsets[0];
-    ssize_t sw_score_size = sw_score_end - sw_score_start;
-    memcpy(sw_score_str, src + sw_score_start, sw_score_size);
-    sw_score_str[sw_score_size] = '\0';
+    c2b_field_t sw_score;
+    sw_score.str = src + rmsk_field_start_offsets[0];
+    sw_score.size = rmsk_field_end_offsets[0] - rmsk_field_start_offsets[0];
 
 #ifdef DEBUG
-    fprintf(stderr, "sw_score_str [%s]\n", sw_score_str);
+    fprintf(stderr, "sw_score [%.*s]\n", (int) sw_score.size, sw_score.str);
 #endif
 
     /*  1 - Percent, divergence = mismatches / (matches + mismatches) */
-    char perc_div_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t perc_div_start = rmsk_field_start_offsets[1];
-    ssize_t perc_div_end = rmsk_field_end_offsets[1];
-    ssize_t perc_div_size = perc_div_end - perc_div_start;
-    memcpy(perc_div_str, src + perc_div_start, perc_div_size);
-    perc_div_str[perc_div_size] = '\0';
+    c2b_field_t perc_div;
+    perc_div.str = src + rmsk_field_start_offsets[1];
+    perc_div.size = rmsk_field_end_offsets[1] - rmsk_field_start_offsets[1];
 
 #ifdef DEBUG
-    fprintf(stderr, "perc_div_str [%s]\n", perc_div_str);
+    fprintf(stderr, "perc_div [%.*s]\n", (int) perc_div.size, perc_div.str);
 #endif
 
     /*  2 - Percent, bases opposite a gap in the query sequence = deleted bp */
-    char perc_deleted_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t perc_deleted_start = rmsk_field_start_offsets[2];
-    ssize_t perc_deleted_end = rmsk_field_end_offsets[2];
-    ssize_t perc_deleted_size = perc_deleted_end - perc_deleted_start;
-    memcpy(perc_deleted_str, src + perc_deleted_start, perc_deleted_size);
-    perc_deleted_str[perc_deleted_size] = '\0';
+    c2b_field_t perc_deleted;
+    perc_deleted.str = src + rmsk_field_start_offsets[2];
+    perc_deleted.size = rmsk_field_end_offsets[2] - rmsk_field_start_offsets[2];
 
 #ifdef DEBUG
-    fprintf(stderr, "perc_deleted_str [%s]\n", perc_deleted_str);
+    fprintf(stderr, "perc_deleted [%.*s]\n", (int) perc_deleted.size, perc_deleted.str);
 #endif
 
     /*  3 - Percent, bases opposite a gap in the repeat consensus = inserted bp */
-    char perc_inserted_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t perc_inserted_start = rmsk_field_start_offsets[3];
-    ssize_t perc_inserted_end = rmsk_field_end_offsets[3];
-    ssize_t perc_inserted_size = perc_inserted_end - perc_inserted_start;
-    memcpy(perc_inserted_str, src + perc_inserted_start, perc_inserted_size);
-    perc_inserted_str[perc_inserted_size] = '\0';
+    c2b_field_t perc_inserted;
+    perc_inserted.str = src + rmsk_field_start_offsets[3];
+    perc_inserted.size = rmsk_field_end_offsets[3] - rmsk_field_start_offsets[3];
 
 #ifdef DEBUG
-    fprintf(stderr, "perc_inserted_str [%s]\n", perc_inserted_str);
+    fprintf(stderr, "perc_inserted [%.*s]\n", (int) perc_inserted.size, perc_inserted.str);
 #endif
 
     /*  4 - Query sequence */
-    char query_seq_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t query_seq_start = rmsk_field_start_offsets[4];
-    ssize_t query_seq_end = rmsk_field_end_offsets[4];
-    ssize_t query_seq_size = query_seq_end - query_seq_start;
-    memcpy(query_seq_str, src + query_seq_start, query_seq_size);
-    query_seq_str[query_seq_size] = '\0';
+    c2b_field_t query_seq;
+    query_seq.str = src + rmsk_field_start_offsets[4];
+    query_seq.size = rmsk_field_end_offsets[4] - rmsk_field_start_offsets[4];
 
 #ifdef DEBUG
-    fprintf(stderr, "query_seq_str [%s]\n", query_seq_str);
+    fprintf(stderr, "query_seq [%.*s]\n", (int) query_seq.size, query_seq.str);
 #endif
 
     /*  5 - Query start (1-indexed) */
-    char query_start_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t query_start_start = rmsk_field_start_offsets[5];
-    ssize_t query_start_end = rmsk_field_end_offsets[5];
-    ssize_t query_start_size = query_start_end - query_start_start;
-    memcpy(query_start_str, src + query_start_start, query_start_size);
-    query_start_str[query_start_size] = '\0';
-    uint64_t query_start_val = strtoull(query_start_str, NULL, 10);
+    c2b_field_t query_start;
+    query_start.str = src + rmsk_field_start_offsets[5];
+    query_start.size = rmsk_field_end_offsets[5] - rmsk_field_start_offsets[5];
+    uint64_t query_start_val = c2b_field_to_uint64(query_start, "RepeatMasker query start");
 
 #ifdef DEBUG
-    fprintf(stderr, "query_start_str [%s]\n", query_start_str);
+    fprintf(stderr, "query_start [%.*s]\n", (int) query_start.size, query_start.str);
 #endif
 
     /*  6 - Query end */
-    char query_end_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t query_end_start = rmsk_field_start_offsets[6];
-    ssize_t query_end_end = rmsk_field_end_offsets[6];
-    ssize_t query_end_size = query_end_end - query_end_start;
-    memcpy(query_end_str, src + query_end_start, query_end_size);
-    query_end_str[query_end_size] = '\0';
-    uint64_t query_end_val = strtoull(query_end_str, NULL, 10);
+    c2b_field_t query_end;
+    query_end.str = src + rmsk_field_start_offsets[6];
+    query_end.size = rmsk_field_end_offsets[6] - rmsk_field_start_offsets[6];
+    uint64_t query_end_val = c2b_field_to_uint64(query_end, "RepeatMasker query end");
 
 #ifdef DEBUG
-    fprintf(stderr, "query_end_str [%s]\n", query_end_str);
+    fprintf(stderr, "query_end [%.*s]\n", (int) query_end.size, query_end.str);
 #endif
 
     /*  7 - Bases in query sequence past the ending position of match */
-    char bases_past_match_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t bases_past_match_start = rmsk_field_start_offsets[7];
-    ssize_t bases_past_match_end = rmsk_field_end_offsets[7];
-    ssize_t bases_past_match_size = bases_past_match_end - bases_past_match_start;
-    memcpy(bases_past_match_str, src + bases_past_match_start, bases_past_match_size);
-    bases_past_match_str[bases_past_match_size] = '\0';
+    c2b_field_t bases_past_match;
+    bases_past_match.str = src + rmsk_field_start_offsets[7];
+    bases_past_match.size = rmsk_field_end_offsets[7] - rmsk_field_start_offsets[7];
 
 #ifdef DEBUG
-    fprintf(stderr, "bases_past_match_str [%s]\n", bases_past_match_str);
+    fprintf(stderr, "bases_past_match [%.*s]\n", (int) bases_past_match.size, bases_past_match.str);
 #endif
 
     /*  8 - Strand match with repeat consensus sequence (+ = forward, C = complement) */
-    char strand_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t strand_start = rmsk_field_start_offsets[8];
-    ssize_t strand_end = rmsk_field_end_offsets[8];
-    ssize_t strand_size = strand_end - strand_start;
-    memcpy(strand_str, src + strand_start, strand_size);
-    strand_str[strand_size] = '\0';
-    if (strcmp(strand_str, c2b_rmsk_strand_complement) == 0) {
-        memcpy(strand_str, c2b_rmsk_strand_complement_replacement, strlen(c2b_rmsk_strand_complement_replacement) + 1);
+    c2b_field_t strand;
+    strand.str = src + rmsk_field_start_offsets[8];
+    strand.size = rmsk_field_end_offsets[8] - rmsk_field_start_offsets[8];
+    if (c2b_field_equals(strand, c2b_rmsk_strand_complement)) {
+        strand.str = c2b_rmsk_strand_complement_replacement;
+        strand.size = strlen(c2b_rmsk_strand_complement_replacement);
     }
 
 #ifdef DEBUG
-    fprintf(stderr, "strand_str [%s]\n", strand_str);
+    fprintf(stderr, "strand [%.*s]\n", (int) strand.size, strand.str);
 #endif
 
     /*  9 - Matching interspersed repeat name */
-    char repeat_name_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t repeat_name_start = rmsk_field_start_offsets[9];
-    ssize_t repeat_name_end = rmsk_field_end_offsets[9];
-    ssize_t repeat_name_size = repeat_name_end - repeat_name_start;
-    memcpy(repeat_name_str, src + repeat_name_start, repeat_name_size);
-    repeat_name_str[repeat_name_size] = '\0';
+    c2b_field_t repeat_name;
+    repeat_name.str = src + rmsk_field_start_offsets[9];
+    repeat_name.size = rmsk_field_end_offsets[9] - rmsk_field_start_offsets[9];
 
 #ifdef DEBUG
-    fprintf(stderr, "repeat_name_str [%s]\n", repeat_name_str);
+    fprintf(stderr, "repeat_name [%.*s]\n", (int) repeat_name.size, repeat_name.str);
 #endif
 
     /* 10 - Repeat class */
-    char repeat_class_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t repeat_class_start = rmsk_field_start_offsets[10];
-    ssize_t repeat_class_end = rmsk_field_end_offsets[10];
-    ssize_t repeat_class_size = repeat_class_end - repeat_class_start;
-    memcpy(repeat_class_str, src + repeat_class_start, repeat_class_size);
-    repeat_class_str[repeat_class_size] = '\0';
+    c2b_field_t repeat_class;
+    repeat_class.str = src + rmsk_field_start_offsets[10];
+    repeat_class.size = rmsk_field_end_offsets[10] - rmsk_field_start_offsets[10];
 
 #ifdef DEBUG
-    fprintf(stderr, "repeat_class_str [%s]\n", repeat_class_str);
+    fprintf(stderr, "repeat_class [%.*s]\n", (int) repeat_class.size, repeat_class.str);
 #endif
 
     /* 11 - Bases in (complement of) the repeat consensus sequence, prior to beginning of the match */
-    char bases_before_match_comp_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t bases_before_match_comp_start = rmsk_field_start_offsets[11];
-    ssize_t bases_before_match_comp_end = rmsk_field_end_offsets[11];
-    ssize_t bases_before_match_comp_size = bases_before_match_comp_end - bases_before_match_comp_start;
-    memcpy(bases_before_match_comp_str, src + bases_before_match_comp_start, bases_before_match_comp_size);
-    bases_before_match_comp_str[bases_before_match_comp_size] = '\0';
+    c2b_field_t bases_before_match_comp;
+    bases_before_match_comp.str = src + rmsk_field_start_offsets[11];
+    bases_before_match_comp.size = rmsk_field_end_offsets[11] - rmsk_field_start_offsets[11];
 
 #ifdef DEBUG
-    fprintf(stderr, "bases_before_match_comp_str [%s]\n", bases_before_match_comp_str);
+    fprintf(stderr, "bases_before_match_comp [%.*s]\n", (int) bases_before_match_comp.size, bases_before_match_comp.str);
 #endif
 
     /* 12 - Match start (in repeat consensus sequence) */
-    char match_start_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t match_start_start = rmsk_field_start_offsets[12];
-    ssize_t match_start_end = rmsk_field_end_offsets[12];
-    ssize_t match_start_size = match_start_end - match_start_start;
-    memcpy(match_start_str, src + match_start_start, match_start_size);
-    match_start_str[match_start_size] = '\0';
+    c2b_field_t match_start;
+    match_start.str = src + rmsk_field_start_offsets[12];
+    match_start.size = rmsk_field_end_offsets[12] - rmsk_field_start_offsets[12];
 
 #ifdef DEBUG
-    fprintf(stderr, "match_start_str [%s]\n", match_start_str);
+    fprintf(stderr, "match_start [%.*s]\n", (int) match_start.size, match_start.str);
 #endif
 
     /* 13 - Match end (in repeat consensus sequence) */
-    char match_end_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t match_end_start = rmsk_field_start_offsets[13];
-    ssize_t match_end_end = rmsk_field_end_offsets[13];
-    ssize_t match_end_size = match_end_end - match_end_start;
-    memcpy(match_end_str, src + match_end_start, match_end_size);
-    match_end_str[match_end_size] = '\0';
+    c2b_field_t match_end;
+    match_end.str = src + rmsk_field_start_offsets[13];
+    match_end.size = rmsk_field_end_offsets[13] - rmsk_field_start_offsets[13];
 
 #ifdef DEBUG
-    fprintf(stderr, "match_end_str [%s]\n", match_end_str);
+    fprintf(stderr, "match_end [%.*s]\n", (int) match_end.size, match_end.str);
 #endif
 
     /* 14 - Identifier for individual insertions */
-    char unique_id_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t unique_id_start = rmsk_field_start_offsets[14];
-    ssize_t unique_id_end = rmsk_field_end_offsets[14];
-    ssize_t unique_id_size = unique_id_end - unique_id_start;
-    memcpy(unique_id_str, src + unique_id_start, unique_id_size);
-    unique_id_str[unique_id_size] = '\0';
+    c2b_field_t unique_id;
+    unique_id.str = src + rmsk_field_start_offsets[14];
+    unique_id.size = rmsk_field_end_offsets[14] - rmsk_field_start_offsets[14];
 
 #ifdef DEBUG
-    fprintf(stderr, "unique_id_str [%s]\n", unique_id_str);
+    fprintf(stderr, "unique_id [%.*s]\n", (int) unique_id.size, unique_id.str);
 #endif
 
     /* 15 - Higher-scoring match present (optional) */
-    char higher_score_match_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    higher_score_match_str[0] = '\0';
+    c2b_field_t higher_score_match;
+    higher_score_match.str = src + src_size;
+    higher_score_match.size = 0;
 
     if ((rmsk_field_start_idx == c2b_rmsk_field_max) && (rmsk_field_end_idx == c2b_rmsk_field_max)) {
-        ssize_t higher_score_match_start = rmsk_field_start_offsets[15];
-        ssize_t higher_score_match_end = rmsk_field_end_offsets[15];
-        ssize_t higher_score_match_size = higher_score_match_end - higher_score_match_start;
-        memcpy(higher_score_match_str, src + higher_score_match_start, higher_score_match_size);
-        higher_score_match_str[higher_score_match_size] = '\0';
+        higher_score_match.str = src + rmsk_field_start_offsets[15];
+        higher_score_match.size = rmsk_field_end_offsets[15] - rmsk_field_start_offsets[15];
     }
 
 #ifdef DEBUG
-    fprintf(stderr, "higher_score_match_str [%s]\n", higher_score_match_str);
+    fprintf(stderr, "higher_score_match [%.*s]\n", (int) higher_score_match.size, higher_score_match.str);
 #endif
 
     c2b_rmsk_t rmsk;
-    rmsk.sw_score = sw_score_str;
-    rmsk.perc_div = perc_div_str;
-    rmsk.perc_deleted = perc_deleted_str;
-    rmsk.perc_inserted = perc_inserted_str;
-    rmsk.query_seq = query_seq_str;
+    rmsk.sw_score = sw_score;
+    rmsk.perc_div = perc_div;
+    rmsk.perc_deleted = perc_deleted;
+    rmsk.perc_inserted = perc_inserted;
+    rmsk.query_seq = query_seq;
     rmsk.query_start = query_start_val - 1;
     rmsk.query_end = query_end_val;
-    rmsk.bases_past_match = bases_past_match_str;
-    rmsk.strand = strand_str;
-    rmsk.repeat_name = repeat_name_str;
-    rmsk.repeat_class = repeat_class_str;
-    rmsk.bases_before_match_comp = bases_before_match_comp_str;
-    rmsk.match_start = match_start_str;
-    rmsk.match_end = match_end_str;
-    rmsk.unique_id = unique_id_str;
-    rmsk.higher_score_match = higher_score_match_str;
-
-    c2b_line_convert_rmsk_to_bed(rmsk, dest, dest_size);
+    rmsk.bases_past_match = bases_past_match;
+    rmsk.strand = strand;
+    rmsk.repeat_name = repeat_name;
+    rmsk.repeat_class = repeat_class;
+    rmsk.bases_before_match_comp = bases_before_match_comp;
+    rmsk.match_start = match_start;
+    rmsk.match_end = match_end;
+    rmsk.unique_id = unique_id;
+    rmsk.higher_score_match = higher_score_match;
+
+    c2b_line_convert_rmsk_to_bed(rmsk, dest);
 }
 
 static inline void
-c2b_line_convert_rmsk_to_bed(c2b_rmsk_t r, char *dest_line, ssize_t *dest_size)
+c2b_line_convert_rmsk_to_bed(c2b_rmsk_t r, c2b_batch_t *dest)
 {
     /* 
        For RepeatMasker annotation-formatted data, we use the mapping provided by BEDOPS
@@ -2218,306 +1431,185 @@ c2b_line_convert_rmsk_to_bed(c2b_rmsk_t r, char *dest_line, ssize_t *dest_size)
        higher_score_match        16                     -       
     */
 
-    if (strlen(r.higher_score_match) == 0) {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              r.query_seq,
-                              r.query_start,
-                              r.query_end,
-                              r.repeat_name,
-                              r.sw_score,
-                              r.strand,
-                              r.perc_div,
-                              r.perc_deleted,
-                              r.perc_inserted,
-                              r.bases_past_match,
-                              r.repeat_class,
-                              r.bases_before_match_comp,
-                              r.match_start,
-                              r.match_end,
-                              r.unique_id);
-    }
-    else {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              r.query_seq,
-                              r.query_start,
-                              r.query_end,
-                              r.repeat_name,
-                              r.sw_score,
-                              r.strand,
-                              r.perc_div,
-                              r.perc_deleted,
-                              r.perc_inserted,
-                              r.bases_past_match,
-                              r.repeat_class,
-                              r.bases_before_match_comp,
-                              r.match_start,
-                              r.match_end,
-                              r.unique_id,
-                              r.higher_score_match);
-    }
-}
-
-static void
-c2b_line_convert_sam_to_bed_unsorted_without_split_operation(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
+    c2b_batch_append_record(dest, &r, c2b_rmsk_columns, sizeof(c2b_rmsk_columns) / sizeof(c2b_rmsk_columns[0]));
+}
+
+static void
+c2b_block_convert_sam_to_bed_unsorted_without_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
+{
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_sam_to_bed_unsorted_without_split_operation);
+}
+
+static void
+c2b_line_convert_sam_to_bed_unsorted_without_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
 {
     /* 
-       Scan the src buffer (all src_size bytes of it) to build a list of tab delimiter 
-       offsets. Then write content to the dest buffer, using offsets taken from the reordered 
+       The block tokenizer has already built a list of tab delimiter offsets for this 
+       line. We write content to the dest buffer, using offsets taken from the reordered 
        tab-offset list to grab fields in the correct order.
     */
 
-    ssize_t sam_field_offsets[C2B_MAX_FIELD_COUNT_VALUE];
-    int sam_field_idx = 0;
-    ssize_t current_src_posn = -1;
+    char *src = line->src;
+    ssize_t src_size = line->size;
+    const ssize_t *sam_field_offsets = line->field_offsets;
+    int sam_field_idx = line->field_idx;
     
     /* 
-       Find offsets or process header line 
+       Process header line 
     */
 
     if (src[0] == c2b_sam_header_prefix) {
-        if (!c2b_globals.keep_header_flag) {
+        if (ctx->options->header_sort_order_flag) {
+            /* pass the raw line on, for the sorter to rank chromosomes by */
+            c2b_batch_append(dest, src, src_size);
+            c2b_batch_append(dest, "\n", 1);
+        }
+        if (!ctx->options->keep_header_flag) {
             /* skip header line */
             return;
         }
         else {
             /* copy header line to destination stream buffer */
-            char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-            char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-            memcpy(src_header_line_str, src, src_size);
-            src_header_line_str[src_size] = '\0';
-            sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-            memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-            *dest_size += strlen(dest_header_line_str);
-            c2b_globals.header_line_idx++;
+            c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+            ctx->header_line_idx++;
             return;
         }
     }
 
-    while (++current_src_posn < src_size) {
-        if ((src[current_src_posn] == c2b_tab_delim) || (src[current_src_posn] == c2b_line_delim)) {
-            sam_field_offsets[sam_field_idx++] = current_src_posn;
-        }
-        if (sam_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
-            fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", sam_field_idx);
-            c2b_print_usage(stderr);
-            exit(EINVAL); /* Invalid argument (POSIX.1) */
-        }
+    if (sam_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
+        fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", sam_field_idx);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
-    sam_field_offsets[sam_field_idx] = src_size;
-    sam_field_offsets[sam_field_idx + 1] = -1;
 
     /* 
-       If no more than one field is read in, then something went wrong
+       If fewer than the eleven mandatory fields are read in, then something
+       went wrong
     */
 
-    if (sam_field_idx == 0) {
+    if ((sam_field_idx + 1) < c2b_sam_field_min) {
         fprintf(stderr, "Error: Invalid field count (%d) -- input file may not match input format\n", sam_field_idx);
         c2b_print_usage(stderr);
         exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
 
     /* 
-       Firstly, is read mapped? If not, and c2b_globals.all_reads_flag is kFalse, we skip over this line
+       Firstly, is read mapped? If not, and ctx->options->all_reads_flag is kFalse, we skip over this line
     */
 
     ssize_t flag_size = sam_field_offsets[1] - sam_field_offsets[0];
-    char flag_src_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    memcpy(flag_src_str, src + sam_field_offsets[0] + 1, flag_size);
-    flag_src_str[flag_size] = '\0';
-    int flag_val = (int) strtol(flag_src_str, NULL, 10);
+    int flag_val = (int) c2b_field_to_uint64(c2b_line_field(line, 1), "SAM FLAG");
     boolean is_mapped = (boolean) !(4 & flag_val);
-    if ((!is_mapped) && (!c2b_globals.all_reads_flag)) 
+    if ((!is_mapped) && (!ctx->options->all_reads_flag)) 
         return;
 
     /* Field 1 - RNAME */
     if (is_mapped) {
         ssize_t rname_size = sam_field_offsets[2] - sam_field_offsets[1];
-        memcpy(dest + *dest_size, src + sam_field_offsets[1] + 1, rname_size);
-        *dest_size += rname_size;
+        c2b_batch_append(dest, src + sam_field_offsets[1] + 1, rname_size);
     }
     else {
-        char unmapped_read_chr_str[C2B_MAX_FIELD_LENGTH_VALUE];
-        memcpy(unmapped_read_chr_str, c2b_unmapped_read_chr_name, strlen(c2b_unmapped_read_chr_name));
-        unmapped_read_chr_str[strlen(c2b_unmapped_read_chr_name)] = '\t';
-        unmapped_read_chr_str[strlen(c2b_unmapped_read_chr_name) + 1] = '\0';
-        memcpy(dest + *dest_size, unmapped_read_chr_str, strlen(unmapped_read_chr_str));
-        *dest_size += strlen(unmapped_read_chr_str);
+        c2b_batch_append_str(dest, c2b_unmapped_read_chr_name, '\t');
     }
 
     /* Field 2 - POS - 1 */
-    ssize_t pos_size = sam_field_offsets[3] - sam_field_offsets[2];
-    char pos_src_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    memcpy(pos_src_str, src + sam_field_offsets[2] + 1, pos_size - 1);
-    pos_src_str[pos_size - 1] = '\0';
-    uint64_t pos_val = strtoull(pos_src_str, NULL, 10);
-    char start_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    sprintf(start_str, "%" PRIu64 "\t", (is_mapped) ? pos_val - 1 : 0);
-    memcpy(dest + *dest_size, start_str, strlen(start_str));
-    *dest_size += strlen(start_str);
+    uint64_t pos_val = c2b_field_to_uint64(c2b_line_field(line, 3), "SAM POS");
+    c2b_batch_append_uint64(dest, (is_mapped) ? pos_val - 1 : 0, '\t');
 
     /* Field 3 - POS + length(CIGAR) - 1 */
     ssize_t cigar_size = sam_field_offsets[5] - sam_field_offsets[4];
     ssize_t cigar_length = 0;
-    char stop_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    char cigar_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    memcpy(cigar_str, src + sam_field_offsets[4] + 1, cigar_size - 1);
-    cigar_str[cigar_size - 1] = '\0';
-    c2b_sam_cigar_str_to_ops(cigar_str);
+    c2b_cigar_t *cigar = ctx->cigar;
+    c2b_sam_cigar_str_to_ops(cigar, c2b_line_field(line, 5));
     ssize_t block_idx = 0;
-    for (block_idx = 0; block_idx < c2b_globals.sam->cigar->length; ++block_idx) {
-        cigar_length += c2b_globals.sam->cigar->ops[block_idx].bases;
+    for (block_idx = 0; block_idx < cigar->length; ++block_idx) {
+        cigar_length += cigar->ops[block_idx].bases;
     }
-    sprintf(stop_str, "%" PRIu64 "\t", (is_mapped) ? pos_val + cigar_length - 1 : 1);
-    memcpy(dest + *dest_size, stop_str, strlen(stop_str));
-    *dest_size += strlen(stop_str);
+    c2b_batch_append_uint64(dest, (is_mapped) ? pos_val + cigar_length - 1 : 1, '\t');
 
     /* Field 4 - QNAME */
     ssize_t qname_size = sam_field_offsets[0] + 1;
-    memcpy(dest + *dest_size, src, qname_size);
-    *dest_size += qname_size;
+    c2b_batch_append(dest, src, qname_size);
 
     /* Field 5 - MAPQ */
     ssize_t mapq_size = sam_field_offsets[4] - sam_field_offsets[3];
-    memcpy(dest + *dest_size, src + sam_field_offsets[3] + 1, mapq_size);
-    *dest_size += mapq_size;
+    c2b_batch_append(dest, src + sam_field_offsets[3] + 1, mapq_size);
 
     /* Field 6 - 16 & FLAG */
     int strand_val = 0x10 & flag_val;
-    char strand_str[C2B_MAX_STRAND_LENGTH_VALUE];
-    sprintf(strand_str, "%c\t", (strand_val == 0x10) ? '-' : '+');
-    memcpy(dest + *dest_size, strand_str, strlen(strand_str));
-    *dest_size += strlen(strand_str);
+    c2b_batch_append(dest, (strand_val == 0x10) ? "-\t" : "+\t", 2);
 
     /* Field 7 - FLAG */
-    memcpy(dest + *dest_size, src + sam_field_offsets[0] + 1, flag_size);
-    *dest_size += flag_size;
+    c2b_batch_append(dest, src + sam_field_offsets[0] + 1, flag_size);
 
     /* Field 8 - CIGAR */
-    memcpy(dest + *dest_size, src + sam_field_offsets[4] + 1, cigar_size);
-    *dest_size += cigar_size;
-
-    /* Field 9 - RNEXT */
-    ssize_t rnext_size = sam_field_offsets[6] - sam_field_offsets[5];
-    memcpy(dest + *dest_size, src + sam_field_offsets[5] + 1, rnext_size);
-    *dest_size += rnext_size;
-
-    /* Field 10 - PNEXT */
-    ssize_t pnext_size = sam_field_offsets[7] - sam_field_offsets[6];
-    memcpy(dest + *dest_size, src + sam_field_offsets[6] + 1, pnext_size);
-    *dest_size += pnext_size;
-
-    /* Field 11 - TLEN */
-    ssize_t tlen_size = sam_field_offsets[8] - sam_field_offsets[7];
-    memcpy(dest + *dest_size, src + sam_field_offsets[7] + 1, tlen_size);
-    *dest_size += tlen_size;
-
-    /* Field 12 - SEQ */
-    ssize_t seq_size = sam_field_offsets[9] - sam_field_offsets[8];
-    memcpy(dest + *dest_size, src + sam_field_offsets[8] + 1, seq_size);
-    *dest_size += seq_size;
-
-    /* Field 13 - QUAL */
-    ssize_t qual_size = sam_field_offsets[10] - sam_field_offsets[9];
-    memcpy(dest + *dest_size, src + sam_field_offsets[9] + 1, qual_size);
-    *dest_size += qual_size;
-
-    /* Field 14+ - Optional fields */
-    if (sam_field_offsets[11] == -1)
-        return;
+    c2b_batch_append(dest, src + sam_field_offsets[4] + 1, cigar_size);
 
-    int field_idx;
-    for (field_idx = 11; field_idx <= sam_field_idx; field_idx++) {
-        ssize_t opt_size = sam_field_offsets[field_idx] - sam_field_offsets[field_idx - 1];
-        memcpy(dest + *dest_size, src + sam_field_offsets[field_idx - 1] + 1, opt_size);
-        *dest_size += opt_size;
-    }
+    /* 
+       Fields 9 to 13 - RNEXT, PNEXT, TLEN, SEQ and QUAL - and any optional
+       fields are copied as-is, and they are adjacent in the source line, so
+       they are appended as one run that the batch can reference in place
+    */
+
+    int last_field_idx = (sam_field_offsets[11] == -1) ? 10 : sam_field_idx;
+    ssize_t tail_size = sam_field_offsets[last_field_idx] - sam_field_offsets[5];
+    c2b_batch_append_view(dest, src + sam_field_offsets[5] + 1, tail_size);
+}
+
+static void
+c2b_block_convert_sam_to_bed_unsorted_with_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
+{
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_sam_to_bed_unsorted_with_split_operation);
 }
 
 static void
-c2b_line_convert_sam_to_bed_unsorted_with_split_operation(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
+c2b_line_convert_sam_to_bed_unsorted_with_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
 {
     /* 
        This functor is slightly more complex than c2b_line_convert_sam_to_bed_unsorted_without_split_operation() 
-       as we need to build a list of tab delimiters, as before, but first read in the CIGAR string (6th field) and
+       as, in addition to using the list of tab delimiters, we first read in the CIGAR string (6th field) and
        parse it for operation key-value pairs to loop through later on
     */
 
-    ssize_t sam_field_offsets[C2B_MAX_FIELD_COUNT_VALUE];
-    int sam_field_idx = 0;
-    ssize_t current_src_posn = -1;
+    char *src = line->src;
+    ssize_t src_size = line->size;
+    const ssize_t *sam_field_offsets = line->field_offsets;
+    int sam_field_idx = line->field_idx;
 
     /* 
-       Find offsets or process header line 
+       Process header line 
     */
 
     if (src[0] == c2b_sam_header_prefix) {
-        if (!c2b_globals.keep_header_flag) {
+        if (ctx->options->header_sort_order_flag) {
+            /* pass the raw line on, for the sorter to rank chromosomes by */
+            c2b_batch_append(dest, src, src_size);
+            c2b_batch_append(dest, "\n", 1);
+        }
+        if (!ctx->options->keep_header_flag) {
             /* skip header line */
             return;
         }
         else {
             /* copy header line to destination stream buffer */
-            char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-            char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-            memcpy(src_header_line_str, src, src_size);
-            src_header_line_str[src_size] = '\0';
-            sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-            memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-            *dest_size += strlen(dest_header_line_str);
-            c2b_globals.header_line_idx++;
+            c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+            ctx->header_line_idx++;
             return;
         }
     }
 
-    while (++current_src_posn < src_size) {
-        if ((src[current_src_posn] == c2b_tab_delim) || (src[current_src_posn] == c2b_line_delim)) {
-            sam_field_offsets[sam_field_idx++] = current_src_posn;
-        }
-        if (sam_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
-            fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", sam_field_idx);
-            c2b_print_usage(stderr);
-            exit(EINVAL); /* Invalid argument (POSIX.1) */
-        }
+    if (sam_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
+        fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", sam_field_idx);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
-    sam_field_offsets[sam_field_idx] = src_size;
-    sam_field_offsets[sam_field_idx + 1] = -1;
 
     /* 
-       If no more than one field is read in, then something went wrong
+       If fewer than the eleven mandatory fields are read in, then something
+       went wrong
     */
 
-    if (sam_field_idx == 0) {
+    if ((sam_field_idx + 1) < c2b_sam_field_min) {
         fprintf(stderr, "Error: Invalid field count (%d) -- input file may not match input format\n", sam_field_idx);
         c2b_print_usage(stderr);
         exit(EINVAL); /* Invalid argument (POSIX.1) */
@@ -2527,31 +1619,26 @@ c2b_line_convert_sam_to_bed_unsorted_with_split_operation(char *dest, ssize_t *d
        Translate CIGAR string to operations
     */
 
-    ssize_t cigar_size = sam_field_offsets[5] - sam_field_offsets[4];
-    char cigar_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    memcpy(cigar_str, src + sam_field_offsets[4] + 1, cigar_size - 1);
-    cigar_str[cigar_size - 1] = '\0';
-    c2b_sam_cigar_str_to_ops(cigar_str);
+    c2b_sam_t sam;
+    sam.cigar = c2b_line_field(line, 5);
+    c2b_cigar_t *cigar = ctx->cigar;
+    c2b_sam_cigar_str_to_ops(cigar, sam.cigar);
 #ifdef DEBUG
-    c2b_sam_debug_cigar_ops(c2b_globals.sam->cigar);
+    c2b_sam_debug_cigar_ops(cigar);
 #endif
     ssize_t cigar_length = 0;
     ssize_t op_idx = 0;
-    for (op_idx = 0; op_idx < c2b_globals.sam->cigar->length; ++op_idx) {
-        cigar_length += c2b_globals.sam->cigar->ops[op_idx].bases;
+    for (op_idx = 0; op_idx < cigar->length; ++op_idx) {
+        cigar_length += cigar->ops[op_idx].bases;
     }
 
     /* 
-       Firstly, is the read mapped? If not, and c2b_globals.all_reads_flag is kFalse, we skip over this line
+       Firstly, is the read mapped? If not, and ctx->options->all_reads_flag is kFalse, we skip over this line
     */
 
-    ssize_t flag_size = sam_field_offsets[1] - sam_field_offsets[0];
-    char flag_src_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    memcpy(flag_src_str, src + sam_field_offsets[0] + 1, flag_size);
-    flag_src_str[flag_size] = '\0';
-    int flag_val = (int) strtol(flag_src_str, NULL, 10);
-    boolean is_mapped = (boolean) !(4 & flag_val);
-    if ((!is_mapped) && (!c2b_globals.all_reads_flag)) 
+    sam.flag = (int) c2b_field_to_uint64(c2b_line_field(line, 1), "SAM FLAG");
+    boolean is_mapped = (boolean) !(4 & sam.flag);
+    if ((!is_mapped) && (!ctx->options->all_reads_flag)) 
         return;    
 
     /* 
@@ -2559,86 +1646,57 @@ c2b_line_convert_sam_to_bed_unsorted_with_split_operation(char *dest, ssize_t *d
     */
 
     /* RNAME */
-    char rname_str[C2B_MAX_FIELD_LENGTH_VALUE];
     if (is_mapped) {
-        ssize_t rname_size = sam_field_offsets[2] - sam_field_offsets[1] - 1;
-        memcpy(rname_str, src + sam_field_offsets[1] + 1, rname_size);
-        rname_str[rname_size] = '\0';
+        sam.rname = c2b_line_field(line, 2);
     }
     else {
-        char unmapped_read_chr_str[C2B_MAX_FIELD_LENGTH_VALUE];
-        memcpy(unmapped_read_chr_str, c2b_unmapped_read_chr_name, strlen(c2b_unmapped_read_chr_name));
-        unmapped_read_chr_str[strlen(c2b_unmapped_read_chr_name)] = '\t';
-        unmapped_read_chr_str[strlen(c2b_unmapped_read_chr_name) + 1] = '\0';
-        memcpy(rname_str, unmapped_read_chr_str, strlen(unmapped_read_chr_str));
-        rname_str[strlen(unmapped_read_chr_str)] = '\0';
+        char *rname_str = c2b_alloc_field(ctx, strlen(c2b_unmapped_read_chr_name) + 1);
+        memcpy(rname_str, c2b_unmapped_read_chr_name, strlen(c2b_unmapped_read_chr_name));
+        rname_str[strlen(c2b_unmapped_read_chr_name)] = '\t';
+        rname_str[strlen(c2b_unmapped_read_chr_name) + 1] = '\0';
+        sam.rname.str = rname_str;
+        sam.rname.size = strlen(c2b_unmapped_read_chr_name) + 1;
     }
 
     /* POS */
-    ssize_t pos_size = sam_field_offsets[3] - sam_field_offsets[2];
-    char pos_src_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    memcpy(pos_src_str, src + sam_field_offsets[2] + 1, pos_size - 1);
-    pos_src_str[pos_size - 1] = '\0';
-    uint64_t pos_val = strtoull(pos_src_str, NULL, 10);
+    uint64_t pos_val = c2b_field_to_uint64(c2b_line_field(line, 3), "SAM POS");
     uint64_t start_val = pos_val - 1; /* remember, start = POS - 1 */
     uint64_t stop_val = start_val + cigar_length;
+    sam.start = start_val;
+    sam.stop = start_val;
 
     /* QNAME */
-    char qname_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qname_size = sam_field_offsets[0];
-    memcpy(qname_str, src, qname_size);
-    qname_str[qname_size] = '\0';
+    sam.qname = c2b_line_field(line, 0);
+    sam.block = 0;
 
     /* 16 & FLAG */
-    int strand_val = 0x10 & flag_val;
-    char strand_str[C2B_MAX_STRAND_LENGTH_VALUE];
-    sprintf(strand_str, "%c", (strand_val == 0x10) ? '-' : '+');
+    int strand_val = 0x10 & sam.flag;
+    sam.strand.str = (strand_val == 0x10) ? "-" : "+";
+    sam.strand.size = 1;
     
     /* MAPQ */
-    char mapq_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t mapq_size = sam_field_offsets[4] - sam_field_offsets[3] - 1;
-    memcpy(mapq_str, src + sam_field_offsets[3] + 1, mapq_size);
-    mapq_str[mapq_size] = '\0';
+    sam.mapq = c2b_line_field(line, 4);
     
     /* RNEXT */
-    char rnext_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t rnext_size = sam_field_offsets[6] - sam_field_offsets[5] - 1;
-    memcpy(rnext_str, src + sam_field_offsets[5] + 1, rnext_size);
-    rnext_str[rnext_size] = '\0';
+    sam.rnext = c2b_line_field(line, 6);
 
     /* PNEXT */
-    char pnext_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t pnext_size = sam_field_offsets[7] - sam_field_offsets[6] - 1;
-    memcpy(pnext_str, src + sam_field_offsets[6] + 1, pnext_size);
-    pnext_str[pnext_size] = '\0';
+    sam.pnext = c2b_line_field(line, 7);
 
     /* TLEN */
-    char tlen_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t tlen_size = sam_field_offsets[8] - sam_field_offsets[7] - 1;
-    memcpy(tlen_str, src + sam_field_offsets[7] + 1, tlen_size);
-    tlen_str[tlen_size] = '\0';
+    sam.tlen = c2b_line_field(line, 8);
 
     /* SEQ */
-    char seq_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t seq_size = sam_field_offsets[9] - sam_field_offsets[8] - 1;
-    memcpy(seq_str, src + sam_field_offsets[8] + 1, seq_size);
-    seq_str[seq_size] = '\0';
+    sam.seq = c2b_line_field(line, 9);
 
     /* QUAL */
-    char qual_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qual_size = sam_field_offsets[10] - sam_field_offsets[9] - 1;
-    memcpy(qual_str, src + sam_field_offsets[9] + 1, qual_size);
-    qual_str[qual_size] = '\0';
-
-    /* Optional fields */
-    char opt_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    memset(opt_str, 0, strlen(opt_str));
+    sam.qual = c2b_line_field(line, 10);
+
+    /* Optional fields, which are written out together as they are found */
+    sam.opt.str = line->src + sam_field_offsets[10] + 1;
+    sam.opt.size = 0;
     if (sam_field_offsets[11] != -1) {
-        for (int field_idx = 11; field_idx <= sam_field_idx; field_idx++) {
-            ssize_t opt_size = sam_field_offsets[field_idx] - sam_field_offsets[field_idx - 1] - (field_idx == sam_field_idx ? 1 : 0);
-            memcpy(opt_str + strlen(opt_str), src + sam_field_offsets[field_idx - 1] + 1, opt_size);
-	    opt_str[strlen(opt_str) + opt_size] = '\0';
-        }
+        sam.opt.size = sam_field_offsets[sam_field_idx] - sam_field_offsets[10] - 1;
     }
 
     /* 
@@ -2647,35 +1705,17 @@ c2b_line_convert_sam_to_bed_unsorted_with_split_operation(char *dest, ssize_t *d
 
     ssize_t block_idx;
     char previous_op = default_cigar_op_operation;
-    char modified_qname_str[C2B_MAX_FIELD_LENGTH_VALUE];
 
-    c2b_sam_t sam;
-    sam.rname = rname_str;
-    sam.start = start_val;
-    sam.stop = start_val;
-    sam.qname = qname_str;
-    sam.flag = flag_val;
-    sam.strand = strand_str;
-    sam.mapq = mapq_str;
-    sam.cigar = cigar_str;
-    sam.rnext = rnext_str;
-    sam.pnext = pnext_str;
-    sam.tlen = tlen_str;
-    sam.seq = seq_str;
-    sam.qual = qual_str;
-    sam.opt = opt_str;
-
-    for (op_idx = 0, block_idx = 1; op_idx < c2b_globals.sam->cigar->length; ++op_idx) {
-        char current_op = c2b_globals.sam->cigar->ops[op_idx].operation;
-        unsigned int bases = c2b_globals.sam->cigar->ops[op_idx].bases;
+    for (op_idx = 0, block_idx = 1; op_idx < cigar->length; ++op_idx) {
+        char current_op = cigar->ops[op_idx].operation;
+        unsigned int bases = cigar->ops[op_idx].bases;
         switch (current_op) 
             {
             case 'M':
                 sam.stop += bases;
                 if ((previous_op == default_cigar_op_operation) || (previous_op == 'D') || (previous_op == 'N')) {
-                    sprintf(modified_qname_str, "%s/%zu", qname_str, block_idx++);
-                    sam.qname = modified_qname_str;
-                    c2b_line_convert_sam_to_bed(sam, dest, dest_size);
+                    sam.block = block_idx++;
+                    c2b_line_convert_sam_to_bed(sam, dest);
                     sam.start = stop_val;
                 }
                 break;
@@ -2701,51 +1741,48 @@ c2b_line_convert_sam_to_bed_unsorted_with_split_operation(char *dest, ssize_t *d
     */
 
     if (block_idx == 1) {
-        c2b_line_convert_sam_to_bed(sam, dest, dest_size);
+        c2b_line_convert_sam_to_bed(sam, dest);
     }
 }
 
 static inline void
-c2b_sam_cigar_str_to_ops(char *s)
-{
-    size_t s_idx;
-    size_t s_len = strlen(s);
-    size_t bases_idx = 0;
-    boolean bases_flag = kTrue;
-    boolean operation_flag = kFalse;
-    char curr_bases_field[C2B_MAX_OPERATION_FIELD_LENGTH_VALUE];
-    char curr_char = default_cigar_op_operation;
-    unsigned int curr_bases = 0;
+c2b_sam_cigar_str_to_ops(c2b_cigar_t *cigar, c2b_field_t s)
+{
+    const char *curr = s.str;
+    const char *end = s.str + s.size;
+    c2b_field_t bases_field;
+    uint64_t bases_val = 0;
     ssize_t op_idx = 0;
 
-    for (s_idx = 0; s_idx < s_len; ++s_idx) {
-        curr_char = s[s_idx];
-        if (isdigit(curr_char)) {
-            if (operation_flag) {
-                c2b_globals.sam->cigar->ops[op_idx].bases = curr_bases;
-                op_idx++;
-                operation_flag = kFalse;
-                bases_flag = kTrue;
-            }
-            curr_bases_field[bases_idx++] = curr_char;
-            curr_bases_field[bases_idx] = '\0';
+    /* 
+       An empty or unavailable ('*') CIGAR string yields a single placeholder operation
+    */
+
+    if ((s.size == 0) || ((s.size == 1) && (s.str[0] == '*'))) {
+        cigar->ops[0].bases = 0;
+        cigar->ops[0].operation = '*';
+        cigar->length = 1;
+        return;
+    }
+
+    while (curr < end) {
+        bases_field.str = curr;
+        while ((curr < end) && (*curr >= '0') && (*curr <= '9'))
+            curr++;
+        bases_field.size = curr - bases_field.str;
+        if ((curr == end) || (!c2b_parse_uint64(bases_field, &bases_val)) || (bases_val > UINT_MAX)) {
+            fprintf(stderr, "Error: Invalid SAM CIGAR string [%.*s] -- input file may not match input format\n", (int) s.size, s.str);
+            c2b_print_usage(stderr);
+            exit(EINVAL); /* Invalid argument (POSIX.1) */
         }
-        else {
-            if (bases_flag) {
-                curr_bases = atoi(curr_bases_field);
-                bases_flag = kFalse;
-                operation_flag = kTrue;
-                bases_idx = 0;
-                memset(curr_bases_field, 0, strlen(curr_bases_field));
-            }
-            c2b_globals.sam->cigar->ops[op_idx].operation = curr_char;
-            if (curr_char == '*') {
-                break;
-            }
+        if (op_idx == cigar->size) {
+            c2b_sam_grow_cigar_ops(cigar);
         }
+        cigar->ops[op_idx].bases = (unsigned int) bases_val;
+        cigar->ops[op_idx].operation = *curr++;
+        op_idx++;
     }
-    c2b_globals.sam->cigar->ops[op_idx].bases = curr_bases;
-    c2b_globals.sam->cigar->length = op_idx + 1;
+    cigar->length = op_idx;
 }
 
 static void
@@ -2791,6 +1828,23 @@ c2b_sam_debug_cigar_ops(c2b_cigar_t *c)
     }
 }
 
+static void
+c2b_sam_grow_cigar_ops(c2b_cigar_t *c)
+{
+    c2b_cigar_op_t *ops = realloc(c->ops, 2 * c->size * sizeof(c2b_cigar_op_t));
+    if (!ops) {
+        fprintf(stderr, "Error: Could not grow CIGAR struct operation pointer\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    for (ssize_t idx = c->size; idx < 2 * c->size; idx++) {
+        ops[idx].bases = default_cigar_op_bases;
+        ops[idx].operation = default_cigar_op_operation;
+    }
+    c->ops = ops;
+    c->size *= 2;
+}
+
 static void
 c2b_sam_delete_cigar_ops(c2b_cigar_t *c)
 {
@@ -2801,7 +1855,7 @@ c2b_sam_delete_cigar_ops(c2b_cigar_t *c)
 }
 
 static inline void
-c2b_line_convert_sam_to_bed(c2b_sam_t s, char *dest_line, ssize_t *dest_size)
+c2b_line_convert_sam_to_bed(c2b_sam_t s, c2b_batch_t *dest)
 {
     /*
        For SAM-formatted data, we use the mapping provided by BEDOPS convention described at: 
@@ -2838,106 +1892,45 @@ c2b_line_convert_sam_to_bed(c2b_sam_t s, char *dest_line, ssize_t *dest_size)
        Alignment fields          14+                    -
     */
 
-    if (strlen(s.opt)) {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%d\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              s.rname,
-                              s.start,
-                              s.stop,
-                              s.qname,
-                              s.mapq,
-                              s.strand,
-                              s.flag,
-                              s.cigar,
-                              s.rnext,
-                              s.pnext,
-                              s.tlen,
-                              s.seq,
-                              s.qual,
-                              s.opt);
-    } 
-    else {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%d\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              s.rname,
-                              s.start,
-                              s.stop,
-                              s.qname,
-                              s.mapq,
-                              s.strand,
-                              s.flag,
-                              s.cigar,
-                              s.rnext,
-                              s.pnext,
-                              s.tlen,
-                              s.seq,
-                              s.qual);
-    }
-}
-
-static void
-c2b_line_convert_vcf_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
-{
-    ssize_t vcf_field_offsets[C2B_MAX_FIELD_COUNT_VALUE];
-    int vcf_field_idx = 0;
-    ssize_t current_src_posn = -1;
-
-    while (++current_src_posn < src_size) {
-        if ((src[current_src_posn] == c2b_tab_delim) || (src[current_src_posn] == c2b_line_delim)) {
-            vcf_field_offsets[vcf_field_idx++] = current_src_posn;
-        }
-        if (vcf_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
-            fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", vcf_field_idx);
-            c2b_print_usage(stderr);
-            exit(EINVAL); /* Invalid argument (POSIX.1) */
-        }
+    c2b_batch_append_record(dest, &s, c2b_sam_columns, sizeof(c2b_sam_columns) / sizeof(c2b_sam_columns[0]));
+}
+
+static void
+c2b_block_convert_vcf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
+{
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_vcf_to_bed_unsorted);
+}
+
+static void
+c2b_line_convert_vcf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
+{
+    char *src = line->src;
+    ssize_t src_size = line->size;
+    const ssize_t *vcf_field_offsets = line->field_offsets;
+    int vcf_field_idx = line->field_idx;
+
+    if (vcf_field_idx >= C2B_MAX_FIELD_COUNT_VALUE) {
+        fprintf(stderr, "Error: Invalid field count (%d) -- input file may have too many fields\n", vcf_field_idx);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
-    vcf_field_offsets[vcf_field_idx] = src_size;
-    vcf_field_offsets[vcf_field_idx + 1] = -1;
 
     /* 
        If number of fields in not in bounds, we may need to exit early
     */
     
-    char src_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-    char dest_header_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-
     if ((vcf_field_idx + 1) < c2b_vcf_field_min) {
         /* Legal header cases: line starts with "##" or "#" */
         if ((vcf_field_idx == 0) && (src[0] == c2b_vcf_header_prefix)) { 
-            if (c2b_globals.keep_header_flag) { 
+            if (ctx->options->header_sort_order_flag) {
+                /* pass the raw line on, for the sorter to rank chromosomes by */
+                c2b_batch_append(dest, src, src_size);
+                c2b_batch_append(dest, "\n", 1);
+            }
+            if (ctx->options->keep_header_flag) { 
                 /* copy header line to destination stream buffer */
-                memcpy(src_header_line_str, src, src_size);
-                src_header_line_str[src_size] = '\0';
-                sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-                memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-                *dest_size += strlen(dest_header_line_str);
-                c2b_globals.header_line_idx++;
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+                ctx->header_line_idx++;
                 return;
             }
             else {
@@ -2951,171 +1944,126 @@ c2b_line_convert_vcf_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         }
     }
 
+    c2b_vcf_t vcf;
+
     /* 0 - CHROM */
-    char chrom_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t chrom_size = vcf_field_offsets[0];
-    memcpy(chrom_str, src, chrom_size);
-    chrom_str[chrom_size] = '\0';
-
-    if ((chrom_str[0] == c2b_vcf_header_prefix) && (c2b_globals.keep_header_flag)) {
-        memcpy(src_header_line_str, src, src_size);
-        src_header_line_str[src_size] = '\0';
-        sprintf(dest_header_line_str, "%s\t%u\t%u\t%s\n", c2b_header_chr_name, c2b_globals.header_line_idx, (c2b_globals.header_line_idx + 1), src_header_line_str);
-        memcpy(dest + *dest_size, dest_header_line_str, strlen(dest_header_line_str));
-        *dest_size += strlen(dest_header_line_str);
-        c2b_globals.header_line_idx++;
+    vcf.chrom = c2b_line_field(line, 0);
+
+    if ((vcf.chrom.str[0] == c2b_vcf_header_prefix) && (ctx->options->keep_header_flag)) {
+        c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
+        ctx->header_line_idx++;
         return;
     }
-    else if (chrom_str[0] == c2b_vcf_header_prefix) {
+    else if (vcf.chrom.str[0] == c2b_vcf_header_prefix) {
         return;
     }
 
     /* 1 - POS */
-    char pos_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t pos_size = vcf_field_offsets[1] - vcf_field_offsets[0] - 1;
-    memcpy(pos_str, src + vcf_field_offsets[0] + 1, pos_size);
-    pos_str[pos_size] = '\0';
-    uint64_t pos_val = strtoull(pos_str, NULL, 10);
-    uint64_t start_val = pos_val - 1;
-    uint64_t end_val = pos_val; /* note that this value may change below, depending on options */
+    vcf.pos = c2b_field_to_uint64(c2b_line_field(line, 1), "VCF POS");
+    vcf.start = vcf.pos - 1;
+    vcf.end = vcf.pos; /* note that this value may change below, depending on options */
 
     /* 2 - ID */
-    char id_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t id_size = vcf_field_offsets[2] - vcf_field_offsets[1] - 1;
-    memcpy(id_str, src + vcf_field_offsets[1] + 1, id_size);
-    id_str[id_size] = '\0';
+    vcf.id = c2b_line_field(line, 2);
 
     /* 3 - REF */
-    char ref_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t ref_size = vcf_field_offsets[3] - vcf_field_offsets[2] - 1;
-    memcpy(ref_str, src + vcf_field_offsets[2] + 1, ref_size);
-    ref_str[ref_size] = '\0';
+    vcf.ref = c2b_line_field(line, 3);
 
     /* 4 - ALT */
-    char alt_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t alt_size = vcf_field_offsets[4] - vcf_field_offsets[3] - 1;
-    memcpy(alt_str, src + vcf_field_offsets[3] + 1, alt_size);
-    alt_str[alt_size] = '\0';
+    c2b_field_t alt = c2b_line_field(line, 4);
 
     /* 5 - QUAL */
-    char qual_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t qual_size = vcf_field_offsets[5] - vcf_field_offsets[4] - 1;
-    memcpy(qual_str, src + vcf_field_offsets[4] + 1, qual_size);
-    qual_str[qual_size] = '\0';
+    vcf.qual = c2b_line_field(line, 5);
 
     /* 6 - FILTER */
-    char filter_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t filter_size = vcf_field_offsets[6] - vcf_field_offsets[5] - 1;
-    memcpy(filter_str, src + vcf_field_offsets[5] + 1, filter_size);
-    filter_str[filter_size] = '\0';
+    vcf.filter = c2b_line_field(line, 6);
 
     /* 7 - INFO */
-    char info_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    ssize_t info_size = vcf_field_offsets[7] - vcf_field_offsets[6] - 1;
-    memcpy(info_str, src + vcf_field_offsets[6] + 1, info_size);
-    info_str[info_size] = '\0';
-
-    char format_str[C2B_MAX_FIELD_LENGTH_VALUE];
-    char samples_str[C2B_MAX_FIELD_LENGTH_VALUE];
-
-    format_str[0] = '\0'; /* initialize to zero-length string */
+    vcf.info = c2b_line_field(line, 7);
 
+    /* FORMAT and samples are optional and are otherwise zero-length */
     if (vcf_field_idx >= 8) {
         /* 8 - FORMAT */
-        ssize_t format_size = vcf_field_offsets[8] - vcf_field_offsets[7] - 1;
-        memcpy(format_str, src + vcf_field_offsets[7] + 1, format_size);
-        format_str[format_size] = '\0';
+        vcf.format = c2b_line_field(line, 8);
 
-        /* 9 - Samples */
-        ssize_t samples_size = vcf_field_offsets[vcf_field_idx] - vcf_field_offsets[8] - 1;
-        memcpy(samples_str, src + vcf_field_offsets[8] + 1, samples_size);
-        samples_str[samples_size] = '\0';
+        /* 9 - Samples, which are written out together as they are found */
+        vcf.samples.str = src + vcf_field_offsets[8] + 1;
+        vcf.samples.size = vcf_field_offsets[vcf_field_idx] - vcf_field_offsets[8] - 1;
+    }
+    else {
+        vcf.format.str = src + src_size;
+        vcf.format.size = 0;
+        vcf.samples = vcf.format;
     }
 
-    c2b_vcf_t vcf;
-    vcf.chrom = chrom_str;
-    vcf.pos = pos_val;
-    vcf.start = start_val;
-    vcf.end = end_val;
-    vcf.id = id_str;
-    vcf.ref = ref_str;
-    vcf.alt = alt_str;
-    vcf.qual = qual_str;
-    vcf.filter = filter_str;
-    vcf.info = info_str;
-    vcf.format = format_str;
-    vcf.samples = samples_str;
-
-    if ((!c2b_globals.vcf->do_not_split) && (memchr(alt_str, c2b_vcf_alt_allele_delim, strlen(alt_str)))) {
+    if ((!ctx->options->vcf->do_not_split) && (memchr(alt.str, c2b_vcf_alt_allele_delim, alt.size))) {
 
         /* loop through each allele */
 
-        char *alt_alleles_copy = NULL;
-        alt_alleles_copy = malloc(strlen(alt_str) + 1);
-        if (!alt_alleles_copy) {
-            fprintf(stderr, "Error: Could not allocate space for VCF alt alleles copy\n");
-            exit(ENOMEM); /* Not enough space (POSIX.1) */
-        }
-        memcpy(alt_alleles_copy, alt_str, strlen(alt_str) + 1);
-        const char *allele_tok;
-        while ((allele_tok = c2b_strsep(&alt_alleles_copy, ",")) != NULL) {
-            vcf.alt = (char *) allele_tok; /* discard const */
-            if ((c2b_globals.vcf->filter_count == 1) && (!c2b_globals.vcf->only_insertions)) {
-                vcf.end = start_val + abs(ref_size - strlen(vcf.alt)) + 1;
+        const char *alt_end = alt.str + alt.size;
+        const char *allele_str = alt.str;
+        const char *allele_end = NULL;
+        while (allele_str) {
+            allele_end = memchr(allele_str, c2b_vcf_alt_allele_delim, alt_end - allele_str);
+            vcf.alt.str = allele_str;
+            vcf.alt.size = (allele_end ? allele_end : alt_end) - allele_str;
+            if ((ctx->options->vcf->filter_count == 1) && (!ctx->options->vcf->only_insertions)) {
+                vcf.end = vcf.start + abs((int) (vcf.ref.size - vcf.alt.size)) + 1;
             }
-            if ( (c2b_globals.vcf->filter_count == 0) ||
-                 ((c2b_globals.vcf->only_snvs) && (c2b_vcf_record_is_snv(ref_str, vcf.alt))) ||
-                 ((c2b_globals.vcf->only_insertions) && (c2b_vcf_record_is_insertion(ref_str, vcf.alt))) ||
-                 ((c2b_globals.vcf->only_deletions) && (c2b_vcf_record_is_deletion(ref_str, vcf.alt))) ) 
+            if ( (ctx->options->vcf->filter_count == 0) ||
+                 ((ctx->options->vcf->only_snvs) && (c2b_vcf_record_is_snv(vcf.ref, vcf.alt))) ||
+                 ((ctx->options->vcf->only_insertions) && (c2b_vcf_record_is_insertion(vcf.ref, vcf.alt))) ||
+                 ((ctx->options->vcf->only_deletions) && (c2b_vcf_record_is_deletion(vcf.ref, vcf.alt))) ) 
                 {
-                    c2b_line_convert_vcf_to_bed(vcf, dest, dest_size);
+                    c2b_line_convert_vcf_to_bed(vcf, dest);
                 }
+            allele_str = (allele_end) ? allele_end + 1 : NULL;
         }
-        free(alt_alleles_copy), alt_alleles_copy = NULL;
     }
     else {
 
         /* just print the one allele */
 
-        if ((c2b_globals.vcf->filter_count == 1) && (!c2b_globals.vcf->only_insertions)) {
-            vcf.end = start_val + abs(ref_size - strlen(alt_str)) + 1;
+        vcf.alt = alt;
+        if ((ctx->options->vcf->filter_count == 1) && (!ctx->options->vcf->only_insertions)) {
+            vcf.end = vcf.start + abs((int) (vcf.ref.size - vcf.alt.size)) + 1;
         }
-        if ( (c2b_globals.vcf->filter_count == 0) ||
-             ((c2b_globals.vcf->only_snvs) && (c2b_vcf_record_is_snv(ref_str, alt_str))) ||
-             ((c2b_globals.vcf->only_insertions) && (c2b_vcf_record_is_insertion(ref_str, alt_str))) ||
-             ((c2b_globals.vcf->only_deletions) && (c2b_vcf_record_is_deletion(ref_str, alt_str))) ) 
+        if ( (ctx->options->vcf->filter_count == 0) ||
+             ((ctx->options->vcf->only_snvs) && (c2b_vcf_record_is_snv(vcf.ref, vcf.alt))) ||
+             ((ctx->options->vcf->only_insertions) && (c2b_vcf_record_is_insertion(vcf.ref, vcf.alt))) ||
+             ((ctx->options->vcf->only_deletions) && (c2b_vcf_record_is_deletion(vcf.ref, vcf.alt))) ) 
             {
-                c2b_line_convert_vcf_to_bed(vcf, dest, dest_size);
+                c2b_line_convert_vcf_to_bed(vcf, dest);
             }
     }
 }
 
 static inline boolean
-c2b_vcf_allele_is_id(char *s)
+c2b_vcf_allele_is_id(c2b_field_t s)
 {
-    return ((s[0] == c2b_vcf_id_prefix) && (s[strlen(s)-1] == c2b_vcf_id_suffix)) ? kTrue : kFalse;
+    return ((s.size > 0) && (s.str[0] == c2b_vcf_id_prefix) && (s.str[s.size - 1] == c2b_vcf_id_suffix)) ? kTrue : kFalse;
 }
 
 static inline boolean
-c2b_vcf_record_is_snv(char *ref, char *alt) 
+c2b_vcf_record_is_snv(c2b_field_t ref, c2b_field_t alt) 
 {
-    return ((!c2b_vcf_allele_is_id(alt)) && (((int) strlen(ref) - (int) strlen(alt)) == 0)) ? kTrue : kFalse;
+    return ((!c2b_vcf_allele_is_id(alt)) && (((int) ref.size - (int) alt.size) == 0)) ? kTrue : kFalse;
 }
 
 static inline boolean
-c2b_vcf_record_is_insertion(char *ref, char *alt) 
+c2b_vcf_record_is_insertion(c2b_field_t ref, c2b_field_t alt) 
 {
-    return ((!c2b_vcf_allele_is_id(alt)) && (((int) strlen(ref) - (int) strlen(alt)) < 0)) ? kTrue : kFalse;
+    return ((!c2b_vcf_allele_is_id(alt)) && (((int) ref.size - (int) alt.size) < 0)) ? kTrue : kFalse;
 }
 
 static inline boolean
-c2b_vcf_record_is_deletion(char *ref, char *alt) 
+c2b_vcf_record_is_deletion(c2b_field_t ref, c2b_field_t alt) 
 {
-    return ((!c2b_vcf_allele_is_id(alt)) && (((int) strlen(ref) - (int) strlen(alt)) > 0)) ? kTrue : kFalse;
+    return ((!c2b_vcf_allele_is_id(alt)) && (((int) ref.size - (int) alt.size) > 0)) ? kTrue : kFalse;
 }
 
 static inline void
-c2b_line_convert_vcf_to_bed(c2b_vcf_t v, char *dest_line, ssize_t *dest_size) 
+c2b_line_convert_vcf_to_bed(c2b_vcf_t v, c2b_batch_t *dest) 
 {
     /* 
        For VCF v4.2-formatted data, we use the mapping provided by BEDOPS convention described at:
@@ -3152,70 +2100,32 @@ c2b_line_convert_vcf_to_bed(c2b_vcf_t v, char *dest_line, ssize_t *dest_size)
        ...
     */
 
-    if (strlen(v.format) > 0) {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              v.chrom,
-                              v.start,
-                              v.end,
-                              v.id,
-                              v.qual,
-                              v.ref,
-                              v.alt,
-                              v.filter,
-                              v.info,
-                              v.format,
-                              v.samples);
-    }
-    else {
-        *dest_size += sprintf(dest_line + *dest_size,
-                              "%s\t"            \
-                              "%" PRIu64 "\t"   \
-                              "%" PRIu64 "\t"   \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\t"            \
-                              "%s\n",
-                              v.chrom,
-                              v.start,
-                              v.end,
-                              v.id,
-                              v.qual,
-                              v.ref,
-                              v.alt,
-                              v.filter,
-                              v.info);
-    }
-}
-
-static void
-c2b_line_convert_wig_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size)
-{
-    char src_line_str[C2B_MAX_LINE_LENGTH_VALUE];
-    char dest_line_str[C2B_MAX_LINE_LENGTH_VALUE];
+    c2b_batch_append_record(dest, &v, c2b_vcf_columns, sizeof(c2b_vcf_columns) / sizeof(c2b_vcf_columns[0]));
+}
+
+static void
+c2b_block_convert_wig_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block)
+{
+    c2b_convert_block(ctx, dest, block, c2b_line_convert_wig_to_bed_unsorted);
+}
+
+static void
+c2b_line_convert_wig_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line)
+{
+    char *src = line->src;
+    ssize_t src_size = line->size;
+    char *src_line_str = NULL;
 
     /* 
        Initialize and increment parameters
     */
 
-    c2b_globals.wig->line++;
-    if (c2b_globals.wig->basename) {
-        sprintf(c2b_globals.wig->id,
+    ctx->wig.line++;
+    if (ctx->options->wig_basename) {
+        sprintf(ctx->wig.id,
                 "%s.%u",
-                c2b_globals.wig->basename,
-                c2b_globals.wig->section);
+                ctx->options->wig_basename,
+                ctx->wig.section);
     }
 
     /* 
@@ -3223,37 +2133,22 @@ c2b_line_convert_wig_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
     */
     
     if (src[0] == c2b_wig_header_prefix) { 
-        if (c2b_globals.wig->start_write) {
-            c2b_globals.wig->start_write = kFalse;
-            sprintf(c2b_globals.wig->id, 
+        if (ctx->wig.start_write) {
+            ctx->wig.start_write = kFalse;
+            sprintf(ctx->wig.id, 
                     "%s.%u",
-                    c2b_globals.wig->basename, 
-                    ++c2b_globals.wig->section);
+                    ctx->options->wig_basename, 
+                    ++ctx->wig.section);
         }
-        if (c2b_globals.keep_header_flag) { 
+        if (ctx->options->keep_header_flag) { 
             /* copy header line to destination stream buffer */
-            memcpy(src_line_str, src, src_size);
-            src_line_str[src_size] = '\0';
-            if (!c2b_globals.wig->basename) {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        src_line_str);
+            if (!ctx->options->wig_basename) {
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
             }
             else {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        c2b_globals.wig->id,
-                        src_line_str);
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, ctx->wig.id, src, src_size);
             }
-            memcpy(dest + *dest_size, dest_line_str, strlen(dest_line_str));
-            *dest_size += strlen(dest_line_str);
-            c2b_globals.header_line_idx++;
+            ctx->header_line_idx++;
             return;
         }
         else {
@@ -3262,37 +2157,22 @@ c2b_line_convert_wig_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
     }
     else if ((strncmp(src, c2b_wig_track_prefix, strlen(c2b_wig_track_prefix)) == 0) || 
              (strncmp(src, c2b_wig_browser_prefix, strlen(c2b_wig_browser_prefix)) == 0)) {
-        if (c2b_globals.wig->start_write) {
-            c2b_globals.wig->start_write = kFalse;
-            sprintf(c2b_globals.wig->id,
+        if (ctx->wig.start_write) {
+            ctx->wig.start_write = kFalse;
+            sprintf(ctx->wig.id,
                     "%s.%u",
-                    c2b_globals.wig->basename,
-                    ++c2b_globals.wig->section);
+                    ctx->options->wig_basename,
+                    ++ctx->wig.section);
         }
-        if (c2b_globals.keep_header_flag) { 
+        if (ctx->options->keep_header_flag) { 
             /* copy header line to destination stream buffer */
-            memcpy(src_line_str, src, src_size);
-            src_line_str[src_size] = '\0';
-            if (!c2b_globals.wig->basename) {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        src_line_str);
+            if (!ctx->options->wig_basename) {
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src, src_size);
             }
             else {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        c2b_globals.wig->id,
-                        src_line_str);
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, ctx->wig.id, src, src_size);
             }
-            memcpy(dest + *dest_size, dest_line_str, strlen(dest_line_str));
-            *dest_size += strlen(dest_line_str);
-            c2b_globals.header_line_idx++;
+            ctx->header_line_idx++;
             return;
         }
         else {
@@ -3300,48 +2180,36 @@ c2b_line_convert_wig_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         }        
     }
     else if (strncmp(src, c2b_wig_variable_step_prefix, strlen(c2b_wig_variable_step_prefix)) == 0) {
-        memcpy(src_line_str, src, src_size);
-        src_line_str[src_size] = '\0';
+        /* sscanf() reads from a NUL-terminated copy of the line */
+        src_line_str = c2b_copy_field(ctx, src, src_size);
+        c2b_grow_buffer(&(ctx->wig.chr), &(ctx->wig.chr_capacity), src_size + 1, "WIG chromosome string");
         int variable_step_fields = sscanf(src_line_str, 
                                           "variableStep chrom=%s span=%" SCNu64 "\n", 
-                                          c2b_globals.wig->chr, 
-                                          &(c2b_globals.wig->span));
+                                          ctx->wig.chr, 
+                                          &(ctx->wig.span));
         if (variable_step_fields < 1) {
-            fprintf(stderr, "Error: Invalid variableStep header on line %u\n", c2b_globals.wig->line);
+            fprintf(stderr, "Error: Invalid variableStep header on line %u\n", ctx->wig.line);
             exit(EINVAL); /* Invalid argument (POSIX.1) */
         }
         if (variable_step_fields == 1)
-            c2b_globals.wig->span = 1;
-        c2b_globals.wig->is_fixed_step = kFalse;
-        if (c2b_globals.wig->start_write) {
-            c2b_globals.wig->start_write = kFalse;
-            sprintf(c2b_globals.wig->id,
+            ctx->wig.span = 1;
+        ctx->wig.is_fixed_step = kFalse;
+        if (ctx->wig.start_write) {
+            ctx->wig.start_write = kFalse;
+            sprintf(ctx->wig.id,
                     "%s.%u",
-                    c2b_globals.wig->basename,
-                    ++c2b_globals.wig->section);
+                    ctx->options->wig_basename,
+                    ++ctx->wig.section);
         }
-        if (c2b_globals.keep_header_flag) { 
+        if (ctx->options->keep_header_flag) { 
             /* copy header line to destination stream buffer */
-            if (!c2b_globals.wig->basename) {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        src_line_str);
+            if (!ctx->options->wig_basename) {
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src_line_str, strlen(src_line_str));
             }
             else {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        c2b_globals.wig->id,
-                        src_line_str);
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, ctx->wig.id, src_line_str, strlen(src_line_str));
             }
-            memcpy(dest + *dest_size, dest_line_str, strlen(dest_line_str));
-            *dest_size += strlen(dest_line_str);
-            c2b_globals.header_line_idx++;
+            ctx->header_line_idx++;
             return;
         }
         else {
@@ -3349,44 +2217,31 @@ c2b_line_convert_wig_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         }                
     }
     else if (strncmp(src, c2b_wig_fixed_step_prefix, strlen(c2b_wig_fixed_step_prefix)) == 0) {
-        memcpy(src_line_str, src, src_size);
-        src_line_str[src_size] = '\0';
+        src_line_str = c2b_copy_field(ctx, src, src_size);
+        c2b_grow_buffer(&(ctx->wig.chr), &(ctx->wig.chr_capacity), src_size + 1, "WIG chromosome string");
         int fixed_step_fields = sscanf(src_line_str, 
                                        "fixedStep chrom=%s start=%" SCNu64 " step=%" SCNu64 " span=%" SCNu64 "\n", 
-                                       c2b_globals.wig->chr, 
-                                       &(c2b_globals.wig->start_pos), 
-                                       &(c2b_globals.wig->step), 
-                                       &(c2b_globals.wig->span));
+                                       ctx->wig.chr, 
+                                       &(ctx->wig.start_pos), 
+                                       &(ctx->wig.step), 
+                                       &(ctx->wig.span));
         if (fixed_step_fields < 3) {
-            fprintf(stderr, "Error: Invalid fixedStep header on line %u\n", c2b_globals.wig->line);
+            fprintf(stderr, "Error: Invalid fixedStep header on line %u\n", ctx->wig.line);
             exit(EINVAL); /* Invalid argument (POSIX.1) */
         }
         if (fixed_step_fields == 3) {
-            c2b_globals.wig->span = 1;
+            ctx->wig.span = 1;
         }
-        c2b_globals.wig->is_fixed_step = kTrue;
-        if (c2b_globals.keep_header_flag) { 
+        ctx->wig.is_fixed_step = kTrue;
+        if (ctx->options->keep_header_flag) { 
             /* copy header line to destination stream buffer */
-            if (!c2b_globals.wig->basename) {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        src_line_str);
+            if (!ctx->options->wig_basename) {
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, NULL, src_line_str, strlen(src_line_str));
             }
             else {
-                sprintf(dest_line_str, 
-                        "%s\t%u\t%u\t%s\t%s\n", 
-                        c2b_header_chr_name, 
-                        c2b_globals.header_line_idx, 
-                        c2b_globals.header_line_idx + 1, 
-                        c2b_globals.wig->id,
-                        src_line_str);
+                c2b_batch_append_header_line(dest, ctx->header_line_idx, ctx->wig.id, src_line_str, strlen(src_line_str));
             }
-            memcpy(dest + *dest_size, dest_line_str, strlen(dest_line_str));
-            *dest_size += strlen(dest_line_str);
-            c2b_globals.header_line_idx++;
+            ctx->header_line_idx++;
             return;
         }
         else {
@@ -3394,173 +2249,100 @@ c2b_line_convert_wig_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src,
         }        
     }
     else if (strncmp(src, c2b_wig_chr_prefix, strlen(c2b_wig_chr_prefix)) == 0) {
-        memcpy(src_line_str, src, src_size);
-        src_line_str[src_size] = '\0';
+        src_line_str = c2b_copy_field(ctx, src, src_size);
+        c2b_grow_buffer(&(ctx->wig.chr), &(ctx->wig.chr_capacity), src_size + 1, "WIG chromosome string");
         int bed_fields = sscanf(src_line_str, 
                                 "%s\t%" SCNu64 "\t%" SCNu64 "\t%lf\n", 
-                                c2b_globals.wig->chr,
-                                &(c2b_globals.wig->start_pos), 
-                                &(c2b_globals.wig->end_pos), 
-                                &(c2b_globals.wig->score));
+                                ctx->wig.chr,
+                                &(ctx->wig.start_pos), 
+                                &(ctx->wig.end_pos), 
+                                &(ctx->wig.score));
         if (bed_fields != 4) {
-            fprintf(stderr, "Error: Invalid WIG line %u\n", c2b_globals.wig->line);
+            fprintf(stderr, "Error: Invalid WIG line %u\n", ctx->wig.line);
             exit(EINVAL); /* Invalid argument (POSIX.1) */
         }
-        c2b_globals.wig->pos_lines++;
-        if ((c2b_globals.wig->start_pos == 0) && (!c2b_globals.zero_indexed_flag)) {
-            fprintf(stderr, "Error: WIG data contains 0-indexed element at line %u\n", c2b_globals.wig->line);
+        ctx->wig.pos_lines++;
+        if ((ctx->wig.start_pos == 0) && (!ctx->options->zero_indexed_flag)) {
+            fprintf(stderr, "Error: WIG data contains 0-indexed element at line %u\n", ctx->wig.line);
             fprintf(stderr, "       Consider adding --zero-indexed (-x) option to convert zero-indexed WIG data\n");
             exit(EINVAL); /* Invalid argument (POSIX.1) */
         }
-        if (!c2b_globals.wig->basename) {
-            sprintf(dest_line_str,
-                    "%s\t"                      \
-                    "%" PRIu64 "\t"             \
-                    "%" PRIu64 "\t"             \
-                    "id-%d\t"                   \
-                    "%lf\n",
-                    c2b_globals.wig->chr,
-                    c2b_globals.wig->start_pos - c2b_globals.wig->start_shift,
-                    c2b_globals.wig->end_pos - c2b_globals.wig->end_shift,
-                    c2b_globals.wig->pos_lines,
-                    c2b_globals.wig->score);
-        }
-        else {
-            sprintf(dest_line_str,
-                    "%s\t"                      \
-                    "%" PRIu64 "\t"             \
-                    "%" PRIu64 "\t"             \
-                    "%s-%d\t"                   \
-                    "%lf\n",
-                    c2b_globals.wig->chr,
-                    c2b_globals.wig->start_pos - c2b_globals.wig->start_shift,
-                    c2b_globals.wig->end_pos - c2b_globals.wig->end_shift,
-                    c2b_globals.wig->id,
-                    c2b_globals.wig->pos_lines,
-                    c2b_globals.wig->score);
-        }
-        c2b_globals.wig->start_write = kTrue;
-        memcpy(dest + *dest_size, dest_line_str, strlen(dest_line_str));
-        *dest_size += strlen(dest_line_str);
+        c2b_line_append_wig_record(ctx, dest,
+                                   ctx->wig.start_pos - ctx->options->wig_start_shift,
+                                   ctx->wig.end_pos - ctx->options->wig_end_shift);
+        ctx->wig.start_write = kTrue;
     }
     else {
-        memcpy(src_line_str, src, src_size);
-        src_line_str[src_size] = '\0';
+        src_line_str = c2b_copy_field(ctx, src, src_size);
 
-        if (c2b_globals.wig->is_fixed_step) {
+        if (ctx->wig.is_fixed_step) {
 
-            int fixed_step_column_fields = sscanf(src_line_str, "%lf\n", &(c2b_globals.wig->score));
+            int fixed_step_column_fields = sscanf(src_line_str, "%lf\n", &(ctx->wig.score));
             if (fixed_step_column_fields != 1) {
-                fprintf(stderr, "Error: Invalid WIG line %u\n", c2b_globals.wig->line);
+                fprintf(stderr, "Error: Invalid WIG line %u\n", ctx->wig.line);
                 exit(EINVAL); /* Invalid argument (POSIX.1) */
             }
-            c2b_globals.wig->pos_lines++;
-            if ((c2b_globals.wig->start_pos == 0) && (!c2b_globals.zero_indexed_flag)) {
-                fprintf(stderr, "Error: WIG data contains 0-indexed element at line %u\n", c2b_globals.wig->line);
+            ctx->wig.pos_lines++;
+            if ((ctx->wig.start_pos == 0) && (!ctx->options->zero_indexed_flag)) {
+                fprintf(stderr, "Error: WIG data contains 0-indexed element at line %u\n", ctx->wig.line);
                 fprintf(stderr, "       Consider adding --zero-indexed (-x) option to convert zero-indexed WIG data\n");
                 exit(EINVAL); /* Invalid argument (POSIX.1) */
             }
-            if (!c2b_globals.wig->basename) {
-                sprintf(dest_line_str,
-                        "%s\t"                  \
-                        "%" PRIu64 "\t"         \
-                        "%" PRIu64 "\t"         \
-                        "id-%d\t"               \
-                        "%lf\n",
-                        c2b_globals.wig->chr,
-                        c2b_globals.wig->start_pos - c2b_globals.wig->start_shift,
-                        c2b_globals.wig->start_pos + c2b_globals.wig->span - c2b_globals.wig->end_shift,
-                        c2b_globals.wig->pos_lines,
-                        c2b_globals.wig->score);
-            }
-            else {
-                sprintf(dest_line_str,
-                        "%s\t"                  \
-                        "%" PRIu64 "\t"         \
-                        "%" PRIu64 "\t"         \
-                        "%s-%d\t"               \
-                        "%lf\n",
-                        c2b_globals.wig->chr,
-                        c2b_globals.wig->start_pos - c2b_globals.wig->start_shift,
-                        c2b_globals.wig->start_pos + c2b_globals.wig->span - c2b_globals.wig->end_shift,
-                        c2b_globals.wig->id,
-                        c2b_globals.wig->pos_lines,
-                        c2b_globals.wig->score);
-            }            
-            c2b_globals.wig->start_pos += c2b_globals.wig->step;
-            c2b_globals.wig->start_write = kTrue;
-            memcpy(dest + *dest_size, dest_line_str, strlen(dest_line_str));
-            *dest_size += strlen(dest_line_str);
+            c2b_line_append_wig_record(ctx, dest,
+                                       ctx->wig.start_pos - ctx->options->wig_start_shift,
+                                       ctx->wig.start_pos + ctx->wig.span - ctx->options->wig_end_shift);
+            ctx->wig.start_pos += ctx->wig.step;
+            ctx->wig.start_write = kTrue;
         }
         else {
             int variable_step_column_fields = sscanf(src_line_str, 
                                                      "%" SCNu64 "\t%lf\n", 
-                                                     &(c2b_globals.wig->start_pos), 
-                                                     &(c2b_globals.wig->score));
+                                                     &(ctx->wig.start_pos), 
+                                                     &(ctx->wig.score));
             if (variable_step_column_fields != 2) {
-                fprintf(stderr, "Error: Invalid WIG line %u\n", c2b_globals.wig->line);
+                fprintf(stderr, "Error: Invalid WIG line %u\n", ctx->wig.line);
                 exit(EINVAL); /* Invalid argument (POSIX.1) */
             }
-            c2b_globals.wig->pos_lines++;
-            if ((c2b_globals.wig->start_pos == 0) && (!c2b_globals.zero_indexed_flag)) {
-                fprintf(stderr, "Error: WIG data contains 0-indexed element at line %u\n", c2b_globals.wig->line);
+            ctx->wig.pos_lines++;
+            if ((ctx->wig.start_pos == 0) && (!ctx->options->zero_indexed_flag)) {
+                fprintf(stderr, "Error: WIG data contains 0-indexed element at line %u\n", ctx->wig.line);
                 fprintf(stderr, "       Consider adding --zero-indexed (-x) option to convert zero-indexed WIG data\n");
                 exit(EINVAL); /* Invalid argument (POSIX.1) */
             }
-            if (!c2b_globals.wig->basename) {
-                sprintf(dest_line_str,
-                        "%s\t"                  \
-                        "%" PRIu64 "\t"         \
-                        "%" PRIu64 "\t"         \
-                        "id-%d\t"               \
-                        "%lf\n",
-                        c2b_globals.wig->chr,
-                        c2b_globals.wig->start_pos - c2b_globals.wig->start_shift,
-                        c2b_globals.wig->start_pos + c2b_globals.wig->span - c2b_globals.wig->end_shift,
-                        c2b_globals.wig->pos_lines,
-                        c2b_globals.wig->score);
-            }
-            else {
-                sprintf(dest_line_str,
-                        "%s\t"                  \
-                        "%" PRIu64 "\t"         \
-                        "%" PRIu64 "\t"         \
-                        "%s-%d\t"               \
-                        "%lf\n",
-                        c2b_globals.wig->chr,
-                        c2b_globals.wig->start_pos - c2b_globals.wig->start_shift,
-                        c2b_globals.wig->start_pos + c2b_globals.wig->span - c2b_globals.wig->end_shift,
-                        c2b_globals.wig->id,
-                        c2b_globals.wig->pos_lines,
-                        c2b_globals.wig->score);
-            }            
-            c2b_globals.wig->start_pos += c2b_globals.wig->step;
-            c2b_globals.wig->start_write = kTrue;
-            memcpy(dest + *dest_size, dest_line_str, strlen(dest_line_str));
-            *dest_size += strlen(dest_line_str);
+            c2b_line_append_wig_record(ctx, dest,
+                                       ctx->wig.start_pos - ctx->options->wig_start_shift,
+                                       ctx->wig.start_pos + ctx->wig.span - ctx->options->wig_end_shift);
+            ctx->wig.start_pos += ctx->wig.step;
+            ctx->wig.start_write = kTrue;
         }
     }
 }
 
+static void
+c2b_line_append_wig_record(c2b_context_t *ctx, c2b_batch_t *dest, uint64_t start, uint64_t end)
+{
+    c2b_batch_append_str(dest, ctx->wig.chr, '\t');
+    c2b_batch_append_uint64(dest, start, '\t');
+    c2b_batch_append_uint64(dest, end, '\t');
+    c2b_batch_append_str(dest, (ctx->options->wig_basename) ? ctx->wig.id : "id", '-');
+    c2b_batch_append_int(dest, (int) ctx->wig.pos_lines, '\t');
+
+    /* the score is left to printf, so that its rounding matches "%lf" exactly */
+    c2b_batch_printf(dest, "%lf\n", ctx->wig.score);
+}
+
 static void *
 c2b_read_bytes_from_stdin(void *arg)
 {
     c2b_pipeline_stage_t *stage = (c2b_pipeline_stage_t *) arg;
     c2b_pipeset_t *pipes = stage->pipeset;
-    char buffer[C2B_MAX_LINE_LENGTH_VALUE];
-    ssize_t bytes_read;
     int exit_status = 0;
 
 #ifdef DEBUG
     fprintf(stderr, "\t-> c2b_read_bytes_from_stdin | reading from fd     (%02d) | writing to fd     (%02d)\n", STDIN_FILENO, pipes->in[stage->dest][PIPE_WRITE]);
 #endif
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    while ((bytes_read = read(STDIN_FILENO, buffer, C2B_MAX_LINE_LENGTH_VALUE)) > 0) {
-        write(pipes->in[stage->dest][PIPE_WRITE], buffer, bytes_read);
-    }
-#pragma GCC diagnostic pop
+    c2b_relay_bytes(STDIN_FILENO, pipes->in[stage->dest][PIPE_WRITE]);
     close(pipes->in[stage->dest][PIPE_WRITE]);
 
     if (WIFEXITED(stage->status) || WIFSIGNALED(stage->status)) {
@@ -3578,222 +2360,903 @@ c2b_read_bytes_from_stdin(void *arg)
     pthread_exit(NULL);
 }
 
-static void *
-c2b_process_intermediate_bytes_by_lines(void *arg)
+static inline void
+c2b_process_lines(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block, char *src, ssize_t src_size, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *))
 {
-    c2b_pipeline_stage_t *stage = (c2b_pipeline_stage_t *) arg;
-    c2b_pipeset_t *pipes = stage->pipeset;
-    char *src_buffer = NULL;
-    ssize_t src_buffer_size = C2B_MAX_LINE_LENGTH_VALUE;
-    ssize_t src_bytes_read = 0;
-    ssize_t remainder_length = 0;
-    ssize_t remainder_offset = 0;
-    char line_delim = '\n';
-    ssize_t lines_offset = 0;
-    ssize_t start_offset = 0;
-    ssize_t end_offset = 0;
-    char *dest_buffer = NULL;
-    ssize_t dest_buffer_size = C2B_MAX_LINE_LENGTH_VALUE * C2B_MAX_LINES_VALUE;
-    ssize_t dest_bytes_written = 0;
-    void (*line_functor)(char *, ssize_t *, char *, ssize_t) = stage->line_functor;
-    int exit_status = 0;
-
-#ifdef DEBUG
-    fprintf(stderr, "\t-> c2b_process_intermediate_bytes_by_lines | reading from fd  (%02d) | writing to fd  (%02d)\n", pipes->out[stage->src][PIPE_READ], pipes->in[stage->dest][PIPE_WRITE]);
-#endif
-
     /* 
-       We read from the src out pipe, then write to the dest in pipe 
+       We process bytes from index [0] to index [src_size - 1] for all lines 
+       contained within, appending translated lines to dest
     */
-    
-    src_buffer = malloc(src_buffer_size);
-    if (!src_buffer) {
-        fprintf(stderr, "Error: Could not allocate space for intermediate source buffer.\n");
-        c2b_print_usage(stderr);
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
 
-    dest_buffer = malloc(dest_buffer_size);
-    if (!dest_buffer) {
-        fprintf(stderr, "Error: Could not allocate space for intermediate destination buffer.\n");
+    c2b_tokenize_block(block, src, src_size);
+    (*block_converter)(ctx, dest, block);
+}
+
+static void
+c2b_init_block(c2b_block_t *block)
+{
+    block->lines_capacity = C2B_BLOCK_LINES_VALUE;
+    block->lines = malloc(block->lines_capacity * sizeof(c2b_line_t));
+    block->field_offsets_capacity = C2B_BLOCK_LINES_VALUE * C2B_BLOCK_FIELDS_PER_LINE_VALUE;
+    block->field_offsets = malloc(block->field_offsets_capacity * sizeof(ssize_t));
+    if ((!block->lines) || (!block->field_offsets)) {
+        fprintf(stderr, "Error: Could not allocate space for line block offsets.\n");
         c2b_print_usage(stderr);
         exit(ENOMEM); /* Not enough space (POSIX.1) */
     }
-    dest_buffer[0] = '\0';
-
-    while ((src_bytes_read = read(pipes->out[stage->src][PIPE_READ],
-                                  src_buffer + remainder_length,
-                                  src_buffer_size - remainder_length)) > 0) {
-
-        /* 
-           So here's what src_buffer looks like initially; basically, some stuff separated by
-           newlines. The src_buffer will probably not terminate with a newline. So we first use 
-           a custom memrchr() call to find the remainder_offset index value:
-           
-           src_buffer  [  .  .  .  \n  .  .  .  \n  .  .  .  \n  .  .  .  .  .  .  ]
-           index        0 1 2 ...                            ^                    ^
-                                                             |                    |
-                                                             |   src_bytes_read --
-                                                             | 
-                                         remainder_offset --- 
-
-           In other words, everything at and after index [remainder_offset + 1] to index
-           [src_bytes_read - 1] is a remainder byte ("R"):
-
-           src_buffer  [  .  .  .  \n  .  .  .  \n  .  .  .  \n R R R R R ]
-           
-           Assuming this failed:
-
-           If remainder_offset is -1 and we have read src_buffer_size bytes, then we know there 
-           are no newlines anywhere in the src_buffer and so we terminate early with an error state.
-           This would suggest either src_buffer_size is too small to hold a whole intermediate 
-           line or the input data is perhaps corrupt. Basically, something went wrong and we need 
-           to investigate.
-           
-           Asumming this worked:
-           
-           We can now parse byte indices {[0 .. remainder_offset]} into lines, which are fed one
-           by one to the line_functor. This functor parses out tab offsets and writes out a 
-           reordered string based on the rules for the format (see BEDOPS docs for reordering 
-           table).
-           
-           Finally, we write bytes from index [remainder_offset + 1] to [src_bytes_read - 1] 
-           back to src_buffer. We are writing remainder_length bytes:
-           
-           new_remainder_length = current_src_bytes_read + old_remainder_length - new_remainder_offset
-           
-           Note that we can leave the rest of the buffer untouched:
-           
-           src_buffer  [ R R R R R \n  .  .  .  \n  .  .  .  \n  .  .  .  ]
-           
-           On the subsequent read, we want to read() into src_buffer at position remainder_length
-           and read up to, at most, (src_buffer_size - remainder_length) bytes:
-           
-           read(byte_source, 
-                src_buffer + remainder_length,
-                src_buffer_size - remainder_length)
+    block->num_lines = 0;
+    block->num_field_offsets = 0;
+}
 
-           Second and subsequent reads should reduce the maximum number of src_bytes_read from 
-           src_buffer_size to something smaller.
-        */
+static void
+c2b_delete_block(c2b_block_t *block)
+{
+    free(block->lines), block->lines = NULL;
+    free(block->field_offsets), block->field_offsets = NULL;
+    block->num_lines = 0;
+    block->num_field_offsets = 0;
+}
 
-        c2b_memrchr_offset(&remainder_offset, src_buffer, src_buffer_size, src_bytes_read + remainder_length, line_delim);
+static inline void
+c2b_block_push_field_offset(c2b_block_t *block, ssize_t offset)
+{
+    ssize_t *field_offsets = NULL;
 
-        if (remainder_offset == -1) {
-            if (src_bytes_read + remainder_length == src_buffer_size) {
-                fprintf(stderr, "Error: Could not find newline in intermediate buffer; check input\n");
-                c2b_print_usage(stderr);
-                exit(EINVAL); /* Invalid argument (POSIX.1) */
-            }
-            remainder_offset = 0;
+    if (block->num_field_offsets == block->field_offsets_capacity) {
+        field_offsets = realloc(block->field_offsets, 2 * block->field_offsets_capacity * sizeof(ssize_t));
+        if (!field_offsets) {
+            fprintf(stderr, "Error: Could not grow line block offsets.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
         }
+        block->field_offsets = field_offsets;
+        block->field_offsets_capacity *= 2;
+    }
+    block->field_offsets[block->num_field_offsets++] = offset;
+}
 
-        /* 
-           We next want to process bytes from index [0] to index [remainder_offset - 1] for all
-           lines contained within. We basically build a buffer containing all translated 
-           lines to write downstream.
-        */
+static inline void
+c2b_block_push_line(c2b_block_t *block, char *line_start, ssize_t line_size, int field_idx)
+{
+    c2b_line_t *line = NULL;
+    c2b_line_t *lines = NULL;
 
-        lines_offset = 0;
-        start_offset = 0;
-        dest_bytes_written = 0;
-        while (lines_offset < remainder_offset) {
-            if (src_buffer[lines_offset] == line_delim) {
-                end_offset = lines_offset;
-                /* for a given line from src, we write dest_bytes_written number of bytes to dest_buffer (plus written offset) */
-                (*line_functor)(dest_buffer, &dest_bytes_written, src_buffer + start_offset, end_offset - start_offset);
-                start_offset = end_offset + 1;
-            }
-            lines_offset++;            
+    if (block->num_lines == block->lines_capacity) {
+        lines = realloc(block->lines, 2 * block->lines_capacity * sizeof(c2b_line_t));
+        if (!lines) {
+            fprintf(stderr, "Error: Could not grow line block offsets.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
         }
-        
-        /* 
-           We have filled up dest_buffer with translated bytes (dest_bytes_written of them)
-           and can now write() this buffer to the in-pipe of the destination stage
-        */
-        
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-        write(pipes->in[stage->dest][PIPE_WRITE], dest_buffer, dest_bytes_written);
-#pragma GCC diagnostic pop
+        block->lines = lines;
+        block->lines_capacity *= 2;
+    }
+    line = &block->lines[block->num_lines++];
+    line->src = line_start;
+    line->size = line_size;
+    line->field_idx = field_idx;
+    c2b_block_push_field_offset(block, line_size);
+    c2b_block_push_field_offset(block, -1);
+}
 
-        remainder_length = src_bytes_read + remainder_length - remainder_offset;
-        memcpy(src_buffer, src_buffer + remainder_offset, remainder_length);
+static inline void
+c2b_block_push_delimiter(c2b_block_t *block, char *src, ssize_t posn, ssize_t *line_start, int *field_idx)
+{
+    if (src[posn] == '\n') {
+        c2b_block_push_line(block, src + *line_start, posn - *line_start, *field_idx);
+        *line_start = posn + 1;
+        *field_idx = 0;
     }
+    else {
+        c2b_block_push_field_offset(block, posn - *line_start);
+        (*field_idx)++;
+    }
+}
 
-    close(pipes->in[stage->dest][PIPE_WRITE]);
+static void
+c2b_tokenize_block(c2b_block_t *block, char *src, ssize_t src_size)
+{
+    ssize_t line_idx = 0;
+    ssize_t field_offsets_idx = 0;
 
-    if (src_buffer) 
-        free(src_buffer), src_buffer = NULL;
+    block->num_lines = 0;
+    block->num_field_offsets = 0;
 
-    if (dest_buffer)
-        free(dest_buffer), dest_buffer = NULL;
+    c2b_globals.tokenize_lines(block, src, src_size);
 
-    if (WIFEXITED(stage->status) || WIFSIGNALED(stage->status)) {
-        waitpid(stage->pid, &stage->status, WUNTRACED);
-        exit_status = WEXITSTATUS(stage->status);
-        if (exit_status != 0) 
-            fprintf(stderr, 
-                    "Error: Stage [%s] failed -- exit status [%d | %d]\n", 
-                    stage->description,
-                    stage->status, 
-                    exit_status);
-    }
+    /* 
+       The offsets array may have moved while it grew, so lines are pointed
+       at their offsets only once the whole block is tokenized
+    */
 
-    pthread_exit(NULL);
+    for (line_idx = 0; line_idx < block->num_lines; line_idx++) {
+        block->lines[line_idx].field_offsets = block->field_offsets + field_offsets_idx;
+        field_offsets_idx += block->lines[line_idx].field_idx + 2;
+    }
 }
 
-static void *
-c2b_write_in_bytes_to_in_process(void *arg)
+static void
+c2b_tokenize_lines_scalar(c2b_block_t *block, char *src, ssize_t src_size)
 {
-    c2b_pipeline_stage_t *stage = (c2b_pipeline_stage_t *) arg;
-    c2b_pipeset_t *pipes = stage->pipeset;
-    char buffer[C2B_MAX_LINE_LENGTH_VALUE];
-    ssize_t bytes_read;
-    int exit_status = 0;
+    char *line_start = src;
+    char *line_end = NULL;
+    char *tab = NULL;
+    char *src_end = src + src_size;
+    int field_idx = 0;
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    /* read buffer from p->in[1] and write buffer to p->in[2] */
-    while ((bytes_read = read(pipes->in[stage->src][PIPE_READ], buffer, C2B_MAX_LINE_LENGTH_VALUE)) > 0) { 
-        write(pipes->in[stage->dest][PIPE_WRITE], buffer, bytes_read);
+    /* 
+       Lines and tabs are found with memchr(), which the C library can 
+       usually scan many bytes at a time. Lines may be of any length. Any 
+       bytes after the last newline are not part of the block.
+    */
+
+    while ((line_start < src_end) && ((line_end = memchr(line_start, '\n', src_end - line_start)) != NULL)) {
+        field_idx = 0;
+        tab = line_start;
+        while ((tab = memchr(tab, '\t', line_end - tab)) != NULL) {
+            c2b_block_push_field_offset(block, tab - line_start);
+            field_idx++;
+            tab++;
+        }
+        c2b_block_push_line(block, line_start, line_end - line_start, field_idx);
+        line_start = line_end + 1;
     }
-#pragma GCC diagnostic pop
+}
 
-    close(pipes->in[stage->dest][PIPE_WRITE]);
+#ifdef C2B_HAVE_X86_SIMD
+__attribute__ ((target("sse2")))
+static void
+c2b_tokenize_lines_sse2(c2b_block_t *block, char *src, ssize_t src_size)
+{
+    const __m128i tabs = _mm_set1_epi8('\t');
+    const __m128i newlines = _mm_set1_epi8('\n');
+    __m128i bytes;
+    unsigned int mask = 0;
+    ssize_t posn = 0;
+    ssize_t line_start = 0;
+    int field_idx = 0;
 
-    if (WIFEXITED(stage->status) || WIFSIGNALED(stage->status)) {
-        waitpid(stage->pid, &stage->status, WUNTRACED);
-        exit_status = WEXITSTATUS(stage->status);
-        if (exit_status != 0) 
-            fprintf(stderr, 
-                    "Error: Stage [%s] failed -- exit status [%d | %d]\n", 
-                    stage->description,
-                    stage->status, 
-                    exit_status);
+    /* 
+       Tabs and newlines are found together, sixteen bytes at a time, in a 
+       single pass over the block. Each set bit of the comparison mask is a
+       delimiter, which either adds a field offset or closes the current line.
+    */
+
+    for (posn = 0; posn + 16 <= src_size; posn += 16) {
+        bytes = _mm_loadu_si128((const __m128i *) (src + posn));
+        mask = (unsigned int) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, tabs), _mm_cmpeq_epi8(bytes, newlines)));
+        while (mask) {
+            c2b_block_push_delimiter(block, src, posn + __builtin_ctz(mask), &line_start, &field_idx);
+            mask &= mask - 1;
+        }
+    }
+    for (; posn < src_size; posn++) {
+        if ((src[posn] == '\t') || (src[posn] == '\n'))
+            c2b_block_push_delimiter(block, src, posn, &line_start, &field_idx);
     }
 
-    pthread_exit(NULL);
+    /* offsets of tabs after the last newline are not part of the block */
+    block->num_field_offsets -= field_idx;
 }
 
-static void *
-c2b_write_out_bytes_to_in_process(void *arg)
+__attribute__ ((target("avx2")))
+static void
+c2b_tokenize_lines_avx2(c2b_block_t *block, char *src, ssize_t src_size)
 {
-    c2b_pipeline_stage_t *stage = (c2b_pipeline_stage_t *) arg;
-    c2b_pipeset_t *pipes = stage->pipeset;
-    char buffer[C2B_MAX_LINE_LENGTH_VALUE];
-    ssize_t bytes_read;
-    int exit_status = 0;
+    const __m256i tabs = _mm256_set1_epi8('\t');
+    const __m256i newlines = _mm256_set1_epi8('\n');
+    __m256i bytes;
+    unsigned int mask = 0;
+    ssize_t posn = 0;
+    ssize_t line_start = 0;
+    int field_idx = 0;
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    /* read buffer from p->out[1] and write buffer to p->in[2] */
-    while ((bytes_read = read(pipes->out[stage->src][PIPE_READ], buffer, C2B_MAX_LINE_LENGTH_VALUE)) > 0) { 
-        write(pipes->in[stage->dest][PIPE_WRITE], buffer, bytes_read);
-    }
-#pragma GCC diagnostic pop
+    /* 
+       As with c2b_tokenize_lines_sse2(), but thirty-two bytes at a time
+    */
 
-    close(pipes->in[stage->dest][PIPE_WRITE]);
+    for (posn = 0; posn + 32 <= src_size; posn += 32) {
+        bytes = _mm256_loadu_si256((const __m256i *) (src + posn));
+        mask = (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, tabs), _mm256_cmpeq_epi8(bytes, newlines)));
+        while (mask) {
+            c2b_block_push_delimiter(block, src, posn + __builtin_ctz(mask), &line_start, &field_idx);
+            mask &= mask - 1;
+        }
+    }
+    for (; posn < src_size; posn++) {
+        if ((src[posn] == '\t') || (src[posn] == '\n'))
+            c2b_block_push_delimiter(block, src, posn, &line_start, &field_idx);
+    }
+
+    /* offsets of tabs after the last newline are not part of the block */
+    block->num_field_offsets -= field_idx;
+}
+#endif
+
+static void
+c2b_init_tokenizer()
+{
+    /* 
+       The widest tokenizer the processor supports is picked once, at 
+       startup; the scalar tokenizer is used everywhere else
+    */
+
+    c2b_globals.tokenize_lines = c2b_tokenize_lines_scalar;
+
+#ifdef C2B_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        c2b_globals.tokenize_lines = c2b_tokenize_lines_avx2;
+    else if (__builtin_cpu_supports("sse2"))
+        c2b_globals.tokenize_lines = c2b_tokenize_lines_sse2;
+#endif
+
+#ifdef DEBUG
+    fprintf(stderr, "Debug: c2b_globals.tokenize_lines: [%s]\n", 
+            (c2b_globals.tokenize_lines == c2b_tokenize_lines_scalar) ? "scalar" : "simd");
+#endif
+}
+
+static inline c2b_field_t
+c2b_line_field(const c2b_line_t *line, int idx)
+{
+    c2b_field_t f;
+    ssize_t start = 0;
+
+    /* a field past the end of the line is an empty view */
+    if (idx > line->field_idx) {
+        f.str = line->src + line->size;
+        f.size = 0;
+        return f;
+    }
+
+    start = (idx == 0) ? 0 : line->field_offsets[idx - 1] + 1;
+    f.str = line->src + start;
+    f.size = line->field_offsets[idx] - start;
+
+    return f;
+}
+
+static inline boolean
+c2b_parse_uint64(c2b_field_t f, uint64_t *val)
+{
+    const char *s = f.str;
+    const char *end = f.str + f.size;
+    uint64_t digits = 0;
+    uint64_t digit = 0;
+
+    /* 
+       Reads an unsigned decimal number straight from the field. Anything 
+       other than one or more digits, or a value that does not fit in 64 
+       bits, is rejected.
+    */
+
+    *val = 0;
+    if (f.size <= 0)
+        return kFalse;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    /* 
+       Long numbers are read eight digits at a time: the bytes are checked 
+       and combined as one 64-bit word, with the first digit in its lowest
+       byte
+    */
+
+    while (end - s >= 8) {
+        memcpy(&digits, s, sizeof(digits));
+        if (((digits & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL) ||
+            (((digits + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL))
+            break;
+        digits -= 0x3030303030303030ULL;
+        digits = (digits * 10) + (digits >> 8);
+        digits = (((digits & 0x000000FF000000FFULL) * 0x000F424000000064ULL) + 
+                  (((digits >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+        if (*val > (UINT64_MAX - digits) / 100000000ULL)
+            return kFalse;
+        *val = (*val * 100000000ULL) + digits;
+        s += 8;
+    }
+#endif
+
+    while (s < end) {
+        if ((*s < '0') || (*s > '9'))
+            return kFalse;
+        digit = (uint64_t) (*s - '0');
+        if (*val > (UINT64_MAX - digit) / 10)
+            return kFalse;
+        *val = (*val * 10) + digit;
+        s++;
+    }
+
+    return kTrue;
+}
+
+static inline uint64_t
+c2b_field_to_uint64(c2b_field_t f, const char *description)
+{
+    uint64_t val = 0;
+
+    if (!c2b_parse_uint64(f, &val)) {
+        fprintf(stderr, "Error: Invalid %s [%.*s] -- input file may not match input format\n", description, (int) f.size, f.str);
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
+    }
+
+    return val;
+}
+
+static inline boolean
+c2b_field_equals(c2b_field_t f, const char *s)
+{
+    return ((f.size == (ssize_t) strlen(s)) && (memcmp(f.str, s, f.size) == 0)) ? kTrue : kFalse;
+}
+
+static const char *
+c2b_field_find(c2b_field_t f, const char *s)
+{
+    return memmem(f.str, f.size, s, strlen(s));
+}
+
+static inline void
+c2b_convert_block(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block, void (*line_converter)(c2b_context_t *, c2b_batch_t *, c2b_line_t *))
+{
+    ssize_t line_idx = 0;
+
+    /* 
+       This is inlined into each format's block converter, so the line 
+       converter is called directly rather than through a pointer
+    */
+
+    for (line_idx = 0; line_idx < block->num_lines; line_idx++) {
+        c2b_reset_fields(ctx);
+        line_converter(ctx, dest, &block->lines[line_idx]);
+        if ((dest->output) && (dest->len + dest->view_bytes >= dest->flush_size))
+            c2b_batch_flush(dest);
+    }
+}
+
+static void
+c2b_init_batch(c2b_batch_t *b, ssize_t capacity, ssize_t flush_size, c2b_output_t *output)
+{
+    b->buf = malloc(capacity);
+    if (!b->buf) {
+        fprintf(stderr, "Error: Could not allocate space for output batch buffer.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    b->len = 0;
+    b->capacity = capacity;
+    b->flush_size = flush_size;
+    b->output = output;
+    b->views = NULL;
+    b->num_views = 0;
+    b->views_capacity = 0;
+    b->viewed_len = 0;
+    b->view_bytes = 0;
+}
+
+static void
+c2b_batch_init_views(c2b_batch_t *b)
+{
+    b->views = malloc(C2B_MAX_IOVECS_VALUE * sizeof(c2b_field_t));
+    if (!b->views) {
+        fprintf(stderr, "Error: Could not allocate space for output batch views.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    b->views_capacity = C2B_MAX_IOVECS_VALUE;
+}
+
+static void
+c2b_delete_batch(c2b_batch_t *b)
+{
+    c2b_batch_flush(b);
+    free(b->buf), b->buf = NULL;
+    if (b->views)
+        free(b->views), b->views = NULL;
+    b->len = 0;
+    b->capacity = 0;
+    b->views_capacity = 0;
+}
+
+static inline void
+c2b_batch_reset(c2b_batch_t *b)
+{
+    b->len = 0;
+    b->num_views = 0;
+    b->viewed_len = 0;
+    b->view_bytes = 0;
+}
+
+static void
+c2b_batch_reserve(c2b_batch_t *b, ssize_t size)
+{
+    if (b->len + size <= b->capacity)
+        return;
+
+    c2b_grow_buffer(&b->buf, &b->capacity, b->len + size, "output batch buffer");
+}
+
+static inline void
+c2b_batch_append(c2b_batch_t *b, const char *src, ssize_t src_size)
+{
+    c2b_batch_reserve(b, src_size);
+    memcpy(b->buf + b->len, src, src_size);
+    b->len += src_size;
+}
+
+static void
+c2b_batch_push_view(c2b_batch_t *b, const char *str, ssize_t size)
+{
+    c2b_field_t *views = NULL;
+
+    /* 
+       Bytes appended to buf since the last view are recorded first, so that
+       the views stay in output order
+    */
+
+    if (b->num_views + 2 > b->views_capacity) {
+        views = realloc(b->views, 2 * b->views_capacity * sizeof(c2b_field_t));
+        if (!views) {
+            fprintf(stderr, "Error: Could not allocate space for output batch views.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+        b->views = views;
+        b->views_capacity *= 2;
+    }
+
+    if (b->len > b->viewed_len) {
+        b->views[b->num_views].str = NULL;
+        b->views[b->num_views].size = b->len - b->viewed_len;
+        b->num_views++;
+        b->viewed_len = b->len;
+    }
+
+    b->views[b->num_views].str = str;
+    b->views[b->num_views].size = size;
+    b->num_views++;
+    b->view_bytes += size;
+}
+
+static inline void
+c2b_batch_append_view(c2b_batch_t *b, const char *str, ssize_t size)
+{
+    c2b_field_t *last_view = NULL;
+
+    /* 
+       Source bytes are referenced rather than copied when the batch gathers
+       views and the run is long enough to be worth an iovec, or when it 
+       carries straight on from the previous view
+    */
+
+    if (b->views) {
+        last_view = (b->num_views > 0) ? &b->views[b->num_views - 1] : NULL;
+        if ((last_view) && (last_view->str) && (last_view->str + last_view->size == str) && (b->viewed_len == b->len)) {
+            last_view->size += size;
+            b->view_bytes += size;
+            return;
+        }
+        if (size >= C2B_MIN_BATCH_VIEW_SIZE_VALUE) {
+            c2b_batch_push_view(b, str, size);
+            return;
+        }
+    }
+
+    c2b_batch_append(b, str, size);
+}
+
+static inline void
+c2b_batch_append_field(c2b_batch_t *b, c2b_field_t f, char delim)
+{
+    if ((b->views) && (f.size >= C2B_MIN_BATCH_VIEW_SIZE_VALUE)) {
+        c2b_batch_push_view(b, f.str, f.size);
+        c2b_batch_append(b, &delim, 1);
+        return;
+    }
+
+    c2b_batch_reserve(b, f.size + 1);
+    memcpy(b->buf + b->len, f.str, f.size);
+    b->len += f.size;
+    b->buf[b->len++] = delim;
+}
+
+static inline void
+c2b_batch_append_str(c2b_batch_t *b, const char *s, char delim)
+{
+    c2b_field_t f;
+
+    f.str = s;
+    f.size = strlen(s);
+    c2b_batch_append_field(b, f, delim);
+}
+
+static inline void
+c2b_batch_append_uint64(c2b_batch_t *b, uint64_t val, char delim)
+{
+    static const char digit_pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    char digits[C2B_MAX_UINT64_DIGITS_VALUE];
+    char *curr = digits + C2B_MAX_UINT64_DIGITS_VALUE;
+    unsigned int pair = 0;
+    ssize_t size = 0;
+
+    /* 
+       Digits are written back-to-front two at a time from a lookup table,
+       which gives the same text as printf("%" PRIu64) without its parsing
+       and locale overhead
+    */
+
+    while (val >= 100) {
+        pair = (unsigned int) (val % 100) * 2;
+        val /= 100;
+        *--curr = digit_pairs[pair + 1];
+        *--curr = digit_pairs[pair];
+    }
+    if (val >= 10) {
+        pair = (unsigned int) val * 2;
+        *--curr = digit_pairs[pair + 1];
+        *--curr = digit_pairs[pair];
+    }
+    else {
+        *--curr = (char) ('0' + val);
+    }
+
+    size = digits + C2B_MAX_UINT64_DIGITS_VALUE - curr;
+    c2b_batch_reserve(b, size + 1);
+    memcpy(b->buf + b->len, curr, size);
+    b->len += size;
+    b->buf[b->len++] = delim;
+}
+
+static inline void
+c2b_batch_append_int(c2b_batch_t *b, int val, char delim)
+{
+    if (val < 0) {
+        c2b_batch_append(b, "-", 1);
+        c2b_batch_append_uint64(b, (uint64_t) -((int64_t) val), delim);
+    }
+    else {
+        c2b_batch_append_uint64(b, (uint64_t) val, delim);
+    }
+}
+
+#ifdef C2B_HAVE_LOOP_UNROLL
+static inline void c2b_batch_append_record(c2b_batch_t *b, const void *record, const c2b_column_t *columns, size_t num_columns) __attribute__ ((always_inline));
+#endif
+
+static inline void
+c2b_batch_append_record(c2b_batch_t *b, const void *record, const c2b_column_t *columns, size_t num_columns)
+{
+    const char *base = (const char *) record;
+    const c2b_column_t *column = NULL;
+    c2b_field_t field;
+    c2b_field_t run;
+    boolean has_run = kFalse;
+    boolean is_last = kFalse;
+    ssize_t block = 0;
+    size_t column_idx = 0;
+    char delim = '\t';
+
+    /* 
+       This is inlined into each format's writer with a constant schema, so 
+       the loop is unrolled and the kind of each column is resolved at compile
+       time. Adjacent views are held back as a run until a column that does 
+       not extend it comes along.
+    */
+
+    run.str = NULL;
+    run.size = 0;
+
+#ifdef C2B_HAVE_LOOP_UNROLL
+#pragma GCC unroll 32
+#endif
+    for (column_idx = 0; column_idx < num_columns; column_idx++) {
+        column = &columns[column_idx];
+        if ((column->is_optional) && (((const c2b_field_t *) (base + column->offset))->size == 0))
+            break;
+        is_last = ((column_idx + 1 == num_columns) || 
+                   ((columns[column_idx + 1].is_optional) && (((const c2b_field_t *) (base + columns[column_idx + 1].offset))->size == 0)));
+
+        if (column->kind == FIELD_COLUMN) {
+            field = *(const c2b_field_t *) (base + column->offset);
+            if ((has_run) && (column->follows_previous) && (run.str + run.size + 1 == field.str)) {
+                run.size += field.size + 1;
+            }
+            else {
+                if (has_run)
+                    c2b_batch_append_field(b, run, '\t');
+                run = field;
+                has_run = kTrue;
+            }
+            if (is_last)
+                c2b_batch_append_field(b, run, '\n');
+            continue;
+        }
+
+        if (has_run) {
+            c2b_batch_append_field(b, run, '\t');
+            has_run = kFalse;
+        }
+        delim = (is_last) ? '\n' : '\t';
+
+        switch (column->kind) {
+            case UINT64_COLUMN:
+                c2b_batch_append_uint64(b, *(const uint64_t *) (base + column->offset), delim);
+                break;
+            case INT_COLUMN:
+                c2b_batch_append_int(b, *(const int *) (base + column->offset), delim);
+                break;
+            case NAMED_BLOCK_COLUMN:
+                field = *(const c2b_field_t *) (base + column->offset);
+                block = *(const ssize_t *) (base + column->block_offset);
+                if (block > 0) {
+                    c2b_batch_append(b, field.str, field.size);
+                    c2b_batch_append(b, "/", 1);
+                    c2b_batch_append_uint64(b, (uint64_t) block, delim);
+                }
+                else {
+                    c2b_batch_append_field(b, field, delim);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void
+c2b_batch_append_header_line(c2b_batch_t *b, unsigned int line_idx, const char *id, const char *src, ssize_t src_size)
+{
+    /* 
+       Header lines are kept as pseudo-BED elements on the header chromosome, 
+       with an optional ID column ahead of the original line
+    */
+
+    c2b_batch_append_str(b, c2b_header_chr_name, '\t');
+    c2b_batch_append_uint64(b, line_idx, '\t');
+    c2b_batch_append_uint64(b, (uint64_t) (line_idx + 1), '\t');
+    if (id)
+        c2b_batch_append_str(b, id, '\t');
+    c2b_batch_append(b, src, src_size);
+    c2b_batch_append(b, "\n", 1);
+}
+
+static void
+c2b_batch_printf(c2b_batch_t *b, const char *format, ...)
+{
+    va_list args;
+    int printed = 0;
+
+    /* 
+       Most records fit in the space left over; if not, the batch is grown
+       to fit the record and it is printed again
+    */
+
+    va_start(args, format);
+    printed = vsnprintf(b->buf + b->len, b->capacity - b->len, format, args);
+    va_end(args);
+
+    if (printed < 0) {
+        fprintf(stderr, "Error: Could not format converted record.\n");
+        c2b_print_usage(stderr);
+        exit(EINVAL); /* Invalid argument (POSIX.1) */
+    }
+
+    if (printed >= b->capacity - b->len) {
+        c2b_batch_reserve(b, printed + 1);
+        va_start(args, format);
+        vsnprintf(b->buf + b->len, b->capacity - b->len, format, args);
+        va_end(args);
+    }
+
+    b->len += printed;
+}
+
+static void
+c2b_batch_flush(c2b_batch_t *b)
+{
+    if ((!b->output) || ((b->len == 0) && (b->num_views == 0)))
+        return;
+
+    if (b->num_views > 0)
+        c2b_output_write_batch(b->output, b);
+    else
+        c2b_output_write(b->output, b->buf, b->len);
+    c2b_batch_reset(b);
+}
+
+static void
+c2b_process_bytes_by_lines(int src_fd, int dest_fd, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), c2b_sorter_t *sorter)
+{
+    char *src_buffer = NULL;
+    ssize_t src_buffer_size = c2b_globals.io_buffer_size;
+    ssize_t src_bytes_read = 0;
+    ssize_t remainder_length = 0;
+    ssize_t remainder_offset = 0;
+    char line_delim = '\n';
+    char *src_lines = NULL;
+    ssize_t src_lines_size = 0;
+    c2b_input_t input;
+    c2b_output_t output;
+    c2b_batch_t dest;
+    c2b_block_t block;
+    c2b_context_t ctx;
+
+    if (c2b_chunk_engine_is_enabled()) {
+        c2b_process_bytes_by_chunks(src_fd, dest_fd, block_converter, sorter);
+        return;
+    }
+
+#ifdef DEBUG
+    fprintf(stderr, "\t-> c2b_process_bytes_by_lines | reading from fd  (%02d) | writing to fd  (%02d)\n", src_fd, dest_fd);
+#endif
+
+    /* 
+       We read from the src descriptor, then write to the dest descriptor. 
+       Translated lines collect in an output batch, which is written out in 
+       writes of about --io-buffer bytes, however many reads that takes. If
+       output is sorted, the batch is written to the sorter instead.
+    */
+
+    c2b_init_output(&output, dest_fd);
+    output.sorter = sorter;
+    c2b_init_batch(&dest, c2b_globals.io_buffer_size + C2B_IO_BUFFER_MIN_VALUE, c2b_globals.io_buffer_size, &output);
+    if (!output.ring)
+        c2b_batch_init_views(&dest);
+    c2b_init_block(&block);
+    c2b_init_context(&ctx, &c2b_globals.converter_options);
+
+    /* 
+       If stdin is mapped, lines are tokenized straight out of the mapping, one
+       line-aligned window at a time, and there is no remainder to carry over
+    */
+
+    if ((src_fd == STDIN_FILENO) && (c2b_globals.src_map)) {
+        while ((src_lines = c2b_next_mapped_lines(&src_lines_size, src_buffer_size)) != NULL) {
+            c2b_process_lines(&ctx, &dest, &block, src_lines, src_lines_size, block_converter);
+        }
+        c2b_delete_context(&ctx);
+        c2b_delete_block(&block);
+        c2b_delete_batch(&dest);
+        c2b_delete_output(&output);
+        return;
+    }
+    
+    src_buffer = malloc(src_buffer_size);
+    if (!src_buffer) {
+        fprintf(stderr, "Error: Could not allocate space for intermediate source buffer.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+
+    c2b_init_input(&input, src_fd);
+
+    while ((src_bytes_read = c2b_input_read(&input,
+                                            src_buffer + remainder_length,
+                                            src_buffer_size - remainder_length)) > 0) {
+
+        /* 
+           So here's what src_buffer looks like initially; basically, some stuff separated by
+           newlines. The src_buffer will probably not terminate with a newline. So we first use 
+           a custom memrchr() call to find the remainder_offset index value:
+           
+           src_buffer  [  .  .  .  \n  .  .  .  \n  .  .  .  \n  .  .  .  .  .  .  ]
+           index        0 1 2 ...                            ^                    ^
+                                                             |                    |
+                                                             |   src_bytes_read --
+                                                             | 
+                                         remainder_offset --- 
+
+           In other words, everything at and after index [remainder_offset + 1] to index
+           [src_bytes_read - 1] is a remainder byte ("R"):
+
+           src_buffer  [  .  .  .  \n  .  .  .  \n  .  .  .  \n R R R R R ]
+           
+           Assuming this failed:
+
+           If remainder_offset is -1 and we have read src_buffer_size bytes, then we know there 
+           are no newlines anywhere in the src_buffer, which is too small to hold a whole line. 
+           We double the size of src_buffer and keep reading, until the line fits.
+           
+           Asumming this worked:
+           
+           We can now tokenize byte indices {[0 .. remainder_offset]} into a block of lines and
+           their tab offsets, which is handed to the block_converter. The converter writes out a 
+           reordered string for each line based on the rules for the format (see BEDOPS docs 
+           for reordering table).
+           
+           Finally, we write bytes from index [remainder_offset + 1] to [src_bytes_read - 1] 
+           back to src_buffer. We are writing remainder_length bytes:
+           
+           new_remainder_length = current_src_bytes_read + old_remainder_length - new_remainder_offset
+           
+           Note that we can leave the rest of the buffer untouched:
+           
+           src_buffer  [ R R R R R \n  .  .  .  \n  .  .  .  \n  .  .  .  ]
+           
+           On the subsequent read, we want to read() into src_buffer at position remainder_length
+           and read up to, at most, (src_buffer_size - remainder_length) bytes:
+           
+           read(byte_source, 
+                src_buffer + remainder_length,
+                src_buffer_size - remainder_length)
+
+           Second and subsequent reads should reduce the maximum number of src_bytes_read from 
+           src_buffer_size to something smaller.
+        */
+
+        c2b_memrchr_offset(&remainder_offset, src_buffer, src_buffer_size, src_bytes_read + remainder_length, line_delim);
+
+        if (remainder_offset == -1) {
+            if (src_bytes_read + remainder_length == src_buffer_size) {
+                remainder_length = src_buffer_size;
+                c2b_grow_buffer(&src_buffer, &src_buffer_size, 2 * src_buffer_size, "intermediate source buffer");
+                continue;
+            }
+            remainder_offset = 0;
+        }
+
+        /* 
+           We next want to process bytes from index [0] to index [remainder_offset - 1] for all
+           lines contained within. Translated lines are appended to the output batch, which
+           is written to the destination (the in-pipe of the next stage, or stdout when the 
+           pipeline is fused) whenever it fills past its flush size.
+        */
+
+        c2b_process_lines(&ctx, &dest, &block, src_buffer, remainder_offset, block_converter);
+
+        /* 
+           The batch may still point into src_buffer, so it is written out 
+           before the remainder is moved over the lines it came from
+        */
+
+        if (dest.num_views > 0)
+            c2b_batch_flush(&dest);
+
+        remainder_length = src_bytes_read + remainder_length - remainder_offset;
+        memmove(src_buffer, src_buffer + remainder_offset, remainder_length);
+    }
+
+    c2b_delete_input(&input);
+    c2b_delete_context(&ctx);
+    c2b_delete_block(&block);
+    c2b_delete_batch(&dest);
+    c2b_delete_output(&output);
+
+    if (src_buffer) 
+        free(src_buffer), src_buffer = NULL;
+}
+
+static void *
+c2b_process_intermediate_bytes_by_lines_to_stdout(void *arg)
+{
+    c2b_pipeline_stage_t *stage = (c2b_pipeline_stage_t *) arg;
+    c2b_pipeset_t *pipes = stage->pipeset;
+    int src_fd = (stage->src == (unsigned int) -1) ? STDIN_FILENO : pipes->out[stage->src][PIPE_READ];
+    int exit_status = 0;
+
+    /* 
+       Converted lines go straight to stdout, or through the sorter to stdout, 
+       so no relay stage is needed to drain an intermediate pipe
+    */
+
+    c2b_process_bytes_by_lines(src_fd,
+                               STDOUT_FILENO,
+                               stage->block_converter,
+                               stage->sorter);
+
+    if (stage->sorter)
+        c2b_sorter_write_out(stage->sorter, STDOUT_FILENO);
 
     if (WIFEXITED(stage->status) || WIFSIGNALED(stage->status)) {
         waitpid(stage->pid, &stage->status, WUNTRACED);
@@ -3806,85 +3269,2348 @@ c2b_write_out_bytes_to_in_process(void *arg)
                     exit_status);
     }
 
-    pthread_exit(NULL);
+    pthread_exit(NULL);
+}
+
+static boolean
+c2b_chunk_engine_is_enabled()
+{
+    if (c2b_globals.num_threads < 2)
+        return kFalse;
+
+    /* 
+       Header lines are numbered as they are seen, and the GTF, PSL, RepeatMasker
+       and WIG functors carry state from one line to the next, so these lines
+       must be converted in order on a single thread
+    */
+
+    if (c2b_globals.keep_header_flag)
+        return kFalse;
+
+    switch (c2b_globals.input_format_idx) {
+        case GTF_FORMAT:
+        case PSL_FORMAT:
+        case RMSK_FORMAT:
+        case WIG_FORMAT:
+            return kFalse;
+        default:
+            break;
+    }
+
+    return kTrue;
+}
+
+static void
+c2b_process_bytes_by_chunks(int src_fd, int dest_fd, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), c2b_sorter_t *sorter)
+{
+    c2b_chunk_engine_t engine;
+    pthread_t reader_thread;
+    pthread_t *worker_threads = NULL;
+    c2b_chunk_t *chunk = NULL;
+    size_t chunk_idx = 0;
+    size_t worker_idx = 0;
+    size_t written = 0;
+    c2b_output_t output;
+
+#ifdef DEBUG
+    fprintf(stderr, "\t-> c2b_process_bytes_by_chunks | reading from fd  (%02d) | writing to fd  (%02d) | threads (%u)\n", src_fd, dest_fd, c2b_globals.num_threads);
+#endif
+
+    engine.is_mapped = ((src_fd == STDIN_FILENO) && (c2b_globals.src_map)) ? kTrue : kFalse;
+    engine.num_chunks = c2b_globals.num_threads * C2B_CHUNKS_PER_THREAD_VALUE;
+    engine.chunks = malloc(engine.num_chunks * sizeof(c2b_chunk_t));
+    if (!engine.chunks) {
+        fprintf(stderr, "Error: Could not allocate space for conversion chunks.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    for (chunk_idx = 0; chunk_idx < engine.num_chunks; chunk_idx++) {
+        chunk = &engine.chunks[chunk_idx];
+        chunk->src_buf = (engine.is_mapped) ? NULL : malloc(C2B_IO_BUFFER_MIN_VALUE);
+        chunk->src_capacity = (engine.is_mapped) ? 0 : C2B_IO_BUFFER_MIN_VALUE;
+        chunk->src = chunk->src_buf;
+        c2b_init_batch(&chunk->dest, 2 * C2B_IO_BUFFER_MIN_VALUE, 2 * C2B_IO_BUFFER_MIN_VALUE, NULL);
+        c2b_batch_init_views(&chunk->dest);
+        if ((!chunk->src_buf) && (!engine.is_mapped)) {
+            fprintf(stderr, "Error: Could not allocate space for conversion chunk buffers.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+        chunk->src_len = 0;
+        chunk->state = CHUNK_FREE;
+    }
+    engine.num_read = 0;
+    engine.num_claimed = 0;
+    engine.is_eof = kFalse;
+    engine.src_fd = src_fd;
+    engine.block_converter = block_converter;
+    pthread_mutex_init(&engine.lock, NULL);
+    pthread_cond_init(&engine.ready, NULL);
+    pthread_cond_init(&engine.done, NULL);
+    pthread_cond_init(&engine.freed, NULL);
+
+    worker_threads = malloc(c2b_globals.num_threads * sizeof(pthread_t));
+    if (!worker_threads) {
+        fprintf(stderr, "Error: Could not allocate space for worker threads.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+
+    pthread_create(&reader_thread, NULL, c2b_chunk_engine_read, &engine);
+    for (worker_idx = 0; worker_idx < c2b_globals.num_threads; worker_idx++) {
+        pthread_create(&worker_threads[worker_idx], NULL, c2b_chunk_engine_convert, &engine);
+    }
+
+    /* 
+       The calling thread is the sequencer: it writes chunks out strictly in 
+       the order they were read, whichever worker finishes first
+    */
+
+    c2b_init_output(&output, dest_fd);
+    output.sorter = sorter;
+
+    pthread_mutex_lock(&engine.lock);
+    for (;;) {
+        chunk = &engine.chunks[written % engine.num_chunks];
+        while ((chunk->state != CHUNK_DONE) && !((engine.is_eof) && (written == engine.num_read))) {
+            pthread_cond_wait(&engine.done, &engine.lock);
+        }
+        if (chunk->state != CHUNK_DONE) {
+            break;
+        }
+        pthread_mutex_unlock(&engine.lock);
+
+        c2b_output_write_batch(&output, &chunk->dest);
+
+        pthread_mutex_lock(&engine.lock);
+        chunk->state = CHUNK_FREE;
+        written++;
+        pthread_cond_signal(&engine.freed);
+    }
+    pthread_mutex_unlock(&engine.lock);
+
+    c2b_delete_output(&output);
+
+    pthread_join(reader_thread, (void **) NULL);
+    for (worker_idx = 0; worker_idx < c2b_globals.num_threads; worker_idx++) {
+        pthread_join(worker_threads[worker_idx], (void **) NULL);
+    }
+    free(worker_threads), worker_threads = NULL;
+
+    pthread_mutex_destroy(&engine.lock);
+    pthread_cond_destroy(&engine.ready);
+    pthread_cond_destroy(&engine.done);
+    pthread_cond_destroy(&engine.freed);
+    for (chunk_idx = 0; chunk_idx < engine.num_chunks; chunk_idx++) {
+        if (engine.chunks[chunk_idx].src_buf)
+            free(engine.chunks[chunk_idx].src_buf), engine.chunks[chunk_idx].src_buf = NULL;
+        c2b_delete_batch(&engine.chunks[chunk_idx].dest);
+    }
+    free(engine.chunks), engine.chunks = NULL;
+}
+
+static void *
+c2b_chunk_engine_read(void *arg)
+{
+    c2b_chunk_engine_t *engine = (c2b_chunk_engine_t *) arg;
+    c2b_chunk_t *chunk = NULL;
+    char *remainder = NULL;
+    ssize_t remainder_capacity = C2B_IO_BUFFER_MIN_VALUE;
+    ssize_t remainder_length = 0;
+    ssize_t remainder_offset = 0;
+    ssize_t src_bytes_read = 0;
+    ssize_t chunk_bytes = 0;
+    boolean is_eof = kFalse;
+    c2b_input_t input;
+
+    remainder = malloc(remainder_capacity);
+    if (!remainder) {
+        fprintf(stderr, "Error: Could not allocate space for chunk remainder buffer.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+
+    /* 
+       As with the single-threaded reader, a full chunk without a newline is
+       grown until it holds a whole line, and a trailing partial line at EOF 
+       is dropped. Mapped input needs no remainder buffer, as each chunk 
+       points at a window of the mapping.
+    */
+
+    c2b_init_input(&input, engine->src_fd);
+
+    while (!is_eof) {
+        chunk = &engine->chunks[engine->num_read % engine->num_chunks];
+        pthread_mutex_lock(&engine->lock);
+        while (chunk->state != CHUNK_FREE) {
+            pthread_cond_wait(&engine->freed, &engine->lock);
+        }
+        pthread_mutex_unlock(&engine->lock);
+
+        if (engine->is_mapped) {
+            if ((chunk->src = c2b_next_mapped_lines(&chunk->src_len, C2B_IO_BUFFER_MIN_VALUE)) == NULL)
+                break;
+            pthread_mutex_lock(&engine->lock);
+            chunk->state = CHUNK_READY;
+            engine->num_read++;
+            pthread_cond_signal(&engine->ready);
+            pthread_mutex_unlock(&engine->lock);
+            continue;
+        }
+
+        c2b_grow_buffer(&chunk->src_buf, &chunk->src_capacity, remainder_length, "conversion chunk buffer");
+        chunk->src = chunk->src_buf;
+        memcpy(chunk->src, remainder, remainder_length);
+        chunk_bytes = remainder_length;
+        for (;;) {
+            while (chunk_bytes < chunk->src_capacity) {
+                src_bytes_read = c2b_input_read(&input, chunk->src + chunk_bytes, chunk->src_capacity - chunk_bytes);
+                if (src_bytes_read <= 0) {
+                    is_eof = kTrue;
+                    break;
+                }
+                chunk_bytes += src_bytes_read;
+            }
+            c2b_memrchr_offset(&remainder_offset, chunk->src, chunk->src_capacity, chunk_bytes, '\n');
+            if ((remainder_offset != -1) || (is_eof))
+                break;
+            c2b_grow_buffer(&chunk->src_buf, &chunk->src_capacity, 2 * chunk->src_capacity, "conversion chunk buffer");
+            chunk->src = chunk->src_buf;
+        }
+
+        if (remainder_offset == -1) {
+            break;
+        }
+
+        remainder_length = chunk_bytes - remainder_offset;
+        c2b_grow_buffer(&remainder, &remainder_capacity, remainder_length, "chunk remainder buffer");
+        memcpy(remainder, chunk->src + remainder_offset, remainder_length);
+        chunk->src_len = remainder_offset;
+
+        pthread_mutex_lock(&engine->lock);
+        chunk->state = CHUNK_READY;
+        engine->num_read++;
+        pthread_cond_signal(&engine->ready);
+        pthread_mutex_unlock(&engine->lock);
+    }
+
+    pthread_mutex_lock(&engine->lock);
+    engine->is_eof = kTrue;
+    pthread_cond_broadcast(&engine->ready);
+    pthread_cond_broadcast(&engine->done);
+    pthread_mutex_unlock(&engine->lock);
+
+    c2b_delete_input(&input);
+    free(remainder), remainder = NULL;
+
+    pthread_exit(NULL);
+}
+
+static void *
+c2b_chunk_engine_convert(void *arg)
+{
+    c2b_chunk_engine_t *engine = (c2b_chunk_engine_t *) arg;
+    c2b_chunk_t *chunk = NULL;
+    c2b_context_t ctx;
+    c2b_block_t block;
+
+    c2b_init_context(&ctx, &c2b_globals.converter_options);
+    c2b_init_block(&block);
+
+    pthread_mutex_lock(&engine->lock);
+    for (;;) {
+        while ((engine->num_claimed == engine->num_read) && (!engine->is_eof)) {
+            pthread_cond_wait(&engine->ready, &engine->lock);
+        }
+        if (engine->num_claimed == engine->num_read) {
+            break;
+        }
+        chunk = &engine->chunks[engine->num_claimed % engine->num_chunks];
+        engine->num_claimed++;
+        pthread_mutex_unlock(&engine->lock);
+
+        c2b_batch_reset(&chunk->dest);
+        c2b_process_lines(&ctx, &chunk->dest, &block, chunk->src, chunk->src_len, engine->block_converter);
+
+        pthread_mutex_lock(&engine->lock);
+        chunk->state = CHUNK_DONE;
+        pthread_cond_broadcast(&engine->done);
+    }
+    pthread_mutex_unlock(&engine->lock);
+
+    c2b_delete_block(&block);
+    c2b_delete_context(&ctx);
+
+    pthread_exit(NULL);
+}
+
+static void
+c2b_relay_bytes(int src_fd, int dest_fd)
+{
+    char *buffer = NULL;
+    ssize_t bytes_read = 0;
+
+#ifdef C2B_HAVE_SPLICE
+    ssize_t bytes_spliced = 0;
+
+    /* 
+       At least one end of every relay is a pipe, so on Linux we can move pages
+       from one descriptor to the other inside the kernel. A failed splice()
+       moves nothing, so if the other end does not support it (a terminal, or 
+       a file opened for appending, for instance) we simply carry on with 
+       read() and write() below.
+    */
+
+    do {
+        bytes_spliced = splice(src_fd, NULL, dest_fd, NULL, c2b_globals.io_buffer_size, SPLICE_F_MOVE);
+    } while ((bytes_spliced > 0) || ((bytes_spliced == -1) && (errno == EINTR)));
+
+    if (bytes_spliced == 0)
+        return;
+#endif
+
+    buffer = malloc(c2b_globals.io_buffer_size);
+    if (!buffer) {
+        fprintf(stderr, "Error: Could not allocate space for relay buffer.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+    while ((bytes_read = read(src_fd, buffer, c2b_globals.io_buffer_size)) > 0) {
+        write(dest_fd, buffer, bytes_read);
+    }
+#pragma GCC diagnostic pop
+
+    free(buffer), buffer = NULL;
+}
+
+static void
+c2b_init_sorter(c2b_sorter_t *s)
+{
+    s->buckets = NULL;
+    s->num_buckets = 0;
+    s->buckets_capacity = 0;
+    s->last_bucket_idx = 0;
+    s->slots = NULL;
+    s->slots_capacity = 0;
+    s->order = NULL;
+    s->num_ordered = 0;
+    s->next_claimed = 0;
+    s->workers = NULL;
+    s->num_workers = 0;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->sorted, NULL);
+    s->pending = NULL;
+    s->pending_len = 0;
+    s->pending_capacity = 0;
+    s->mem_used = 0;
+    s->max_mem = c2b_globals.sort->max_mem;
+    s->spill_fd = -1;
+    s->spill_len = 0;
+    s->sort_order = c2b_globals.sort->order;
+    s->num_ranked = 0;
+    s->is_starch = (c2b_globals.output_format_idx == STARCH_FORMAT) ? kTrue : kFalse;
+    s->is_final = kFalse;
+
+    s->tmpdir = c2b_globals.sort->sort_tmpdir_path;
+    if (!s->tmpdir)
+        s->tmpdir = getenv("TMPDIR");
+    if ((!s->tmpdir) || (*s->tmpdir == '\0'))
+        s->tmpdir = c2b_sort_tmpdir_default;
+
+    /* header lines kept with --keep-header lead the output, as they do in sort-bed order */
+    if (s->sort_order == HEADER_SORT_ORDER)
+        c2b_sorter_rank_chromosome(s, c2b_header_chr_name, strlen(c2b_header_chr_name));
+}
+
+static void
+c2b_delete_sorter(c2b_sorter_t *s)
+{
+    c2b_sort_bucket_t *b = NULL;
+    size_t bucket_idx = 0;
+
+    for (bucket_idx = 0; bucket_idx < s->num_buckets; bucket_idx++) {
+        b = &s->buckets[bucket_idx];
+        free(b->chr), b->chr = NULL;
+        if (b->arena)
+            free(b->arena), b->arena = NULL;
+        if (b->keys)
+            free(b->keys), b->keys = NULL;
+        if (b->spare_keys)
+            free(b->spare_keys), b->spare_keys = NULL;
+        if (b->segments)
+            free(b->segments), b->segments = NULL;
+        if (b->last_line)
+            free(b->last_line), b->last_line = NULL;
+        if (b->starch) {
+            c2b_delete_starch_stream(b->starch);
+            free(b->starch), b->starch = NULL;
+        }
+    }
+    if (s->buckets)
+        free(s->buckets), s->buckets = NULL;
+    if (s->slots)
+        free(s->slots), s->slots = NULL;
+    if (s->order)
+        free(s->order), s->order = NULL;
+    if (s->pending)
+        free(s->pending), s->pending = NULL;
+    if (s->spill_fd != -1)
+        close(s->spill_fd), s->spill_fd = -1;
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->sorted);
+    s->num_buckets = 0;
+    s->buckets_capacity = 0;
+    s->slots_capacity = 0;
+}
+
+static void
+c2b_sorter_append(c2b_sorter_t *s, const char *buf, size_t len)
+{
+    const char *end = buf + len;
+    const char *newline = NULL;
+    size_t line_len = 0;
+
+    /* 
+       Batches hold whole lines, as a rule; should one end partway through a
+       line, that line waits in the pending buffer for the rest of its bytes
+    */
+
+    if (s->pending_len > 0) {
+        newline = memchr(buf, c2b_line_delim, len);
+        line_len = (newline) ? (size_t) (newline - buf + 1) : len;
+        if (s->pending_len + (ssize_t) line_len > s->pending_capacity)
+            c2b_grow_buffer(&s->pending, &s->pending_capacity, 2 * (s->pending_len + line_len), "pending sort line");
+        memcpy(s->pending + s->pending_len, buf, line_len);
+        s->pending_len += line_len;
+        buf += line_len;
+        if (!newline)
+            return;
+        c2b_sorter_add_line(s, s->pending, s->pending_len);
+        s->pending_len = 0;
+    }
+
+    while ((newline = memchr(buf, c2b_line_delim, end - buf)) != NULL) {
+        c2b_sorter_add_line(s, buf, newline - buf + 1);
+        buf = newline + 1;
+    }
+
+    if (buf < end) {
+        if (end - buf > s->pending_capacity)
+            c2b_grow_buffer(&s->pending, &s->pending_capacity, 2 * (end - buf), "pending sort line");
+        memcpy(s->pending, buf, end - buf);
+        s->pending_len = end - buf;
+    }
+}
+
+static inline void
+c2b_sorter_add_line(c2b_sorter_t *s, const char *line, size_t len)
+{
+    c2b_sort_key_t key;
+    c2b_sort_bucket_t *b = NULL;
+    size_t line_mem = len + 2 * sizeof(c2b_sort_key_t);
+
+    if ((s->sort_order == HEADER_SORT_ORDER) && ((line[0] == c2b_sam_header_prefix) || (line[0] == c2b_vcf_header_prefix))) {
+        c2b_sorter_add_header_line(s, line, len);
+        return;
+    }
+
+    if ((s->mem_used > 0) && (s->mem_used + line_mem > s->max_mem))
+        c2b_sorter_spill(s);
+
+    c2b_sort_key_line(&key, line, len);
+    b = c2b_sorter_find_bucket(s, line, key.chr_len);
+
+    /* a bucket stays ordered for as long as each line sorts no earlier than the last */
+    if (b->is_ordered) {
+        if (b->num_keys > 0)
+            b->is_ordered = (c2b_sort_compare(&b->keys[b->num_keys - 1], b->arena + b->keys[b->num_keys - 1].offset, &key, line) <= 0);
+        else if (b->last_key.len > 0)
+            b->is_ordered = (c2b_sort_compare(&b->last_key, b->last_line, &key, line) <= 0);
+#ifdef DEBUG
+        if (!b->is_ordered)
+            fprintf(stderr, "Debug: Chromosome [%s] is out of order; sorting it in full\n", b->chr);
+#endif
+    }
+
+    if (b->arena_len + len > b->arena_capacity)
+        c2b_sort_bucket_grow_arena(b, len);
+    if (b->num_keys == b->keys_capacity)
+        c2b_sort_bucket_grow_keys(b);
+
+    memcpy(b->arena + b->arena_len, line, len);
+    key.offset = b->arena_len;
+    b->keys[b->num_keys++] = key;
+    b->arena_len += len;
+    s->mem_used += line_mem;
+}
+
+static void
+c2b_sorter_add_header_line(c2b_sorter_t *s, const char *line, size_t len)
+{
+    const char *end = line + len - 1;
+    const char *field = NULL;
+    const char *field_end = NULL;
+    size_t sq_prefix_len = strlen(c2b_sam_sq_prefix);
+    size_t sq_name_prefix_len = strlen(c2b_sam_sq_name_prefix);
+    size_t contig_prefix_len = strlen(c2b_vcf_contig_prefix);
+    size_t contig_id_prefix_len = strlen(c2b_vcf_contig_id_prefix);
+
+    /* 
+       SAM @SQ lines name their reference sequence in a tab-delimited SN: field, 
+       and VCF ##contig lines in an ID= item of a comma-delimited list; other
+       header lines are of no interest to the sorter, and are dropped
+    */
+
+    if ((len > sq_prefix_len) && (memcmp(line, c2b_sam_sq_prefix, sq_prefix_len) == 0)) {
+        for (field = line + sq_prefix_len; field < end; field = field_end + 1) {
+            field_end = memchr(field, c2b_tab_delim, end - field);
+            if (!field_end)
+                field_end = end;
+            if (((size_t) (field_end - field) > sq_name_prefix_len) && (memcmp(field, c2b_sam_sq_name_prefix, sq_name_prefix_len) == 0)) {
+                c2b_sorter_rank_chromosome(s, field + sq_name_prefix_len, field_end - field - sq_name_prefix_len);
+                return;
+            }
+        }
+    }
+    else if ((len > contig_prefix_len) && (memcmp(line, c2b_vcf_contig_prefix, contig_prefix_len) == 0)) {
+        for (field = line + contig_prefix_len; field < end; field = field_end + 1) {
+            for (field_end = field; (field_end < end) && (*field_end != ',') && (*field_end != c2b_vcf_id_suffix); field_end++) {}
+            if (((size_t) (field_end - field) > contig_id_prefix_len) && (memcmp(field, c2b_vcf_contig_id_prefix, contig_id_prefix_len) == 0)) {
+                c2b_sorter_rank_chromosome(s, field + contig_id_prefix_len, field_end - field - contig_id_prefix_len);
+                return;
+            }
+        }
+    }
+}
+
+static void
+c2b_sorter_rank_chromosome(c2b_sorter_t *s, const char *chr, uint32_t chr_len)
+{
+    c2b_sort_bucket_t *b = c2b_sorter_find_bucket(s, chr, chr_len);
+
+    /* a chromosome named twice keeps its first rank */
+    if (b->rank == C2B_SORT_UNRANKED_VALUE)
+        b->rank = s->num_ranked++;
+}
+
+static c2b_sort_bucket_t *
+c2b_sorter_find_bucket(c2b_sorter_t *s, const char *chr, uint32_t chr_len)
+{
+    c2b_sort_bucket_t *b = NULL;
+    uint64_t hash = UINT64_C(14695981039346656037);
+    size_t slot_idx = 0;
+    uint32_t idx = 0;
+
+    /* lines mostly come in runs on one chromosome, so the last bucket is tried first */
+    if (s->num_buckets > 0) {
+        b = &s->buckets[s->last_bucket_idx];
+        if ((b->chr_len == chr_len) && (memcmp(b->chr, chr, chr_len) == 0))
+            return b;
+    }
+
+    /* otherwise buckets are looked up by an FNV-1a hash of the name, with linear probing */
+    for (idx = 0; idx < chr_len; idx++)
+        hash = (hash ^ (unsigned char) chr[idx]) * UINT64_C(1099511628211);
+
+    if (2 * (s->num_buckets + 1) > s->slots_capacity)
+        c2b_sorter_grow_slots(s);
+
+    for (slot_idx = hash & (s->slots_capacity - 1); s->slots[slot_idx] != 0; slot_idx = (slot_idx + 1) & (s->slots_capacity - 1)) {
+        b = &s->buckets[s->slots[slot_idx] - 1];
+        if ((b->chr_len == chr_len) && (memcmp(b->chr, chr, chr_len) == 0)) {
+            s->last_bucket_idx = s->slots[slot_idx] - 1;
+            return b;
+        }
+    }
+
+    if (s->num_buckets == s->buckets_capacity) {
+        s->buckets_capacity = (s->buckets_capacity > 0) ? 2 * s->buckets_capacity : C2B_SORT_SLOTS_MIN_VALUE / 2;
+        b = realloc(s->buckets, s->buckets_capacity * sizeof(c2b_sort_bucket_t));
+        if (!b) {
+            fprintf(stderr, "Error: Could not allocate space for sort buckets.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+        s->buckets = b;
+    }
+
+    b = &s->buckets[s->num_buckets];
+    b->chr = malloc(chr_len + 1);
+    if (!b->chr) {
+        fprintf(stderr, "Error: Could not allocate space for sort bucket chromosome name.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    memcpy(b->chr, chr, chr_len);
+    b->chr[chr_len] = '\0';
+    b->chr_len = chr_len;
+    b->arena = NULL;
+    b->arena_len = 0;
+    b->arena_capacity = 0;
+    b->keys = NULL;
+    b->spare_keys = NULL;
+    b->sorted_keys = NULL;
+    b->num_keys = 0;
+    b->keys_capacity = 0;
+    b->segments = NULL;
+    b->num_segments = 0;
+    b->segments_capacity = 0;
+    b->rank = C2B_SORT_UNRANKED_VALUE;
+    b->last_key.len = 0;
+    b->last_line = NULL;
+    b->last_line_capacity = 0;
+    b->is_ordered = kTrue;
+    b->is_sorted = kFalse;
+    b->starch = NULL;
+
+    s->slots[slot_idx] = ++s->num_buckets;
+    s->last_bucket_idx = s->num_buckets - 1;
+
+    return b;
+}
+
+static void
+c2b_sorter_grow_slots(c2b_sorter_t *s)
+{
+    c2b_sort_bucket_t *b = NULL;
+    size_t bucket_idx = 0;
+    size_t slot_idx = 0;
+    uint64_t hash = 0;
+    uint32_t idx = 0;
+
+    if (s->slots)
+        free(s->slots), s->slots = NULL;
+    s->slots_capacity = (s->slots_capacity > 0) ? 2 * s->slots_capacity : C2B_SORT_SLOTS_MIN_VALUE;
+    s->slots = calloc(s->slots_capacity, sizeof(size_t));
+    if (!s->slots) {
+        fprintf(stderr, "Error: Could not allocate space for sort bucket table.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+
+    for (bucket_idx = 0; bucket_idx < s->num_buckets; bucket_idx++) {
+        b = &s->buckets[bucket_idx];
+        hash = UINT64_C(14695981039346656037);
+        for (idx = 0; idx < b->chr_len; idx++)
+            hash = (hash ^ (unsigned char) b->chr[idx]) * UINT64_C(1099511628211);
+        for (slot_idx = hash & (s->slots_capacity - 1); s->slots[slot_idx] != 0; slot_idx = (slot_idx + 1) & (s->slots_capacity - 1))
+            ;
+        s->slots[slot_idx] = bucket_idx + 1;
+    }
+}
+
+static void
+c2b_sort_bucket_grow_arena(c2b_sort_bucket_t *b, size_t len)
+{
+    char *arena = NULL;
+    size_t arena_capacity = (b->arena_capacity > 0) ? 2 * b->arena_capacity : C2B_SORT_BUCKET_ARENA_MIN_VALUE;
+
+    if (arena_capacity < b->arena_len + len)
+        arena_capacity = b->arena_len + len;
+    arena = realloc(b->arena, arena_capacity);
+    if (!arena) {
+        fprintf(stderr, "Error: Could not allocate space for sort bucket.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    b->arena = arena;
+    b->arena_capacity = arena_capacity;
+}
+
+static void
+c2b_sort_bucket_grow_keys(c2b_sort_bucket_t *b)
+{
+    c2b_sort_key_t *keys = NULL;
+    size_t keys_capacity = (b->keys_capacity > 0) ? 2 * b->keys_capacity : C2B_SORT_BUCKET_KEYS_MIN_VALUE;
+
+    /* the spare keys are scratch space for merging, so they grow alongside */
+    keys = realloc(b->keys, keys_capacity * sizeof(c2b_sort_key_t));
+    if (keys)
+        b->keys = keys;
+    keys = (keys) ? realloc(b->spare_keys, keys_capacity * sizeof(c2b_sort_key_t)) : NULL;
+    if (!keys) {
+        fprintf(stderr, "Error: Could not allocate space for sort keys.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    b->spare_keys = keys;
+    b->keys_capacity = keys_capacity;
+}
+
+static void
+c2b_sort_bucket_push_segment(c2b_sort_bucket_t *b, off_t offset, off_t size)
+{
+    c2b_sort_segment_t *segments = NULL;
+
+    if (b->num_segments == b->segments_capacity) {
+        b->segments_capacity = (b->segments_capacity > 0) ? 2 * b->segments_capacity : 4;
+        segments = realloc(b->segments, b->segments_capacity * sizeof(c2b_sort_segment_t));
+        if (!segments) {
+            fprintf(stderr, "Error: Could not allocate space for sorted segments.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+        b->segments = segments;
+    }
+    b->segments[b->num_segments].offset = offset;
+    b->segments[b->num_segments].size = size;
+    b->num_segments++;
+}
+
+static void
+c2b_sort_bucket_keep_last_line(c2b_sort_bucket_t *b)
+{
+    const c2b_sort_key_t *key = &b->keys[b->num_keys - 1];
+
+    /* an ordered bucket keeps its last line across a spill, for the next line to check against */
+    if ((ssize_t) key->len > b->last_line_capacity)
+        c2b_grow_buffer(&b->last_line, &b->last_line_capacity, 2 * key->len, "last sorted line");
+    memcpy(b->last_line, b->arena + key->offset, key->len);
+    b->last_key = *key;
+}
+
+static void
+c2b_sort_bucket_sort(c2b_sort_bucket_t *b)
+{
+    b->sorted_keys = (b->is_ordered) ? b->keys : c2b_sort_keys(b->keys, b->spare_keys, b->num_keys, b->arena);
+}
+
+static inline void
+c2b_sort_key_line(c2b_sort_key_t *key, const char *line, size_t len)
+{
+    const char *end = line + len - 1;
+    const char *tab = memchr(line, c2b_tab_delim, len - 1);
+    const char *p = NULL;
+
+    key->chr_len = (uint32_t) ((tab) ? (size_t) (tab - line) : len - 1);
+    key->len = (uint32_t) len;
+    key->start = 0;
+    key->stop = 0;
+
+    if (!tab)
+        return;
+    for (p = tab + 1; (p < end) && ((unsigned int) (*p - '0') < 10); p++)
+        key->start = 10 * key->start + (uint64_t) (*p - '0');
+    if ((p == end) || (*p != c2b_tab_delim))
+        return;
+    for (p++; (p < end) && ((unsigned int) (*p - '0') < 10); p++)
+        key->stop = 10 * key->stop + (uint64_t) (*p - '0');
+}
+
+static inline int
+c2b_sort_compare(const c2b_sort_key_t *a, const char *a_line, const c2b_sort_key_t *b, const char *b_line)
+{
+    uint32_t len = 0;
+    int cmp = 0;
+
+    /* both lines are from one bucket, so their chromosome names are the same */
+    if (a->start != b->start)
+        return (a->start < b->start) ? -1 : 1;
+    if (a->stop != b->stop)
+        return (a->stop < b->stop) ? -1 : 1;
+
+    /* ties fall back on the rest of the line, without its newline */
+    len = (a->len < b->len) ? a->len - 1 : b->len - 1;
+    cmp = memcmp(a_line + a->chr_len, b_line + b->chr_len, len - a->chr_len);
+    if (cmp != 0)
+        return cmp;
+    return (a->len == b->len) ? 0 : ((a->len < b->len) ? -1 : 1);
+}
+
+static c2b_sort_key_t *
+c2b_sort_keys(c2b_sort_key_t *keys, c2b_sort_key_t *spare_keys, size_t num_keys, const char *arena)
+{
+    c2b_sort_key_t *src = keys;
+    c2b_sort_key_t *dest = spare_keys;
+    c2b_sort_key_t *swap = NULL;
+    c2b_sort_key_t key;
+    size_t width = 0;
+    size_t lo = 0;
+    size_t mid = 0;
+    size_t hi = 0;
+    size_t left = 0;
+    size_t right = 0;
+    size_t idx = 0;
+
+    /* 
+       A stable merge sort: short runs are sorted in place by insertion, then
+       merged back and forth between the keys and the spare keys in passes
+       of doubling width. Neighbouring runs already in order are copied 
+       across whole, so input that arrives sorted costs one compare per key
+       and pass. The sorted keys are returned from whichever array they 
+       ended up in.
+    */
+
+    for (lo = 0; lo < num_keys; lo += C2B_SORT_INSERTION_RUN_VALUE) {
+        hi = (lo + C2B_SORT_INSERTION_RUN_VALUE < num_keys) ? lo + C2B_SORT_INSERTION_RUN_VALUE : num_keys;
+        for (idx = lo + 1; idx < hi; idx++) {
+            key = src[idx];
+            for (right = idx; (right > lo) && (c2b_sort_compare(&key, arena + key.offset, &src[right - 1], arena + src[right - 1].offset) < 0); right--)
+                src[right] = src[right - 1];
+            src[right] = key;
+        }
+    }
+
+    for (width = C2B_SORT_INSERTION_RUN_VALUE; width < num_keys; width *= 2) {
+        for (lo = 0; lo < num_keys; lo += 2 * width) {
+            mid = (lo + width < num_keys) ? lo + width : num_keys;
+            hi = (lo + 2 * width < num_keys) ? lo + 2 * width : num_keys;
+            if ((mid == hi) || (c2b_sort_compare(&src[mid - 1], arena + src[mid - 1].offset, &src[mid], arena + src[mid].offset) <= 0)) {
+                memcpy(dest + lo, src + lo, (hi - lo) * sizeof(c2b_sort_key_t));
+                continue;
+            }
+            for (left = lo, right = mid, idx = lo; idx < hi; idx++) {
+                if ((right == hi) || ((left < mid) && (c2b_sort_compare(&src[left], arena + src[left].offset, &src[right], arena + src[right].offset) <= 0)))
+                    dest[idx] = src[left++];
+                else
+                    dest[idx] = src[right++];
+            }
+        }
+        swap = src;
+        src = dest;
+        dest = swap;
+    }
+
+    return src;
+}
+
+static int
+c2b_sort_bucket_compare(const void *a, const void *b)
+{
+    const c2b_sort_bucket_t *a_bucket = *(const c2b_sort_bucket_t * const *) a;
+    const c2b_sort_bucket_t *b_bucket = *(const c2b_sort_bucket_t * const *) b;
+    uint32_t len = (a_bucket->chr_len < b_bucket->chr_len) ? a_bucket->chr_len : b_bucket->chr_len;
+    int cmp = 0;
+
+    /* ranked chromosomes come first, in header order; the rest are all unranked */
+    if (a_bucket->rank != b_bucket->rank)
+        return (a_bucket->rank < b_bucket->rank) ? -1 : 1;
+
+    cmp = memcmp(a_bucket->chr, b_bucket->chr, len);
+    if (cmp != 0)
+        return cmp;
+    return (a_bucket->chr_len == b_bucket->chr_len) ? 0 : ((a_bucket->chr_len < b_bucket->chr_len) ? -1 : 1);
+}
+
+static int
+c2b_sort_bucket_compare_natural(const void *a, const void *b)
+{
+    const c2b_sort_bucket_t *a_bucket = *(const c2b_sort_bucket_t * const *) a;
+    const c2b_sort_bucket_t *b_bucket = *(const c2b_sort_bucket_t * const *) b;
+    const char *a_chr = a_bucket->chr;
+    const char *b_chr = b_bucket->chr;
+    const char *a_end = a_chr + a_bucket->chr_len;
+    const char *b_end = b_chr + b_bucket->chr_len;
+    const char *a_digits = NULL;
+    const char *b_digits = NULL;
+    int cmp = 0;
+
+    /* 
+       Runs of digits compare by value, leading zeros aside, and anything 
+       else byte by byte; names equal in value (chr01 and chr1) fall back on
+       lexicographic order
+    */
+
+    while ((a_chr < a_end) && (b_chr < b_end)) {
+        if (isdigit((unsigned char) *a_chr) && isdigit((unsigned char) *b_chr)) {
+            for (; (a_chr < a_end) && (*a_chr == '0'); a_chr++) {}
+            for (; (b_chr < b_end) && (*b_chr == '0'); b_chr++) {}
+            for (a_digits = a_chr; (a_chr < a_end) && isdigit((unsigned char) *a_chr); a_chr++) {}
+            for (b_digits = b_chr; (b_chr < b_end) && isdigit((unsigned char) *b_chr); b_chr++) {}
+            if (a_chr - a_digits != b_chr - b_digits)
+                return (a_chr - a_digits < b_chr - b_digits) ? -1 : 1;
+            cmp = memcmp(a_digits, b_digits, a_chr - a_digits);
+            if (cmp != 0)
+                return cmp;
+            continue;
+        }
+        if (*a_chr != *b_chr)
+            return ((unsigned char) *a_chr < (unsigned char) *b_chr) ? -1 : 1;
+        a_chr++;
+        b_chr++;
+    }
+    if ((a_chr < a_end) || (b_chr < b_end))
+        return (a_chr == a_end) ? -1 : 1;
+
+    return c2b_sort_bucket_compare(a, b);
+}
+
+static void
+c2b_sorter_start(c2b_sorter_t *s, boolean is_final)
+{
+    c2b_sort_bucket_t *b = NULL;
+    size_t bucket_idx = 0;
+    size_t worker_idx = 0;
+    size_t num_unordered = 0;
+    size_t num_jobs = 0;
+
+    /* 
+       Buckets with lines in memory (or, at the end, with segments on disk)
+       are put in chromosome order, which is the order workers claim them
+    */
+
+    if (s->num_buckets > 0) {
+        s->order = realloc(s->order, s->num_buckets * sizeof(c2b_sort_bucket_t *));
+        if (!s->order) {
+            fprintf(stderr, "Error: Could not allocate space for sort bucket order.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+    }
+    s->num_ordered = 0;
+    for (bucket_idx = 0; bucket_idx < s->num_buckets; bucket_idx++) {
+        b = &s->buckets[bucket_idx];
+        if ((b->num_keys == 0) && ((!is_final) || (b->num_segments == 0)))
+            continue;
+        b->is_sorted = kFalse;
+        s->order[s->num_ordered++] = b;
+        if (!b->is_ordered)
+            num_unordered++;
+    }
+    if (s->num_ordered > 1)
+        qsort(s->order, s->num_ordered, sizeof(c2b_sort_bucket_t *), (s->sort_order == NATURAL_SORT_ORDER) ? c2b_sort_bucket_compare_natural : c2b_sort_bucket_compare);
+
+    /* at the end of Starch output, every bucket is compressed, ordered or not */
+    s->is_final = is_final;
+    num_jobs = ((s->is_starch) && (is_final)) ? s->num_ordered : num_unordered;
+
+    s->next_claimed = 0;
+    s->num_workers = (c2b_globals.num_threads < num_jobs) ? c2b_globals.num_threads : num_jobs;
+    if (s->num_workers < 2) {
+        s->num_workers = 0;
+        return;
+    }
+
+    s->workers = malloc(s->num_workers * sizeof(pthread_t));
+    if (!s->workers) {
+        fprintf(stderr, "Error: Could not allocate space for sort worker threads.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    for (worker_idx = 0; worker_idx < s->num_workers; worker_idx++) {
+        pthread_create(&s->workers[worker_idx], NULL, c2b_sorter_sort_buckets, s);
+    }
+}
+
+static void *
+c2b_sorter_sort_buckets(void *arg)
+{
+    c2b_sorter_t *s = (c2b_sorter_t *) arg;
+    c2b_sort_bucket_t *b = NULL;
+
+    pthread_mutex_lock(&s->lock);
+    while (s->next_claimed < s->num_ordered) {
+        b = s->order[s->next_claimed++];
+        pthread_mutex_unlock(&s->lock);
+
+        c2b_sorter_prepare_bucket(s, b);
+
+        pthread_mutex_lock(&s->lock);
+        b->is_sorted = kTrue;
+        pthread_cond_broadcast(&s->sorted);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    pthread_exit(NULL);
+}
+
+static c2b_sort_bucket_t *
+c2b_sorter_wait(c2b_sorter_t *s, size_t order_idx)
+{
+    c2b_sort_bucket_t *b = s->order[order_idx];
+
+    /* without a pool, buckets are sorted one by one as they are written out */
+    if (s->num_workers == 0) {
+        c2b_sorter_prepare_bucket(s, b);
+        return b;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    while (!b->is_sorted)
+        pthread_cond_wait(&s->sorted, &s->lock);
+    pthread_mutex_unlock(&s->lock);
+
+    return b;
+}
+
+static void
+c2b_sorter_finish(c2b_sorter_t *s)
+{
+    size_t worker_idx = 0;
+
+    for (worker_idx = 0; worker_idx < s->num_workers; worker_idx++) {
+        pthread_join(s->workers[worker_idx], (void **) NULL);
+    }
+    if (s->workers)
+        free(s->workers), s->workers = NULL;
+    s->num_workers = 0;
+    s->num_ordered = 0;
+}
+
+static int
+c2b_sorter_open_spill_file(c2b_sorter_t *s)
+{
+    char *path = NULL;
+    int fd = -1;
+    int errsv = 0;
+
+    path = malloc(strlen(s->tmpdir) + strlen(c2b_sort_run_template) + 1);
+    if (!path) {
+        fprintf(stderr, "Error: Could not allocate space for sort spill file path.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    memcpy(path, s->tmpdir, strlen(s->tmpdir));
+    memcpy(path + strlen(s->tmpdir), c2b_sort_run_template, strlen(c2b_sort_run_template) + 1);
+
+    /* the file is unlinked as soon as it is open, so it goes away however we exit */
+    fd = mkstemp(path);
+    if (fd == -1) {
+        errsv = errno;
+        fprintf(stderr, "Error: Could not create temporary file for sorted segments in [%s] (%s)\n", s->tmpdir, strerror(errsv));
+        c2b_print_usage(stderr);
+        exit(errsv);
+    }
+    unlink(path);
+    free(path), path = NULL;
+
+    return fd;
+}
+
+static off_t
+c2b_sort_bucket_write_keys(c2b_sort_bucket_t *b, c2b_output_t *out)
+{
+    c2b_batch_t batch;
+    off_t size = 0;
+    size_t idx = 0;
+
+    /* lines are gathered straight out of the arena where they are long enough */
+    c2b_init_batch(&batch, c2b_globals.io_buffer_size + C2B_IO_BUFFER_MIN_VALUE, c2b_globals.io_buffer_size, out);
+    c2b_batch_init_views(&batch);
+    for (idx = 0; idx < b->num_keys; idx++) {
+        c2b_batch_append_view(&batch, b->arena + b->sorted_keys[idx].offset, b->sorted_keys[idx].len);
+        size += b->sorted_keys[idx].len;
+        if (batch.len + batch.view_bytes >= batch.flush_size)
+            c2b_batch_flush(&batch);
+    }
+    c2b_delete_batch(&batch);
+
+    return size;
+}
+
+static void
+c2b_sorter_spill(c2b_sorter_t *s)
+{
+    c2b_sort_bucket_t *b = NULL;
+    c2b_output_t out;
+    off_t size = 0;
+    size_t bucket_idx = 0;
+    size_t order_idx = 0;
+
+#ifdef DEBUG
+    fprintf(stderr, "Debug: Spilling [%zu] bytes of sorted buckets under [%s]\n", s->mem_used, s->tmpdir);
+#endif
+
+    if (s->spill_fd == -1)
+        s->spill_fd = c2b_sorter_open_spill_file(s);
+
+    /* buckets with no room for another segment are first merged down to one */
+    for (bucket_idx = 0; bucket_idx < s->num_buckets; bucket_idx++) {
+        b = &s->buckets[bucket_idx];
+        if ((b->is_ordered) || (b->num_keys == 0) || (b->num_segments < C2B_MAX_SORT_RUNS_VALUE))
+            continue;
+        c2b_init_output(&out, s->spill_fd);
+        size = c2b_sort_bucket_merge(s, b, kFalse, &out);
+        c2b_delete_output(&out);
+        b->segments[0].offset = s->spill_len;
+        b->segments[0].size = size;
+        b->num_segments = 1;
+        s->spill_len += size;
+    }
+
+    c2b_sorter_start(s, kFalse);
+    c2b_init_output(&out, s->spill_fd);
+    for (order_idx = 0; order_idx < s->num_ordered; order_idx++) {
+        b = c2b_sorter_wait(s, order_idx);
+        size = c2b_sort_bucket_write_keys(b, &out);
+        c2b_sort_bucket_push_segment(b, s->spill_len, size);
+        s->spill_len += size;
+    }
+    c2b_delete_output(&out);
+    c2b_sorter_finish(s);
+
+    for (bucket_idx = 0; bucket_idx < s->num_buckets; bucket_idx++) {
+        b = &s->buckets[bucket_idx];
+        if ((b->is_ordered) && (b->num_keys > 0))
+            c2b_sort_bucket_keep_last_line(b);
+        b->arena_len = 0;
+        b->num_keys = 0;
+    }
+    s->mem_used = 0;
+}
+
+static boolean
+c2b_sort_run_next(c2b_sort_run_t *r)
+{
+    char *newline = NULL;
+    ssize_t bytes_read = 0;
+    size_t bytes_wanted = 0;
+    int errsv = 0;
+
+    if (r->fd == -1) {
+        if (r->next_key == r->num_keys)
+            return kFalse;
+        r->key = r->keys[r->next_key++];
+        r->line = r->arena + r->key.offset;
+        return kTrue;
+    }
+
+    for (;;) {
+        newline = memchr(r->buf + r->pos, c2b_line_delim, r->len - r->pos);
+        if (newline) {
+            r->line = r->buf + r->pos;
+            c2b_sort_key_line(&r->key, r->line, newline - r->line + 1);
+            r->pos += r->key.len;
+            return kTrue;
+        }
+        if (r->offset == r->end)
+            return kFalse;
+
+        /* the partial line moves to the front, and the buffer grows if it is full */
+        memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+        r->len -= r->pos;
+        r->pos = 0;
+        if (r->len == r->capacity)
+            c2b_grow_buffer(&r->buf, &r->capacity, 2 * r->capacity, "sorted segment buffer");
+        bytes_wanted = ((off_t) (r->capacity - r->len) < r->end - r->offset) ? (size_t) (r->capacity - r->len) : (size_t) (r->end - r->offset);
+        do {
+            bytes_read = pread(r->fd, r->buf + r->len, bytes_wanted, r->offset);
+        } while ((bytes_read == -1) && (errno == EINTR));
+        if (bytes_read <= 0) {
+            errsv = (bytes_read == 0) ? EIO : errno;
+            fprintf(stderr, "Error: Could not read sorted segment back from temporary file (%s)\n", strerror(errsv));
+            c2b_print_usage(stderr);
+            exit(errsv);
+        }
+        r->offset += bytes_read;
+        r->len += bytes_read;
+    }
+}
+
+static void
+c2b_sort_bucket_copy_segments(c2b_sorter_t *s, c2b_sort_bucket_t *b, c2b_output_t *out)
+{
+    char *buf = NULL;
+    ssize_t bytes_read = 0;
+    size_t bytes_wanted = 0;
+    size_t segment_idx = 0;
+    off_t offset = 0;
+    off_t end = 0;
+    int errsv = 0;
+
+    /* segments of an ordered bucket follow on from one another, so they are copied as they are */
+    buf = malloc(c2b_globals.io_buffer_size);
+    if (!buf) {
+        fprintf(stderr, "Error: Could not allocate space for sorted segment buffer.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    for (segment_idx = 0; segment_idx < b->num_segments; segment_idx++) {
+        offset = b->segments[segment_idx].offset;
+        end = offset + b->segments[segment_idx].size;
+        while (offset < end) {
+            bytes_wanted = (c2b_globals.io_buffer_size < end - offset) ? (size_t) c2b_globals.io_buffer_size : (size_t) (end - offset);
+            do {
+                bytes_read = pread(s->spill_fd, buf, bytes_wanted, offset);
+            } while ((bytes_read == -1) && (errno == EINTR));
+            if (bytes_read <= 0) {
+                errsv = (bytes_read == 0) ? EIO : errno;
+                fprintf(stderr, "Error: Could not read sorted segment back from temporary file (%s)\n", strerror(errsv));
+                c2b_print_usage(stderr);
+                exit(errsv);
+            }
+            c2b_output_write(out, buf, bytes_read);
+            offset += bytes_read;
+        }
+    }
+    free(buf), buf = NULL;
+}
+
+static off_t
+c2b_sort_bucket_merge(c2b_sorter_t *s, c2b_sort_bucket_t *b, boolean with_keys, c2b_output_t *out)
+{
+    c2b_sort_run_t *runs = NULL;
+    c2b_sort_run_t *r = NULL;
+    size_t *heap = NULL;
+    size_t num_runs = 0;
+    size_t heap_len = 0;
+    size_t run_idx = 0;
+    size_t parent = 0;
+    size_t child = 0;
+    size_t swap = 0;
+    ssize_t run_capacity = 0;
+    off_t size = 0;
+    c2b_batch_t batch;
+
+    runs = malloc((b->num_segments + 1) * sizeof(c2b_sort_run_t));
+    heap = malloc((b->num_segments + 1) * sizeof(size_t));
+    if ((!runs) || (!heap)) {
+        fprintf(stderr, "Error: Could not allocate space for merging sorted segments.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+
+    /* 
+       Segments on disk are read back sharing --max-mem between their 
+       buffers; the bucket's sorted lines in memory, if wanted, are merged 
+       as one more run, straight out of its arena
+    */
+
+    run_capacity = (ssize_t) (s->max_mem / (b->num_segments + 1));
+    if (run_capacity > c2b_globals.io_buffer_size)
+        run_capacity = c2b_globals.io_buffer_size;
+    if (run_capacity < C2B_IO_BUFFER_MIN_VALUE)
+        run_capacity = C2B_IO_BUFFER_MIN_VALUE;
+
+    for (num_runs = 0; num_runs < b->num_segments; num_runs++) {
+        r = &runs[num_runs];
+        r->fd = s->spill_fd;
+        r->offset = b->segments[num_runs].offset;
+        r->end = r->offset + b->segments[num_runs].size;
+        r->buf = malloc(run_capacity);
+        if (!r->buf) {
+            fprintf(stderr, "Error: Could not allocate space for sorted segment buffer.\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+        r->capacity = run_capacity;
+        r->pos = 0;
+        r->len = 0;
+    }
+    if ((with_keys) && (b->num_keys > 0)) {
+        r = &runs[num_runs++];
+        r->fd = -1;
+        r->buf = NULL;
+        r->keys = b->sorted_keys;
+        r->arena = b->arena;
+        r->num_keys = b->num_keys;
+        r->next_key = 0;
+    }
+
+    /* the head line of each run goes into a binary min-heap */
+    for (run_idx = 0; run_idx < num_runs; run_idx++) {
+        if (!c2b_sort_run_next(&runs[run_idx]))
+            continue;
+        heap[heap_len] = run_idx;
+        for (child = heap_len++; child > 0; child = parent) {
+            parent = (child - 1) / 2;
+            if (c2b_sort_compare(&runs[heap[child]].key, runs[heap[child]].line, &runs[heap[parent]].key, runs[heap[parent]].line) >= 0)
+                break;
+            swap = heap[child];
+            heap[child] = heap[parent];
+            heap[parent] = swap;
+        }
+    }
+
+    c2b_init_batch(&batch, c2b_globals.io_buffer_size + C2B_IO_BUFFER_MIN_VALUE, c2b_globals.io_buffer_size, out);
+    while (heap_len > 0) {
+        r = &runs[heap[0]];
+        c2b_batch_append(&batch, r->line, r->key.len);
+        size += r->key.len;
+        if (batch.len >= batch.flush_size)
+            c2b_batch_flush(&batch);
+        if (!c2b_sort_run_next(r))
+            heap[0] = heap[--heap_len];
+        for (parent = 0; (child = 2 * parent + 1) < heap_len; parent = child) {
+            if ((child + 1 < heap_len) && (c2b_sort_compare(&runs[heap[child + 1]].key, runs[heap[child + 1]].line, &runs[heap[child]].key, runs[heap[child]].line) < 0))
+                child++;
+            if (c2b_sort_compare(&runs[heap[child]].key, runs[heap[child]].line, &runs[heap[parent]].key, runs[heap[parent]].line) >= 0)
+                break;
+            swap = heap[child];
+            heap[child] = heap[parent];
+            heap[parent] = swap;
+        }
+    }
+    c2b_delete_batch(&batch);
+
+    for (run_idx = 0; run_idx < num_runs; run_idx++) {
+        if (runs[run_idx].buf)
+            free(runs[run_idx].buf), runs[run_idx].buf = NULL;
+    }
+    free(heap), heap = NULL;
+    free(runs), runs = NULL;
+
+    return size;
+}
+
+static void
+c2b_sorter_write_out(c2b_sorter_t *s, int dest_fd)
+{
+    c2b_sort_bucket_t *b = NULL;
+    c2b_output_t out;
+    size_t order_idx = 0;
+    uint64_t offset = C2B_STARCH_MAGIC_LENGTH_VALUE;
+
+    /* a last line without a newline is given one, as sort-bed would */
+    if (s->pending_len > 0)
+        c2b_sorter_append(s, &c2b_line_delim, 1);
+
+    c2b_sorter_start(s, kTrue);
+    c2b_init_output(&out, dest_fd);
+    if (!s->is_starch) {
+        for (order_idx = 0; order_idx < s->num_ordered; order_idx++) {
+            b = c2b_sorter_wait(s, order_idx);
+            c2b_sorter_write_bucket(s, b, &out);
+        }
+        c2b_delete_output(&out);
+        c2b_sorter_finish(s);
+        return;
+    }
+
+    /* 
+       Compressed streams follow the magic bytes in chromosome order, as 
+       their workers finish them, and the metadata and footer close the 
+       archive
+    */
+
+    c2b_output_write(&out, (char *) c2b_starch_magic, C2B_STARCH_MAGIC_LENGTH_VALUE);
+    for (order_idx = 0; order_idx < s->num_ordered; order_idx++) {
+        b = c2b_sorter_wait(s, order_idx);
+        c2b_output_write(&out, b->starch->buf, b->starch->len);
+        offset += b->starch->len;
+        free(b->starch->buf), b->starch->buf = NULL;
+    }
+    c2b_starch_write_metadata(s, &out, offset);
+    c2b_delete_output(&out);
+    c2b_sorter_finish(s);
+}
+
+static void
+c2b_sorter_prepare_bucket(c2b_sorter_t *s, c2b_sort_bucket_t *b)
+{
+    c2b_output_t out;
+
+    c2b_sort_bucket_sort(b);
+    if ((!s->is_starch) || (!s->is_final))
+        return;
+
+    /* the bucket is written out to a Starch stream of its own, which is then compressed to the end */
+    b->starch = malloc(sizeof(c2b_starch_stream_t));
+    if (!b->starch) {
+        fprintf(stderr, "Error: Could not allocate space for Starch stream.\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    c2b_init_starch_stream(b->starch);
+    c2b_init_output(&out, -1);
+    out.starch = b->starch;
+    c2b_sorter_write_bucket(s, b, &out);
+    c2b_delete_output(&out);
+    c2b_starch_stream_compress(b->starch, kTrue);
+}
+
+static void
+c2b_sorter_write_bucket(c2b_sorter_t *s, c2b_sort_bucket_t *b, c2b_output_t *out)
+{
+    if (b->num_segments == 0)
+        c2b_sort_bucket_write_keys(b, out);
+    else if (b->is_ordered) {
+        c2b_sort_bucket_copy_segments(s, b, out);
+        c2b_sort_bucket_write_keys(b, out);
+    }
+    else
+        c2b_sort_bucket_merge(s, b, kTrue, out);
+}
+
+static void
+c2b_init_starch_stream(c2b_starch_stream_t *st)
+{
+    int ret = 0;
+
+    c2b_init_batch(&st->transformed, C2B_STARCH_TRANSFORM_BUFFER_VALUE + C2B_IO_BUFFER_MIN_VALUE, C2B_STARCH_TRANSFORM_BUFFER_VALUE, NULL);
+    st->buf = NULL;
+    st->len = 0;
+    st->capacity = 0;
+    st->pending = NULL;
+    st->pending_len = 0;
+    st->pending_capacity = 0;
+    st->is_gzip = c2b_globals.starch->gzip;
+    st->num_lines = 0;
+    st->non_unique_bases = 0;
+    st->unique_bases = 0;
+    st->last_stop = 0;
+    st->last_length = 0;
+    st->max_stop = 0;
+
+    /* compression settings are those of the BEDOPS starch binary */
+    if (st->is_gzip) {
+        st->z.zalloc = Z_NULL;
+        st->z.zfree = Z_NULL;
+        st->z.opaque = Z_NULL;
+        ret = deflateInit2(&st->z, C2B_STARCH_ZLIB_LEVEL_VALUE, Z_DEFLATED, C2B_STARCH_ZLIB_WINDOW_BITS_VALUE, C2B_STARCH_ZLIB_MEM_LEVEL_VALUE, Z_DEFAULT_STRATEGY);
+        ret = (ret == Z_OK) ? 0 : ret;
+    }
+    else {
+        st->bz.bzalloc = NULL;
+        st->bz.bzfree = NULL;
+        st->bz.opaque = NULL;
+        ret = BZ2_bzCompressInit(&st->bz, C2B_STARCH_BZIP2_BLOCK_SIZE_VALUE, 0, 0);
+        ret = (ret == BZ_OK) ? 0 : ret;
+    }
+    if (ret != 0) {
+        fprintf(stderr, "Error: Could not initialize Starch stream compression (%d)\n", ret);
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+}
+
+static void
+c2b_delete_starch_stream(c2b_starch_stream_t *st)
+{
+    c2b_delete_batch(&st->transformed);
+    if (st->buf)
+        free(st->buf), st->buf = NULL;
+    if (st->pending)
+        free(st->pending), st->pending = NULL;
+    st->len = 0;
+    st->capacity = 0;
+    st->pending_len = 0;
+    st->pending_capacity = 0;
+}
+
+static void
+c2b_starch_stream_append(c2b_starch_stream_t *st, const char *buf, size_t len)
+{
+    const char *end = buf + len;
+    const char *newline = NULL;
+    size_t line_len = 0;
+
+    /* as with the sorter, a line split across writes waits in the pending buffer */
+    if (st->pending_len > 0) {
+        newline = memchr(buf, c2b_line_delim, len);
+        line_len = (newline) ? (size_t) (newline - buf + 1) : len;
+        if (st->pending_len + (ssize_t) line_len > st->pending_capacity)
+            c2b_grow_buffer(&st->pending, &st->pending_capacity, 2 * (st->pending_len + line_len), "pending Starch line");
+        memcpy(st->pending + st->pending_len, buf, line_len);
+        st->pending_len += line_len;
+        buf += line_len;
+        if (!newline)
+            return;
+        c2b_starch_stream_add_line(st, st->pending, st->pending_len);
+        st->pending_len = 0;
+    }
+
+    while ((newline = memchr(buf, c2b_line_delim, end - buf)) != NULL) {
+        c2b_starch_stream_add_line(st, buf, newline - buf + 1);
+        buf = newline + 1;
+    }
+
+    if (buf < end) {
+        if (end - buf > st->pending_capacity)
+            c2b_grow_buffer(&st->pending, &st->pending_capacity, 2 * (end - buf), "pending Starch line");
+        memcpy(st->pending, buf, end - buf);
+        st->pending_len = end - buf;
+    }
+
+    if (st->transformed.len >= st->transformed.flush_size)
+        c2b_starch_stream_compress(st, kFalse);
+}
+
+static inline void
+c2b_starch_stream_add_line(c2b_starch_stream_t *st, const char *line, size_t len)
+{
+    const char *end = line + len - 1;
+    const char *rest = NULL;
+    c2b_sort_key_t key;
+    uint64_t length = 0;
+
+    c2b_sort_key_line(&key, line, len);
+    length = (key.stop > key.start) ? key.stop - key.start : 0;
+
+    /* columns past the stop position are kept as they are */
+    rest = memchr(line + key.chr_len + 1, c2b_tab_delim, (key.chr_len + 1 < len) ? len - key.chr_len - 1 : 0);
+    if (rest)
+        rest = memchr(rest + 1, c2b_tab_delim, end - rest - 1);
+
+    if (length != st->last_length) {
+        c2b_batch_append(&st->transformed, "p", 1);
+        c2b_batch_append_uint64(&st->transformed, length, c2b_line_delim);
+        st->last_length = length;
+    }
+    if (key.start < st->last_stop) {
+        c2b_batch_append(&st->transformed, "-", 1);
+        c2b_batch_append_uint64(&st->transformed, st->last_stop - key.start, (rest) ? c2b_tab_delim : c2b_line_delim);
+    }
+    else
+        c2b_batch_append_uint64(&st->transformed, key.start - st->last_stop, (rest) ? c2b_tab_delim : c2b_line_delim);
+    if (rest)
+        c2b_batch_append(&st->transformed, rest + 1, end - rest);
+    st->last_stop = key.stop;
+
+    st->num_lines++;
+    st->non_unique_bases += length;
+    if (key.start >= st->max_stop)
+        st->unique_bases += length;
+    else if (key.stop > st->max_stop)
+        st->unique_bases += key.stop - st->max_stop;
+    if (key.stop > st->max_stop)
+        st->max_stop = key.stop;
+}
+
+static void
+c2b_starch_stream_compress(c2b_starch_stream_t *st, boolean is_final)
+{
+    boolean is_done = kFalse;
+    int ret = 0;
+
+    if ((is_final) && (st->pending_len > 0)) {
+        c2b_starch_stream_add_line(st, st->pending, st->pending_len);
+        st->pending_len = 0;
+    }
+
+    /* 
+       Transformed lines are compressed into the stream's buffer, which 
+       grows as needed; once final, the compressor is flushed and released
+    */
+
+    if (st->is_gzip) {
+        st->z.next_in = (Bytef *) st->transformed.buf;
+        st->z.avail_in = (uInt) st->transformed.len;
+    }
+    else {
+        st->bz.next_in = st->transformed.buf;
+        st->bz.avail_in = (unsigned int) st->transformed.len;
+    }
+
+    while (!is_done) {
+        c2b_grow_buffer(&st->buf, &st->capacity, st->len + st->transformed.len / 2 + C2B_IO_BUFFER_MIN_VALUE, "Starch stream buffer");
+        if (st->is_gzip) {
+            st->z.next_out = (Bytef *) (st->buf + st->len);
+            st->z.avail_out = (uInt) (st->capacity - st->len);
+            ret = deflate(&st->z, (is_final) ? Z_FINISH : Z_NO_FLUSH);
+            st->len = st->capacity - st->z.avail_out;
+            if (ret == Z_STREAM_ERROR)
+                break;
+            is_done = (is_final) ? (ret == Z_STREAM_END) : ((st->z.avail_in == 0) && (st->z.avail_out > 0));
+        }
+        else {
+            st->bz.next_out = st->buf + st->len;
+            st->bz.avail_out = (unsigned int) (st->capacity - st->len);
+            ret = BZ2_bzCompress(&st->bz, (is_final) ? BZ_FINISH : BZ_RUN);
+            st->len = st->capacity - st->bz.avail_out;
+            if (ret < 0)
+                break;
+            is_done = (is_final) ? (ret == BZ_STREAM_END) : (st->bz.avail_in == 0);
+        }
+    }
+    if (!is_done) {
+        fprintf(stderr, "Error: Could not compress Starch stream (%d)\n", ret);
+        c2b_print_usage(stderr);
+        exit(EIO); /* I/O error (POSIX.1) */
+    }
+    c2b_batch_reset(&st->transformed);
+
+    if (is_final) {
+        if (st->is_gzip)
+            deflateEnd(&st->z);
+        else
+            BZ2_bzCompressEnd(&st->bz);
+    }
+}
+
+static void
+c2b_starch_write_metadata(c2b_sorter_t *s, c2b_output_t *out, uint64_t offset)
+{
+    c2b_batch_t metadata;
+    c2b_sort_bucket_t *b = NULL;
+    c2b_starch_stream_t *st = NULL;
+    size_t order_idx = 0;
+    char hostname[C2B_STARCH_HOSTNAME_LENGTH_VALUE] = {0};
+    char timestamp[C2B_STARCH_TIMESTAMP_LENGTH_VALUE] = {0};
+    char footer[C2B_STARCH_FOOTER_LENGTH_VALUE];
+    unsigned char digest[C2B_SHA1_DIGEST_LENGTH_VALUE];
+    time_t now = time(NULL);
+    struct tm local;
+    pid_t pid = getpid();
+
+    /* 
+       Metadata is laid out as the starch binary lays it out, since its 
+       digest is checked byte for byte; stream filenames only need to be 
+       unique, and follow starch in naming them after the host and process
+    */
+
+    gethostname(hostname, sizeof(hostname) - 1);
+    localtime_r(&now, &local);
+    strftime(timestamp, sizeof(timestamp), c2b_starch_timestamp_format, &local);
+
+    c2b_init_batch(&metadata, C2B_IO_BUFFER_MIN_VALUE, C2B_IO_BUFFER_MIN_VALUE, NULL);
+    c2b_batch_printf(&metadata,
+                     "{\n"
+                     "  \"archive\": {\n"
+                     "    \"type\": \"starch\",\n"
+                     "    \"customUCSCHeaders\": false,\n"
+                     "    \"creationTimestamp\": \"%s\",\n"
+                     "    \"version\": {\n"
+                     "      \"major\": 2,\n"
+                     "      \"minor\": 0,\n"
+                     "      \"revision\": 0\n"
+                     "    },\n"
+                     "    \"compressionFormat\": %d",
+                     timestamp,
+                     (c2b_globals.starch->gzip) ? 1 : 0);
+    if (c2b_globals.starch->note) {
+        c2b_batch_printf(&metadata, ",\n    \"note\": \"");
+        c2b_batch_append_json_str(&metadata, c2b_globals.starch->note, strlen(c2b_globals.starch->note));
+        c2b_batch_append(&metadata, "\"", 1);
+    }
+    c2b_batch_printf(&metadata, "\n  },\n  \"streams\": [%s", (s->num_ordered > 0) ? "\n" : "");
+    for (order_idx = 0; order_idx < s->num_ordered; order_idx++) {
+        b = s->order[order_idx];
+        st = b->starch;
+        c2b_batch_printf(&metadata, "    {\n      \"chromosome\": \"");
+        c2b_batch_append_json_str(&metadata, b->chr, b->chr_len);
+        c2b_batch_printf(&metadata, "\",\n      \"filename\": \"");
+        c2b_batch_append_json_str(&metadata, b->chr, b->chr_len);
+        c2b_batch_printf(&metadata, ".pid%d.", (int) pid);
+        c2b_batch_append_json_str(&metadata, hostname, strlen(hostname));
+        c2b_batch_printf(&metadata,
+                         "\",\n"
+                         "      \"size\": \"%zd\",\n"
+                         "      \"uncompressedLineCount\": %" PRIu64 ",\n"
+                         "      \"nonUniqueBaseCount\": %" PRIu64 ",\n"
+                         "      \"uniqueBaseCount\": %" PRIu64 "\n"
+                         "    }%s",
+                         st->len,
+                         st->num_lines,
+                         st->non_unique_bases,
+                         st->unique_bases,
+                         (order_idx + 1 < s->num_ordered) ? ",\n" : "\n  ");
+    }
+    c2b_batch_printf(&metadata, "]\n}");
+    c2b_output_write(out, metadata.buf, metadata.len);
+
+    /* the footer gives the metadata offset and digest, padded with spaces to its fixed length */
+    c2b_sha1((const unsigned char *) metadata.buf, metadata.len, digest);
+    memset(footer, ' ', C2B_STARCH_FOOTER_LENGTH_VALUE);
+    snprintf(footer, C2B_STARCH_OFFSET_DIGITS_VALUE + 1, "%0*" PRIu64, C2B_STARCH_OFFSET_DIGITS_VALUE, offset);
+    c2b_base64_encode(digest, C2B_SHA1_DIGEST_LENGTH_VALUE, footer + C2B_STARCH_OFFSET_DIGITS_VALUE);
+    footer[C2B_STARCH_OFFSET_DIGITS_VALUE + C2B_SHA1_BASE64_LENGTH_VALUE] = ' ';
+    footer[C2B_STARCH_FOOTER_LENGTH_VALUE - 1] = c2b_line_delim;
+    c2b_output_write(out, footer, C2B_STARCH_FOOTER_LENGTH_VALUE);
+
+    c2b_delete_batch(&metadata);
+}
+
+static void
+c2b_batch_append_json_str(c2b_batch_t *b, const char *s, size_t len)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    const char *end = s + len;
+    char escaped[6] = { '\\', 'u', '0', '0', '0', '0' };
+
+    for (; s < end; s++) {
+        switch (*s) {
+            case '"':
+                c2b_batch_append(b, "\\\"", 2);
+                break;
+            case '\\':
+                c2b_batch_append(b, "\\\\", 2);
+                break;
+            case '\b':
+                c2b_batch_append(b, "\\b", 2);
+                break;
+            case '\f':
+                c2b_batch_append(b, "\\f", 2);
+                break;
+            case '\n':
+                c2b_batch_append(b, "\\n", 2);
+                break;
+            case '\r':
+                c2b_batch_append(b, "\\r", 2);
+                break;
+            case '\t':
+                c2b_batch_append(b, "\\t", 2);
+                break;
+            default:
+                if ((unsigned char) *s < 0x20) {
+                    escaped[4] = hex_digits[(unsigned char) *s >> 4];
+                    escaped[5] = hex_digits[(unsigned char) *s & 0x0f];
+                    c2b_batch_append(b, escaped, 6);
+                }
+                else
+                    c2b_batch_append(b, s, 1);
+                break;
+        }
+    }
+}
+
+static void
+c2b_sha1(const unsigned char *data, size_t len, unsigned char *digest)
+{
+    uint32_t h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+    uint32_t w[80];
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t c = 0;
+    uint32_t d = 0;
+    uint32_t e = 0;
+    uint32_t f = 0;
+    uint32_t k = 0;
+    uint32_t temp = 0;
+    unsigned char block[64];
+    uint64_t bit_len = (uint64_t) len * 8;
+    size_t num_blocks = (len + 8) / 64 + 1;
+    size_t block_idx = 0;
+    size_t byte_idx = 0;
+    size_t pos = 0;
+    int idx = 0;
+
+    /* FIPS 180-1; the message is padded with a one bit, zeros and its length in bits */
+    for (block_idx = 0; block_idx < num_blocks; block_idx++) {
+        for (idx = 0; idx < 64; idx++) {
+            pos = block_idx * 64 + idx;
+            if (pos < len)
+                block[idx] = data[pos];
+            else if (pos == len)
+                block[idx] = 0x80;
+            else if ((block_idx == num_blocks - 1) && (idx >= 56))
+                block[idx] = (unsigned char) (bit_len >> (8 * (63 - idx)));
+            else
+                block[idx] = 0;
+        }
+        for (idx = 0; idx < 16; idx++) {
+            byte_idx = 4 * idx;
+            w[idx] = ((uint32_t) block[byte_idx] << 24) | ((uint32_t) block[byte_idx + 1] << 16) | ((uint32_t) block[byte_idx + 2] << 8) | (uint32_t) block[byte_idx + 3];
+        }
+        for (idx = 16; idx < 80; idx++) {
+            temp = w[idx - 3] ^ w[idx - 8] ^ w[idx - 14] ^ w[idx - 16];
+            w[idx] = (temp << 1) | (temp >> 31);
+        }
+        a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (idx = 0; idx < 80; idx++) {
+            if (idx < 20)
+                f = (b & c) | (~b & d), k = 0x5a827999;
+            else if (idx < 40)
+                f = b ^ c ^ d, k = 0x6ed9eba1;
+            else if (idx < 60)
+                f = (b & c) | (b & d) | (c & d), k = 0x8f1bbcdc;
+            else
+                f = b ^ c ^ d, k = 0xca62c1d6;
+            temp = ((a << 5) | (a >> 27)) + f + e + k + w[idx];
+            e = d;
+            d = c;
+            c = (b << 30) | (b >> 2);
+            b = a;
+            a = temp;
+        }
+        h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e;
+    }
+
+    for (idx = 0; idx < C2B_SHA1_DIGEST_LENGTH_VALUE; idx++)
+        digest[idx] = (unsigned char) (h[idx / 4] >> (24 - 8 * (idx % 4)));
+}
+
+static void
+c2b_base64_encode(const unsigned char *data, size_t len, char *dest)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint32_t triple = 0;
+    size_t idx = 0;
+
+    /* dest gets 4 * ceil(len / 3) characters, padded with '=' and not terminated */
+    for (idx = 0; idx < len; idx += 3) {
+        triple = (uint32_t) data[idx] << 16;
+        if (idx + 1 < len)
+            triple |= (uint32_t) data[idx + 1] << 8;
+        if (idx + 2 < len)
+            triple |= (uint32_t) data[idx + 2];
+        *dest++ = alphabet[(triple >> 18) & 0x3f];
+        *dest++ = alphabet[(triple >> 12) & 0x3f];
+        *dest++ = (idx + 1 < len) ? alphabet[(triple >> 6) & 0x3f] : '=';
+        *dest++ = (idx + 2 < len) ? alphabet[triple & 0x3f] : '=';
+    }
+}
+
+static void
+c2b_init_input(c2b_input_t *in, int fd)
+{
+    in->fd = fd;
+    in->ring = NULL;
+    in->depth = 0;
+    in->next_block = 0;
+    in->offset = 0;
+    in->submit_offset = 0;
+    in->is_seekable = kFalse;
+
+#ifdef C2B_HAVE_IO_URING
+    size_t block_idx = 0;
+
+    if ((c2b_globals.io_engine != URING_IO_ENGINE) || ((in->ring = c2b_uring_init()) == NULL))
+        return;
+
+    /* 
+       Reads at explicit offsets of a seekable descriptor can all be in flight
+       at once. Reads from a pipe complete in the order the data arrives, so 
+       we keep just one of those in flight.
+    */
+
+    if ((in->offset = lseek(fd, 0, SEEK_CUR)) != -1) {
+        in->is_seekable = kTrue;
+        in->depth = C2B_URING_DEPTH_VALUE;
+    }
+    else {
+        in->offset = 0;
+        in->depth = 1;
+    }
+    in->submit_offset = in->offset;
+
+    for (block_idx = 0; block_idx < in->depth; block_idx++)
+        c2b_input_submit(in, block_idx);
+    c2b_uring_enter(in->ring, in->depth, 0);
+#endif
+}
+
+static ssize_t
+c2b_input_read(c2b_input_t *in, char *buf, size_t len)
+{
+#ifdef C2B_HAVE_IO_URING
+    c2b_io_block_t *block = NULL;
+    ssize_t bytes_read = 0;
+
+    if (!in->ring)
+        return read(in->fd, buf, len);
+
+    /* 
+       Blocks are consumed in the order they were submitted. A block that was
+       read from anywhere other than the current offset follows a short read,
+       so we throw away whatever is in flight and read ahead from there again.
+    */
+
+    for (;;) {
+        block = &in->ring->blocks[in->next_block];
+        while (block->state == IO_BLOCK_IN_FLIGHT)
+            c2b_uring_reap(in->ring);
+
+        if (block->result < 0) {
+            if ((block->result == -EINTR) || (block->result == -EAGAIN)) {
+                c2b_input_resync(in);
+                continue;
+            }
+            fprintf(stderr, "Error: io_uring read failed (%s)\n", strerror(-block->result));
+            exit(-block->result);
+        }
+        if ((in->is_seekable) && (block->offset != in->offset)) {
+            c2b_input_resync(in);
+            continue;
+        }
+        break;
+    }
+
+    if (block->result == 0)
+        return 0;
+
+    bytes_read = ((size_t) (block->result - block->pos) < len) ? (block->result - block->pos) : (ssize_t) len;
+    memcpy(buf, block->buf + block->pos, bytes_read);
+    block->pos += bytes_read;
+    in->offset += bytes_read;
+
+    if (block->pos == block->result) {
+        c2b_input_submit(in, in->next_block);
+        c2b_uring_enter(in->ring, 1, 0);
+        in->next_block = (in->next_block + 1) % in->depth;
+    }
+
+    return bytes_read;
+#else
+    return read(in->fd, buf, len);
+#endif
+}
+
+static void
+c2b_delete_input(c2b_input_t *in)
+{
+#ifdef C2B_HAVE_IO_URING
+    if (in->ring)
+        c2b_uring_delete(in->ring), in->ring = NULL;
+#endif
+    in->fd = -1;
+}
+
+static void
+c2b_init_output(c2b_output_t *out, int fd)
+{
+    out->fd = fd;
+    out->ring = NULL;
+    out->sorter = NULL;
+    out->starch = NULL;
+    out->fill_block = 0;
+    out->batch_first = 0;
+    out->batch_count = 0;
+
+#ifdef C2B_HAVE_IO_URING
+    if ((c2b_globals.io_engine == URING_IO_ENGINE) && (fd != -1))
+        out->ring = c2b_uring_init();
+#endif
+}
+
+static void
+c2b_output_write(c2b_output_t *out, char *buf, size_t len)
+{
+    ssize_t bytes_written = 0;
+    int errsv = 0;
+
+    if (out->sorter) {
+        c2b_sorter_append(out->sorter, buf, len);
+        return;
+    }
+    if (out->starch) {
+        c2b_starch_stream_append(out->starch, buf, len);
+        return;
+    }
+
+#ifdef C2B_HAVE_IO_URING
+    c2b_io_block_t *block = NULL;
+    size_t batch_size = C2B_URING_DEPTH_VALUE / 2;
+    size_t bytes_copied = 0;
+
+    if (out->ring) {
+        while (len > 0) {
+            block = &out->ring->blocks[out->fill_block];
+            bytes_copied = ((size_t) (C2B_URING_BLOCK_LENGTH_VALUE - block->len) < len) ? (size_t) (C2B_URING_BLOCK_LENGTH_VALUE - block->len) : len;
+            memcpy(block->buf + block->len, buf, bytes_copied);
+            block->len += bytes_copied;
+            buf += bytes_copied;
+            len -= bytes_copied;
+            if (block->len == C2B_URING_BLOCK_LENGTH_VALUE) {
+                out->fill_block = (out->fill_block + 1) % C2B_URING_DEPTH_VALUE;
+                if (out->fill_block % batch_size == 0)
+                    c2b_output_submit_batch(out, (out->fill_block + C2B_URING_DEPTH_VALUE - batch_size) % C2B_URING_DEPTH_VALUE, batch_size);
+            }
+        }
+        return;
+    }
+#endif
+
+    /* write() may stop short, in which case we carry on from where it left off */
+    while (len > 0) {
+        bytes_written = write(out->fd, buf, len);
+        if (bytes_written == -1) {
+            if (errno == EINTR)
+                continue;
+            errsv = errno;
+            fprintf(stderr, "Error: Could not write output (%s)\n", strerror(errsv));
+            c2b_print_usage(stderr);
+            exit(errsv);
+        }
+        buf += bytes_written;
+        len -= (size_t) bytes_written;
+    }
+}
+
+static void
+c2b_output_write_batch(c2b_output_t *out, c2b_batch_t *b)
+{
+    struct iovec iovecs[C2B_MAX_IOVECS_VALUE];
+    int iov_count = 0;
+    ssize_t view_idx = 0;
+    ssize_t buf_offset = 0;
+    c2b_field_t *view = NULL;
+    c2b_field_t tail;
+
+    /* 
+       Views and the bytes of buf between them are written in order, up to 
+       C2B_MAX_IOVECS_VALUE at a time. The io_uring engine, the sorter and Starch
+       streams copy everything into their own buffers, so views are handed
+       over one by one.
+    */
+
+    tail.str = NULL;
+    tail.size = b->len - b->viewed_len;
+
+    for (view_idx = 0; view_idx <= b->num_views; view_idx++) {
+        view = (view_idx < b->num_views) ? &b->views[view_idx] : &tail;
+        if (view->size == 0)
+            continue;
+        iovecs[iov_count].iov_base = (view->str) ? (char *) view->str : b->buf + buf_offset;
+        iovecs[iov_count].iov_len = view->size;
+        if (!view->str)
+            buf_offset += view->size;
+        if ((out->ring) || (out->sorter) || (out->starch)) {
+            c2b_output_write(out, iovecs[iov_count].iov_base, iovecs[iov_count].iov_len);
+            continue;
+        }
+        if (++iov_count == C2B_MAX_IOVECS_VALUE) {
+            c2b_output_writev(out, iovecs, iov_count);
+            iov_count = 0;
+        }
+    }
+
+    if (iov_count > 0)
+        c2b_output_writev(out, iovecs, iov_count);
 }
 
-static void *
-c2b_write_in_bytes_to_stdout(void *arg)
+static void
+c2b_output_writev(c2b_output_t *out, struct iovec *iov, int iov_count)
 {
-    c2b_pipeline_stage_t *stage = (c2b_pipeline_stage_t *) arg;
-    c2b_pipeset_t *pipes = stage->pipeset;
-    char buffer[C2B_MAX_LINE_LENGTH_VALUE];
-    ssize_t bytes_read;
-    int exit_status = 0;
+    ssize_t bytes_written = 0;
+    int errsv = 0;
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    while ((bytes_read = read(pipes->in[stage->src][PIPE_READ], buffer, C2B_MAX_LINE_LENGTH_VALUE)) > 0) {
-        write(STDOUT_FILENO, buffer, bytes_read);
+    /* writev() may stop short, in which case we carry on from where it left off */
+    while (iov_count > 0) {
+        bytes_written = writev(out->fd, iov, iov_count);
+        if (bytes_written == -1) {
+            if (errno == EINTR)
+                continue;
+            errsv = errno;
+            fprintf(stderr, "Error: Could not write output (%s)\n", strerror(errsv));
+            c2b_print_usage(stderr);
+            exit(errsv);
+        }
+        while ((iov_count > 0) && ((size_t) bytes_written >= iov->iov_len)) {
+            bytes_written -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = (char *) iov->iov_base + bytes_written;
+            iov->iov_len -= bytes_written;
+        }
     }
-#pragma GCC diagnostic pop
+}
 
-    if (WIFEXITED(stage->status) || WIFSIGNALED(stage->status)) {
-        waitpid(stage->pid, &stage->status, WUNTRACED);
-        exit_status = WEXITSTATUS(stage->status);
-        if (exit_status != 0) 
-            fprintf(stderr, 
-                    "Error: Stage [%s] failed -- exit status [%d | %d]\n", 
-                    stage->description,
-                    stage->status, 
-                    exit_status);
+static void
+c2b_delete_output(c2b_output_t *out)
+{
+#ifdef C2B_HAVE_IO_URING
+    size_t batch_size = C2B_URING_DEPTH_VALUE / 2;
+    size_t batch_first = 0;
+    size_t batch_count = 0;
+
+    if (out->ring) {
+        /* write out the partly filled batch, then wait for everything in flight */
+        batch_first = out->fill_block - (out->fill_block % batch_size);
+        batch_count = out->fill_block - batch_first + ((out->ring->blocks[out->fill_block].len > 0) ? 1 : 0);
+        if (batch_count > 0)
+            c2b_output_submit_batch(out, batch_first, batch_count);
+        c2b_output_flush_batch(out);
+        c2b_uring_delete(out->ring), out->ring = NULL;
+    }
+#endif
+    out->fd = -1;
+}
+
+#ifdef C2B_HAVE_IO_URING
+static c2b_uring_t *
+c2b_uring_init()
+{
+    c2b_uring_t *ring = NULL;
+    struct io_uring_params params;
+    struct iovec iovecs[C2B_URING_DEPTH_VALUE];
+    size_t block_idx = 0;
+    int ring_fd = -1;
+
+    memset(&params, 0, sizeof(params));
+    ring_fd = (int) syscall(__NR_io_uring_setup, C2B_URING_DEPTH_VALUE, &params);
+    if (ring_fd < 0)
+        return NULL;
+
+    /* reads from pipes and writes use the current file position (Linux 5.6) */
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        close(ring_fd);
+        return NULL;
     }
 
-    pthread_exit(NULL);
+    ring = malloc(sizeof(c2b_uring_t));
+    if (!ring) {
+        fprintf(stderr, "Error: Could not allocate space for io_uring instance\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    ring->fd = ring_fd;
+    ring->in_flight = 0;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    for (block_idx = 0; block_idx < C2B_URING_DEPTH_VALUE; block_idx++) {
+        ring->blocks[block_idx].buf = malloc(C2B_URING_BLOCK_LENGTH_VALUE);
+        if (!ring->blocks[block_idx].buf) {
+            fprintf(stderr, "Error: Could not allocate space for io_uring blocks\n");
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+        ring->blocks[block_idx].len = 0;
+        ring->blocks[block_idx].pos = 0;
+        ring->blocks[block_idx].offset = 0;
+        ring->blocks[block_idx].result = 0;
+        ring->blocks[block_idx].state = IO_BLOCK_IDLE;
+        iovecs[block_idx].iov_base = ring->blocks[block_idx].buf;
+        iovecs[block_idx].iov_len = C2B_URING_BLOCK_LENGTH_VALUE;
+    }
+    if (ring->sq_ring == MAP_FAILED) ring->sq_ring = NULL;
+    if (ring->cq_ring == MAP_FAILED) ring->cq_ring = NULL;
+    if (ring->sqes == MAP_FAILED) ring->sqes = NULL;
+    if ((!ring->sq_ring) || (!ring->cq_ring) || (!ring->sqes)) {
+        c2b_uring_delete(ring);
+        return NULL;
+    }
+
+    ring->sq_head = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.head);
+    ring->sq_tail = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *) ((char *) ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned int *) ((char *) ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ring + params.cq_off.cqes);
+
+    /* registering blocks can fail under a low RLIMIT_MEMLOCK on older kernels */
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iovecs, C2B_URING_DEPTH_VALUE) < 0) {
+        c2b_uring_delete(ring);
+        return NULL;
+    }
+
+    return ring;
 }
 
-static void *
-c2b_write_out_bytes_to_stdout(void *arg)
+static void
+c2b_uring_delete(c2b_uring_t *ring)
 {
-    c2b_pipeline_stage_t *stage = (c2b_pipeline_stage_t *) arg;
-    c2b_pipeset_t *pipes = stage->pipeset;
-    char buffer[C2B_MAX_LINE_LENGTH_VALUE];
-    ssize_t bytes_read;
-    int exit_status = 0;
+    size_t block_idx = 0;
+
+    while (ring->in_flight > 0)
+        c2b_uring_reap(ring);
+
+    if (ring->sqes)
+        munmap(ring->sqes, ring->sqes_size), ring->sqes = NULL;
+    if (ring->cq_ring)
+        munmap(ring->cq_ring, ring->cq_ring_size), ring->cq_ring = NULL;
+    if (ring->sq_ring)
+        munmap(ring->sq_ring, ring->sq_ring_size), ring->sq_ring = NULL;
+    close(ring->fd), ring->fd = -1;
+    for (block_idx = 0; block_idx < C2B_URING_DEPTH_VALUE; block_idx++)
+        free(ring->blocks[block_idx].buf), ring->blocks[block_idx].buf = NULL;
+    free(ring), ring = NULL;
+}
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-result"
-    while ((bytes_read = read(pipes->out[stage->src][PIPE_READ], buffer, C2B_MAX_LINE_LENGTH_VALUE)) > 0) {
-        write(STDOUT_FILENO, buffer, bytes_read);
+static void
+c2b_uring_submit(c2b_uring_t *ring, int fd, size_t block_idx, unsigned char opcode, off_t offset, boolean is_linked)
+{
+    unsigned int tail = *ring->sq_tail;
+    unsigned int sqe_idx = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[sqe_idx];
+    c2b_io_block_t *block = &ring->blocks[block_idx];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = (__u64) offset;
+    sqe->addr = (__u64) (uintptr_t) block->buf;
+    sqe->len = (opcode == IORING_OP_READ_FIXED) ? C2B_URING_BLOCK_LENGTH_VALUE : (__u32) block->len;
+    sqe->buf_index = (__u16) block_idx;
+    sqe->flags = (is_linked) ? IOSQE_IO_LINK : 0;
+    sqe->user_data = (__u64) block_idx;
+    ring->sq_array[sqe_idx] = sqe_idx;
+
+    block->state = IO_BLOCK_IN_FLIGHT;
+    ring->in_flight++;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static void
+c2b_uring_enter(c2b_uring_t *ring, unsigned int to_submit, unsigned int min_complete)
+{
+    long res = 0;
+
+    do {
+        res = syscall(__NR_io_uring_enter, ring->fd, to_submit, min_complete, (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    } while ((res == -1) && (errno == EINTR));
+
+    if (res == -1) {
+        int errsv = errno;
+        fprintf(stderr, "Error: io_uring_enter() call failed (%s)\n", strerror(errsv));
+        exit(errsv);
     }
-#pragma GCC diagnostic pop
+}
 
-    if (WIFEXITED(stage->status) || WIFSIGNALED(stage->status)) {
-        waitpid(stage->pid, &stage->status, WUNTRACED);
-        exit_status = WEXITSTATUS(stage->status);
-        if (exit_status != 0) 
-            fprintf(stderr, 
-                    "Error: Stage [%s] failed -- exit status [%d | %d]\n", 
-                    stage->description,
-                    stage->status, 
-                    exit_status);
+static void
+c2b_uring_reap(c2b_uring_t *ring)
+{
+    unsigned int head = *ring->cq_head;
+    unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    struct io_uring_cqe *cqe = NULL;
+    c2b_io_block_t *block = NULL;
+
+    if (head == tail) {
+        c2b_uring_enter(ring, 0, 1);
+        tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
     }
 
-    pthread_exit(NULL);
+    while (head != tail) {
+        cqe = &ring->cqes[head & *ring->cq_mask];
+        block = &ring->blocks[cqe->user_data];
+        block->result = cqe->res;
+        block->state = IO_BLOCK_DONE;
+        ring->in_flight--;
+        head++;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void
+c2b_input_submit(c2b_input_t *in, size_t block_idx)
+{
+    c2b_io_block_t *block = &in->ring->blocks[block_idx];
+
+    block->offset = (in->is_seekable) ? in->submit_offset : (off_t) -1;
+    block->pos = 0;
+    block->result = 0;
+    c2b_uring_submit(in->ring, in->fd, block_idx, IORING_OP_READ_FIXED, block->offset, kFalse);
+    if (in->is_seekable)
+        in->submit_offset += C2B_URING_BLOCK_LENGTH_VALUE;
 }
 
+static void
+c2b_input_resync(c2b_input_t *in)
+{
+    size_t block_idx = 0;
+
+    while (in->ring->in_flight > 0)
+        c2b_uring_reap(in->ring);
+
+    in->submit_offset = in->offset;
+    for (block_idx = 0; block_idx < in->depth; block_idx++)
+        c2b_input_submit(in, (in->next_block + block_idx) % in->depth);
+    c2b_uring_enter(in->ring, in->depth, 0);
+}
+
+static void
+c2b_output_submit_batch(c2b_output_t *out, size_t first, size_t count)
+{
+    size_t block_idx = 0;
+
+    /* 
+       The previous batch must be out before this one starts. Linked writes
+       then run one after another, in the order they were filled.
+    */
+
+    c2b_output_flush_batch(out);
+
+    for (block_idx = first; block_idx < first + count; block_idx++)
+        c2b_uring_submit(out->ring, out->fd, block_idx, IORING_OP_WRITE_FIXED, (off_t) -1, (block_idx + 1 < first + count) ? kTrue : kFalse);
+    c2b_uring_enter(out->ring, (unsigned int) count, 0);
+
+    out->batch_first = first;
+    out->batch_count = count;
+}
+
+static void
+c2b_output_flush_batch(c2b_output_t *out)
+{
+    c2b_io_block_t *block = NULL;
+    size_t block_idx = 0;
+    ssize_t bytes_written = 0;
+    ssize_t res = 0;
+    int errsv = 0;
+
+    while (out->ring->in_flight > 0)
+        c2b_uring_reap(out->ring);
+
+    /* 
+       A short write cancels the rest of its chain, so we finish off that 
+       block, and any blocks after it, with plain write() calls
+    */
+
+    for (block_idx = out->batch_first; block_idx < out->batch_first + out->batch_count; block_idx++) {
+        block = &out->ring->blocks[block_idx];
+        bytes_written = (block->result > 0) ? block->result : 0;
+        while (bytes_written < block->len) {
+            res = write(out->fd, block->buf + bytes_written, block->len - bytes_written);
+            if ((res == -1) && (errno == EINTR))
+                continue;
+            if (res <= 0) {
+                errsv = (res == 0) ? EIO : errno;
+                fprintf(stderr, "Error: Could not write output (%s)\n", strerror(errsv));
+                c2b_print_usage(stderr);
+                exit(errsv);
+            }
+            bytes_written += res;
+        }
+        block->len = 0;
+        block->state = IO_BLOCK_IDLE;
+    }
+    out->batch_count = 0;
+}
+#endif
+
 static void
 c2b_memrchr_offset(ssize_t *offset, char *buf, ssize_t buf_size, ssize_t len, char delim)
 {
-    ssize_t left = len;
-    
+    char *delim_ptr = NULL;
+
     *offset = -1;
-    if (len > buf_size)
+    if ((len > buf_size) || (len <= 0))
         return;
 
-    while (left > 0) {
-        if (buf[left - 1] == delim) {
-            *offset = left;
-            return;
-        }
-        left--;
+#ifdef C2B_HAVE_MEMRCHR
+    delim_ptr = memrchr(buf, delim, len);
+#else
+    for (delim_ptr = buf + len - 1; (delim_ptr >= buf) && (*delim_ptr != delim); delim_ptr--) {}
+    if (delim_ptr < buf)
+        delim_ptr = NULL;
+#endif
+
+    if (delim_ptr)
+        *offset = delim_ptr - buf + 1;
+}
+
+static long
+c2b_pipe_capacity()
+{
+    long capacity = (long) c2b_globals.io_buffer_size;
+    long pipe_max_size = 0;
+    FILE *pipe_max_size_stream = NULL;
+
+    /* 
+       Unprivileged processes cannot grow a pipe past pipe-max-size (1 MB by 
+       default), so we aim no higher than that
+    */
+
+    if ((pipe_max_size_stream = fopen("/proc/sys/fs/pipe-max-size", "r")) != NULL) {
+        if ((fscanf(pipe_max_size_stream, "%ld", &pipe_max_size) == 1) && (pipe_max_size > 0) && (capacity > pipe_max_size))
+            capacity = pipe_max_size;
+        fclose(pipe_max_size_stream);
     }
+
+    return capacity;
+}
+
+static void
+c2b_set_pipe_capacity(int fd, long capacity)
+{
+#ifdef F_SETPIPE_SZ
+    long current_capacity = fcntl(fd, F_GETPIPE_SZ);
+
+    /* 
+       Pipes start out at 64 kB. Growing one fails once the user is over their 
+       pipe buffer quota, in which case we settle for a smaller size. Pipes 
+       are never shrunk, and anything that is not a pipe is left alone.
+    */
+
+    if (current_capacity == -1)
+        return;
+
+    while ((capacity > current_capacity) && (fcntl(fd, F_SETPIPE_SZ, capacity) == -1))
+        capacity /= 2;
+#else
+    (void) fd;
+    (void) capacity;
+#endif
 }
 
 static void
@@ -3898,6 +5624,7 @@ c2b_init_pipeset(c2b_pipeset_t *p, const size_t num)
     int **outs = NULL;
     int **errs = NULL;
     size_t n;
+    long pipe_capacity = c2b_pipe_capacity();
 
     ins = malloc(num * sizeof(int *));
     outs = malloc(num * sizeof(int *));
@@ -3940,6 +5667,10 @@ c2b_init_pipeset(c2b_pipeset_t *p, const size_t num)
 	c2b_pipe4_cloexec(p->out[n]);
 	c2b_pipe4_cloexec(p->err[n]);
 
+        /* grow the pipes that carry data between stages */
+        c2b_set_pipe_capacity(p->in[n][PIPE_WRITE], pipe_capacity);
+        c2b_set_pipe_capacity(p->out[n][PIPE_WRITE], pipe_capacity);
+
         /* set stderr as output for each err write */
         p->err[n][PIPE_WRITE] = STDERR_FILENO;
     }
@@ -3980,6 +5711,22 @@ c2b_debug_pipeset(c2b_pipeset_t *p, const size_t num)
     }
 }
 
+#if defined(__GNUC__)
+static void c2b_debug_args() __attribute__ ((unused));
+#endif
+
+static void
+c2b_debug_args(const char *name, char * const args[])
+{
+    size_t n;
+
+    fprintf(stderr, "Debug: %s:", name);
+    for (n = 0; args[n]; n++) {
+        fprintf(stderr, " [%s]", args[n]);
+    }
+    fprintf(stderr, "\n");
+}
+
 static void
 c2b_delete_pipeset(c2b_pipeset_t *p)
 {
@@ -4009,12 +5756,6 @@ c2b_set_close_exec_flag(int fd)
     fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
 }
 
-static void
-c2b_unset_close_exec_flag(int fd)
-{
-    fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) & ~FD_CLOEXEC);
-}
-
 static int
 c2b_pipe4(int fd[2], int flags)
 {
@@ -4029,64 +5770,58 @@ c2b_pipe4(int fd[2], int flags)
 }
 
 static pid_t
-c2b_popen4(const char* cmd, int pin[2], int pout[2], int perr[2], int flags)
+c2b_popen4(char * const args[], int pin[2], int pout[2], int perr[2], int flags)
 {
-    pid_t ret = fork();
-    int execl_ret = 0;
+    pid_t ret = 0;
+    posix_spawn_file_actions_t actions;
+    int spawn_ret = 0;
 
-    if (ret < 0) {
-        fprintf(stderr, "fork() failed!\n");
-        return ret;
-    } 
-    else if (ret == 0) {
-        /* 
-           Child-side of fork
-        */
-        if (flags & POPEN4_FLAG_CLOSE_CHILD_STDIN) {
-            close(STDIN_FILENO);
-        }
-        else {
-            c2b_unset_close_exec_flag(pin[PIPE_READ]);
-            dup2(pin[PIPE_READ], STDIN_FILENO);
-        }
-        if (flags & POPEN4_FLAG_CLOSE_CHILD_STDOUT) {
-            close(STDOUT_FILENO);
-        }
-        else {
-            c2b_unset_close_exec_flag(pout[PIPE_WRITE]);
-            dup2(pout[PIPE_WRITE], STDOUT_FILENO);
-        }
-        if (flags & POPEN4_FLAG_CLOSE_CHILD_STDERR) {
-            close(STDERR_FILENO);
-        }
-        else {
-            c2b_unset_close_exec_flag(perr[PIPE_WRITE]);
-            dup2(perr[PIPE_WRITE], STDERR_FILENO);
-        }
-        execl_ret = execl("/bin/sh", "/bin/sh", "-c", cmd, NULL);
-        if (execl_ret == -1) {
-            int errsv = errno;
-            fprintf(stderr, "Error: exec() failed (%d)\n", errsv);
-            exit(errsv);
-        }
+    /* 
+       We spawn the command directly from its argument vector, without a shell
+       in between. posix_spawn() does not copy the parent's address space as 
+       fork() would, which keeps start-up cheap however large this process is.
+       File actions run in the child: a dup2() onto a standard stream clears
+       its close-on-exec flag, while every other pipe end stays close-on-exec.
+    */
+
+    posix_spawn_file_actions_init(&actions);
+    if (flags & POPEN4_FLAG_CLOSE_CHILD_STDIN) {
+        posix_spawn_file_actions_addclose(&actions, STDIN_FILENO);
     }
-    else {
-        /* 
-           Parent-side of fork
-        */
-        if (~flags & POPEN4_FLAG_NOCLOSE_PARENT_STDIN && ~flags & POPEN4_FLAG_CLOSE_CHILD_STDIN) {
-            close(pin[PIPE_READ]);
-        }
-        if (~flags & POPEN4_FLAG_NOCLOSE_PARENT_STDOUT && ~flags & POPEN4_FLAG_CLOSE_CHILD_STDOUT) {
-            close(pout[PIPE_WRITE]);
-        }
-        if (~flags & POPEN4_FLAG_NOCLOSE_PARENT_STDERR && ~flags & POPEN4_FLAG_CLOSE_CHILD_STDERR) {
-            //close(perr[PIPE_WRITE]);
-        }
-        return ret;
+    else if (pin[PIPE_READ] != STDIN_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, pin[PIPE_READ], STDIN_FILENO);
+    }
+    if (flags & POPEN4_FLAG_CLOSE_CHILD_STDOUT) {
+        posix_spawn_file_actions_addclose(&actions, STDOUT_FILENO);
+    }
+    else if (pout[PIPE_WRITE] != STDOUT_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, pout[PIPE_WRITE], STDOUT_FILENO);
+    }
+    if (flags & POPEN4_FLAG_CLOSE_CHILD_STDERR) {
+        posix_spawn_file_actions_addclose(&actions, STDERR_FILENO);
+    }
+    else if (perr[PIPE_WRITE] != STDERR_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, perr[PIPE_WRITE], STDERR_FILENO);
+    }
+
+    spawn_ret = posix_spawn(&ret, args[0], &actions, NULL, args, environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (spawn_ret != 0) {
+        fprintf(stderr, "Error: posix_spawn() failed for [%s] (%d)\n", args[0], spawn_ret);
+        exit(spawn_ret);
+    }
+
+    if (~flags & POPEN4_FLAG_NOCLOSE_PARENT_STDIN && ~flags & POPEN4_FLAG_CLOSE_CHILD_STDIN) {
+        close(pin[PIPE_READ]);
+    }
+    if (~flags & POPEN4_FLAG_NOCLOSE_PARENT_STDOUT && ~flags & POPEN4_FLAG_CLOSE_CHILD_STDOUT) {
+        close(pout[PIPE_WRITE]);
+    }
+    if (~flags & POPEN4_FLAG_NOCLOSE_PARENT_STDERR && ~flags & POPEN4_FLAG_CLOSE_CHILD_STDERR) {
+        //close(perr[PIPE_WRITE]);
     }
 
-    /* Unreachable */
     return ret;
 }
 
@@ -4130,115 +5865,19 @@ c2b_test_dependencies()
             c2b_print_usage(stderr);
             exit(ENOMEM); /* Not enough space (POSIX.1) */
         }
-        memcpy(path_samtools, path, strlen(path) + 1);
-
-#ifdef DEBUG
-        fprintf(stderr, "Debug: Searching [%s] for samtools\n", path_samtools);
-#endif
-
-        if (c2b_print_matches(path_samtools, samtools) != kTrue) {
-            fprintf(stderr, "Error: Cannot find samtools binary required for conversion of BAM and SAM format\n");
-            c2b_print_usage(stderr);
-            exit(ENOENT); /* No such file or directory (POSIX.1) */
-        }
-        free(path_samtools), path_samtools = NULL;
-        free(samtools), samtools = NULL;
-    }
-
-    if (c2b_globals.sort->is_enabled) {
-        char *sort_bed = NULL;
-        sort_bed = malloc(strlen(c2b_sort_bed) + 1);
-        if (!sort_bed) {
-            fprintf(stderr, "Error: Cannot allocate space for sort-bed variable copy\n");
-            c2b_print_usage(stderr);
-            exit(ENOMEM); /* Not enough space (POSIX.1) */
-        }
-        memcpy(sort_bed, c2b_sort_bed, strlen(c2b_sort_bed) + 1);
-
-        char *path_sort_bed = NULL;
-        path_sort_bed = malloc(strlen(path) + 1);
-        if (!path_sort_bed) {
-            fprintf(stderr, "Error: Cannot allocate space for path (samtools) copy\n");
-            c2b_print_usage(stderr);
-            exit(ENOMEM); /* Not enough space (POSIX.1) */
-        }
-        memcpy(path_sort_bed, path, strlen(path) + 1);
-
-#ifdef DEBUG
-        fprintf(stderr, "Debug: Searching [%s] for sort-bed\n", path_sort_bed);
-#endif
-
-        if (c2b_print_matches(path_sort_bed, sort_bed) != kTrue) {
-            fprintf(stderr, "Error: Cannot find sort-bed binary required for sorting BED output\n");
-            c2b_print_usage(stderr);
-            exit(ENOENT); /* No such file or directory (POSIX.1) */
-        }
-        free(path_sort_bed), path_sort_bed = NULL;
-        free(sort_bed), sort_bed = NULL;
-    }
-
-    if (c2b_globals.output_format_idx == STARCH_FORMAT) {
-        char *starch = NULL;
-        starch = malloc(strlen(c2b_starch) + 1);
-        if (!starch) {
-            fprintf(stderr, "Error: Cannot allocate space for starch variable copy\n");
-            c2b_print_usage(stderr);
-            exit(ENOMEM); /* Not enough space (POSIX.1) */
-        }
-        memcpy(starch, c2b_starch, strlen(c2b_starch) + 1);
-
-        char *path_starch = NULL;
-        path_starch = malloc(strlen(path) + 1);
-        if (!path_starch) {
-            fprintf(stderr, "Error: Cannot allocate space for path (starch) copy\n");
-            c2b_print_usage(stderr);
-            exit(ENOMEM); /* Not enough space (POSIX.1) */
-        }
-        memcpy(path_starch, path, strlen(path) + 1);
-
-#ifdef DEBUG
-        fprintf(stderr, "Debug: Searching [%s] for starch\n", path_starch);
-#endif
-
-        if (c2b_print_matches(path_starch, starch) != kTrue) {
-            fprintf(stderr, "Error: Cannot find starch binary required for compression of BED output\n");
-            c2b_print_usage(stderr);
-            exit(ENOENT); /* No such file or directory (POSIX.1) */
-        }
-        free(path_starch), path_starch = NULL;
-        free(starch), starch = NULL;
-    }
-
-    if (c2b_globals.input_format_idx != BAM_FORMAT) {
-        char *cat = NULL;
-        cat = malloc(strlen(c2b_cat) + 1);
-        if (!cat) {
-            fprintf(stderr, "Error: Cannot allocate space for cat variable copy\n");
-            c2b_print_usage(stderr);
-            exit(ENOMEM); /* Not enough space (POSIX.1) */
-        }
-        memcpy(cat, c2b_cat, strlen(c2b_cat) + 1);
-        
-        char *path_cat = NULL;
-        path_cat = malloc(strlen(path) + 1);
-        if (!path_cat) {
-            fprintf(stderr, "Error: Cannot allocate space for path (cat) copy\n");
-            c2b_print_usage(stderr);
-            exit(ENOMEM); /* Not enough space (POSIX.1) */
-        }
-        memcpy(path_cat, path, strlen(path) + 1);
-        
+        memcpy(path_samtools, path, strlen(path) + 1);
+
 #ifdef DEBUG
-        fprintf(stderr, "Debug: Searching [%s] for cat\n", path_cat);
+        fprintf(stderr, "Debug: Searching [%s] for samtools\n", path_samtools);
 #endif
-        
-        if (c2b_print_matches(path_cat, cat) != kTrue) {
-            fprintf(stderr, "Error: Cannot find cat binary required for piping IO\n");
+
+        if (c2b_print_matches(path_samtools, samtools) != kTrue) {
+            fprintf(stderr, "Error: Cannot find samtools binary required for conversion of BAM and SAM format\n");
             c2b_print_usage(stderr);
             exit(ENOENT); /* No such file or directory (POSIX.1) */
         }
-        free(path_cat), path_cat = NULL;
-        free(cat), cat = NULL;
+        free(path_samtools), path_samtools = NULL;
+        free(samtools), samtools = NULL;
     }
 
     free(path), path = NULL;
@@ -4281,35 +5920,6 @@ c2b_print_matches(char *path, char *fn)
                 memcpy(c2b_globals.sam->samtools_path, candidate, strlen(candidate));
                 c2b_globals.sam->samtools_path[strlen(candidate)] = '\0';
             }
-            else if (strcmp(fn, c2b_sort_bed) == 0) {
-                c2b_globals.sort->sort_bed_path = malloc(strlen(candidate) + 1);
-                if (!c2b_globals.sort->sort_bed_path) {
-                    fprintf(stderr, "Error: Could not allocate space for storing sortbed path global\n");
-                    c2b_print_usage(stderr);
-                    exit(ENOMEM); /* Not enough space (POSIX.1) */
-                }
-                memcpy(c2b_globals.sort->sort_bed_path, candidate, strlen(candidate));
-                c2b_globals.sort->sort_bed_path[strlen(candidate)] = '\0';
-            }
-            else if (strcmp(fn, c2b_starch) == 0) {
-                c2b_globals.starch->path = malloc(strlen(candidate) + 1);
-                if (!c2b_globals.starch->path) {
-                    fprintf(stderr, "Error: Could not allocate space for storing starch path global\n");
-                    c2b_print_usage(stderr);
-                    exit(ENOMEM); /* Not enough space (POSIX.1) */
-                }
-                memcpy(c2b_globals.starch->path, candidate, strlen(candidate));
-                c2b_globals.starch->path[strlen(candidate)] = '\0';
-            }
-            else if (strcmp(fn, c2b_cat) == 0) {
-                c2b_globals.cat->path = malloc(strlen(candidate) + 1);
-                if (!c2b_globals.cat->path) {
-                    fprintf(stderr, "Errrpr: Could not allocate space for storing cat path global\n");
-                    exit(ENOMEM); /* Not enough space (POSIX.1) */
-                }
-                memcpy(c2b_globals.cat->path, candidate, strlen(candidate));
-                c2b_globals.cat->path[strlen(candidate)] = '\0';
-            }
             break;
         }
     }
@@ -4392,15 +6002,14 @@ c2b_init_globals()
     c2b_globals.keep_header_flag = kFalse;
     c2b_globals.split_flag = kFalse;
     c2b_globals.zero_indexed_flag = kFalse;
-    c2b_globals.header_line_idx = 0U;
-    c2b_globals.gff = NULL, c2b_init_global_gff_state();
-    c2b_globals.gtf = NULL, c2b_init_global_gtf_state();
-    c2b_globals.psl = NULL, c2b_init_global_psl_state();
-    c2b_globals.rmsk = NULL, c2b_init_global_rmsk_state();
+    c2b_globals.num_threads = 1U;
+    c2b_globals.io_engine = POSIX_IO_ENGINE;
+    c2b_globals.io_buffer_size = C2B_IO_BUFFER_DEFAULT_VALUE;
+    c2b_globals.src_map = NULL;
+    c2b_globals.wig_basename = NULL;
+    c2b_globals.tokenize_lines = NULL, c2b_init_tokenizer();
     c2b_globals.sam = NULL, c2b_init_global_sam_state();
     c2b_globals.vcf = NULL, c2b_init_global_vcf_state(); 
-    c2b_globals.wig = NULL, c2b_init_global_wig_state();
-    c2b_globals.cat = NULL, c2b_init_global_cat_params();
     c2b_globals.sort = NULL, c2b_init_global_sort_params();
     c2b_globals.starch = NULL, c2b_init_global_starch_params();
 
@@ -4422,17 +6031,13 @@ c2b_delete_globals()
     c2b_globals.all_reads_flag = kFalse;
     c2b_globals.keep_header_flag = kFalse;
     c2b_globals.split_flag = kFalse;
-    c2b_globals.header_line_idx = 0U;
-    if (c2b_globals.gff) c2b_delete_global_gff_state();
-    if (c2b_globals.gtf) c2b_delete_global_gtf_state();
-    if (c2b_globals.psl) c2b_delete_global_psl_state();
-    if (c2b_globals.rmsk) c2b_delete_global_rmsk_state();
+    if (c2b_globals.wig_basename) free(c2b_globals.wig_basename), c2b_globals.wig_basename = NULL;
     if (c2b_globals.sam) c2b_delete_global_sam_state();
     if (c2b_globals.vcf) c2b_delete_global_vcf_state();
-    if (c2b_globals.wig) c2b_delete_global_wig_state();
-    if (c2b_globals.cat) c2b_delete_global_cat_params();
     if (c2b_globals.sort) c2b_delete_global_sort_params();
     if (c2b_globals.starch) c2b_delete_global_starch_params();
+    if (c2b_globals.src_map) c2b_delete_global_src_map();
+    c2b_globals.num_threads = 1U;
 
 #ifdef DEBUG
     fprintf(stderr, "--- c2b_delete_globals() - exit  ---\n");
@@ -4440,186 +6045,254 @@ c2b_delete_globals()
 }
 
 static void
-c2b_init_global_gff_state()
+c2b_init_global_converter_options()
 {
 #ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_gff_state() - enter ---\n");
+    fprintf(stderr, "--- c2b_init_global_converter_options() - enter ---\n");
 #endif
 
-    c2b_globals.gff = malloc(sizeof(c2b_gff_state_t));
-    if (!c2b_globals.gff) {
-        fprintf(stderr, "Error: Could not allocate space for GFF state global\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
+    c2b_converter_options_t *options = &c2b_globals.converter_options;
 
-    c2b_globals.gff->id = malloc(C2B_MAX_FIELD_LENGTH_VALUE);
-    if (!c2b_globals.gff->id) {
-        fprintf(stderr, "Error: Could not allocate space for GFF ID global\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
-    memset(c2b_globals.gff->id, 0, C2B_MAX_FIELD_LENGTH_VALUE);
+    options->all_reads_flag = c2b_globals.all_reads_flag;
+    options->keep_header_flag = c2b_globals.keep_header_flag;
+    options->header_sort_order_flag = ((c2b_globals.sort->is_enabled) && (c2b_globals.sort->order == HEADER_SORT_ORDER)) ? kTrue : kFalse;
+    options->split_flag = c2b_globals.split_flag;
+    options->zero_indexed_flag = c2b_globals.zero_indexed_flag;
+    options->psl_is_headered = kTrue;
+    options->vcf = c2b_globals.vcf;
+    options->wig_basename = c2b_globals.wig_basename;
+    options->wig_start_shift = (c2b_globals.zero_indexed_flag ? 0 : 1);
+    options->wig_end_shift = (c2b_globals.zero_indexed_flag ? 0 : 1);
 
 #ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_gff_state() - exit  ---\n");
+    fprintf(stderr, "--- c2b_init_global_converter_options() - exit  ---\n");
 #endif
 }
 
-static void             
-c2b_delete_global_gff_state()
+static void
+c2b_init_context(c2b_context_t *ctx, const c2b_converter_options_t *options)
 {
 #ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_gff_state() - enter ---\n");
+    fprintf(stderr, "--- c2b_init_context() - enter ---\n");
 #endif
 
-    if (c2b_globals.gff->id)
-        free(c2b_globals.gff->id), c2b_globals.gff->id = NULL;
-
-    free(c2b_globals.gff), c2b_globals.gff = NULL;
+    ctx->options = options;
+    ctx->header_line_idx = 0U;
+    ctx->cigar = NULL, c2b_sam_init_cigar_ops(&(ctx->cigar), C2B_MAX_OPERATIONS_VALUE);
+    c2b_init_field_arena(&(ctx->fields));
+    c2b_init_gtf_state(&(ctx->gtf));
+    c2b_init_psl_state(&(ctx->psl));
+    c2b_init_rmsk_state(&(ctx->rmsk));
+    c2b_init_wig_state(&(ctx->wig), options->wig_basename);
 
 #ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_gff_state() - exit  ---\n");
+    fprintf(stderr, "--- c2b_init_context() - exit  ---\n");
 #endif
 }
 
 static void
-c2b_init_global_gtf_state()
+c2b_delete_context(c2b_context_t *ctx)
 {
 #ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_gtf_state() - enter ---\n");
+    fprintf(stderr, "--- c2b_delete_context() - enter ---\n");
 #endif
 
-    c2b_globals.gtf = malloc(sizeof(c2b_gtf_state_t));
-    if (!c2b_globals.gtf) {
-        fprintf(stderr, "Error: Could not allocate space for GTF state global\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
-
-    c2b_globals.gtf->id = malloc(C2B_MAX_FIELD_LENGTH_VALUE);
-    if (!c2b_globals.gtf->id) {
-        fprintf(stderr, "Error: Could not allocate space for GTF ID global\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
-    memset(c2b_globals.gtf->id, 0, C2B_MAX_FIELD_LENGTH_VALUE);
+    if (ctx->cigar)
+        c2b_sam_delete_cigar_ops(ctx->cigar), ctx->cigar = NULL;
+    c2b_delete_field_arena(&(ctx->fields));
+    c2b_delete_gtf_state(&(ctx->gtf));
+    c2b_delete_psl_state(&(ctx->psl));
+    c2b_delete_wig_state(&(ctx->wig));
+    ctx->header_line_idx = 0U;
+    ctx->options = NULL;
 
 #ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_gtf_state() - exit  ---\n");
+    fprintf(stderr, "--- c2b_delete_context() - exit  ---\n");
 #endif
 }
 
-static void             
-c2b_delete_global_gtf_state()
+static void
+c2b_init_field_arena(c2b_field_arena_t *arena)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_gtf_state() - enter ---\n");
-#endif
-
-    if (c2b_globals.gtf->id)
-        free(c2b_globals.gtf->id), c2b_globals.gtf->id = NULL;
+    arena->buf = malloc(C2B_FIELD_BUFFER_VALUE);
+    if (!arena->buf) {
+        fprintf(stderr, "Error: Could not allocate space for field arena\n");
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    arena->len = sizeof(char *);
+    arena->capacity = C2B_FIELD_BUFFER_VALUE;
+    arena->retired = NULL;
+}
 
-    free(c2b_globals.gtf), c2b_globals.gtf = NULL;
+static void
+c2b_delete_field_arena(c2b_field_arena_t *arena)
+{
+    char *next = NULL;
 
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_gtf_state() - exit  ---\n");
-#endif
+    while (arena->retired) {
+        next = *((char **) arena->retired);
+        free(arena->retired), arena->retired = next;
+    }
+    if (arena->buf)
+        free(arena->buf), arena->buf = NULL;
+    arena->len = 0;
+    arena->capacity = 0;
 }
 
 static void
-c2b_init_global_psl_state()
+c2b_reset_fields(c2b_context_t *ctx)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_psl_state() - enter ---\n");
-#endif
+    c2b_field_arena_t *arena = &(ctx->fields);
+    char *next = NULL;
 
-    c2b_globals.psl = malloc(sizeof(c2b_psl_state_t));
-    if (!c2b_globals.psl) {
-        fprintf(stderr, "Error: Could not allocate space for PSL state global\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    while (arena->retired) {
+        next = *((char **) arena->retired);
+        free(arena->retired), arena->retired = next;
     }
+    arena->len = sizeof(char *);
+}
 
-    c2b_globals.psl->is_headered = kTrue;
+static char *
+c2b_alloc_field(c2b_context_t *ctx, ssize_t size)
+{
+    c2b_field_arena_t *arena = &(ctx->fields);
+    ssize_t capacity = arena->capacity;
+    char *field = NULL;
 
-    c2b_globals.psl->block = NULL;
-    c2b_globals.psl->block = malloc(sizeof(c2b_psl_block_t));
-    if (!c2b_globals.psl->block) {
-        fprintf(stderr, "Error: Could not allocate space for PSL block state global\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    /*
+       Returns space for size bytes and a terminating NUL. A full arena is 
+       retired rather than moved, as earlier fields may still point into it.
+       The first bytes of each arena buffer link it into the retired list.
+    */
+
+    if (arena->len + size + 1 > arena->capacity) {
+        while ((ssize_t) sizeof(char *) + size + 1 > capacity)
+            capacity *= 2;
+        capacity *= 2;
+        field = malloc(capacity);
+        if (!field) {
+            fprintf(stderr, "Error: Could not grow field arena to %zd bytes.\n", capacity);
+            c2b_print_usage(stderr);
+            exit(ENOMEM); /* Not enough space (POSIX.1) */
+        }
+        if (arena->len > (ssize_t) sizeof(char *)) {
+            *((char **) arena->buf) = arena->retired;
+            arena->retired = arena->buf;
+        }
+        else {
+            free(arena->buf);
+        }
+        arena->buf = field;
+        arena->len = sizeof(char *);
+        arena->capacity = capacity;
     }
 
-    c2b_globals.psl->block->max_count = 0;
+    field = arena->buf + arena->len;
+    arena->len += size + 1;
+
+    return field;
+}
+
+static inline char *
+c2b_copy_field(c2b_context_t *ctx, const char *src, ssize_t size)
+{
+    char *field = c2b_alloc_field(ctx, size);
+
+    memcpy(field, src, size);
+    field[size] = '\0';
+
+    return field;
+}
+
+static void
+c2b_grow_buffer(char **buf, ssize_t *capacity, ssize_t size, const char *description)
+{
+    ssize_t new_capacity = (*capacity > 0) ? *capacity : size;
+    char *new_buf = NULL;
+
+    if (size <= *capacity)
+        return;
+
+    while (size > new_capacity)
+        new_capacity *= 2;
 
-    c2b_globals.psl->block->sizes = NULL;
-    c2b_globals.psl->block->sizes = malloc(sizeof(uint64_t) * C2B_MAX_PSL_BLOCKS);
-    if (!c2b_globals.psl->block->sizes) {
-        fprintf(stderr, "Error: Could not allocate space for PSL block state sizes global\n");
+    new_buf = realloc(*buf, new_capacity);
+    if (!new_buf) {
+        fprintf(stderr, "Error: Could not grow %s to %zd bytes.\n", description, new_capacity);
+        c2b_print_usage(stderr);
         exit(ENOMEM); /* Not enough space (POSIX.1) */
     }
+    *buf = new_buf;
+    *capacity = new_capacity;
+}
 
-    c2b_globals.psl->block->starts = NULL;
-    c2b_globals.psl->block->starts = malloc(sizeof(uint64_t) * C2B_MAX_PSL_BLOCKS);
-    if (!c2b_globals.psl->block->starts) {
-        fprintf(stderr, "Error: Could not allocate space for PSL block state starts global\n");
+static void
+c2b_init_gtf_state(c2b_gtf_state_t *gtf)
+{
+    gtf->id = malloc(C2B_FIELD_BUFFER_VALUE);
+    if (!gtf->id) {
+        fprintf(stderr, "Error: Could not allocate space for GTF ID state\n");
         exit(ENOMEM); /* Not enough space (POSIX.1) */
     }
-
-    c2b_globals.psl->block->max_count = C2B_MAX_PSL_BLOCKS;
-
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_psl_state() - exit  ---\n");
-#endif
+    memset(gtf->id, 0, C2B_FIELD_BUFFER_VALUE);
+    gtf->id_capacity = C2B_FIELD_BUFFER_VALUE;
+    gtf->id_size = 0;
 }
 
 static void             
-c2b_delete_global_psl_state()
+c2b_delete_gtf_state(c2b_gtf_state_t *gtf)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_psl_state() - enter ---\n");
-#endif
-
-    free(c2b_globals.psl->block->starts), c2b_globals.psl->block->starts = NULL;
-    free(c2b_globals.psl->block->sizes), c2b_globals.psl->block->sizes = NULL;
-    c2b_globals.psl->block->max_count = 0;
-    free(c2b_globals.psl->block), c2b_globals.psl->block = NULL;
-    free(c2b_globals.psl), c2b_globals.psl = NULL;
-
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_psl_state() - exit  ---\n");
-#endif
+    if (gtf->id)
+        free(gtf->id), gtf->id = NULL;
 }
 
 static void
-c2b_init_global_rmsk_state()
+c2b_init_psl_state(c2b_psl_state_t *psl)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_rmsk_state() - enter ---\n");
-#endif
+    psl->block = NULL;
+    psl->block = malloc(sizeof(c2b_psl_block_t));
+    if (!psl->block) {
+        fprintf(stderr, "Error: Could not allocate space for PSL block state\n");
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+
+    psl->block->max_count = 0;
 
-    c2b_globals.rmsk = malloc(sizeof(c2b_rmsk_state_t));
-    if (!c2b_globals.rmsk) {
-        fprintf(stderr, "Error: Could not allocate space for RepeatMasker annotation state global\n");
+    psl->block->sizes = NULL;
+    psl->block->sizes = malloc(sizeof(uint64_t) * C2B_MAX_PSL_BLOCKS);
+    if (!psl->block->sizes) {
+        fprintf(stderr, "Error: Could not allocate space for PSL block state sizes\n");
         exit(ENOMEM); /* Not enough space (POSIX.1) */
     }
 
-    c2b_globals.rmsk->line = 0U;
-    c2b_globals.rmsk->is_start_of_line = kTrue;
-    c2b_globals.rmsk->is_start_of_gap = kFalse;
+    psl->block->starts = NULL;
+    psl->block->starts = malloc(sizeof(uint64_t) * C2B_MAX_PSL_BLOCKS);
+    if (!psl->block->starts) {
+        fprintf(stderr, "Error: Could not allocate space for PSL block state starts\n");
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
 
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_rmsk_state() - exit  ---\n");
-#endif
+    psl->block->max_count = C2B_MAX_PSL_BLOCKS;
 }
 
 static void             
-c2b_delete_global_rmsk_state()
+c2b_delete_psl_state(c2b_psl_state_t *psl)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_rmsk_state() - enter ---\n");
-#endif
+    if (!psl->block)
+        return;
 
-    free(c2b_globals.rmsk), c2b_globals.rmsk = NULL;
+    free(psl->block->starts), psl->block->starts = NULL;
+    free(psl->block->sizes), psl->block->sizes = NULL;
+    psl->block->max_count = 0;
+    free(psl->block), psl->block = NULL;
+}
 
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_rmsk_state() - exit  ---\n");
-#endif
+static void
+c2b_init_rmsk_state(c2b_rmsk_state_t *rmsk)
+{
+    rmsk->line = 0U;
+    rmsk->is_start_of_line = kTrue;
+    rmsk->is_start_of_gap = kFalse;
 }
 
 static void
@@ -4637,8 +6310,6 @@ c2b_init_global_sam_state()
 
     c2b_globals.sam->samtools_path = NULL;
 
-    c2b_globals.sam->cigar = NULL, c2b_sam_init_cigar_ops(&(c2b_globals.sam->cigar), C2B_MAX_OPERATIONS_VALUE);
-
 #ifdef DEBUG
     fprintf(stderr, "--- c2b_init_global_sam_state() - exit  ---\n");
 #endif
@@ -4654,9 +6325,6 @@ c2b_delete_global_sam_state()
     if (c2b_globals.sam->samtools_path)
         free(c2b_globals.sam->samtools_path), c2b_globals.sam->samtools_path = NULL;
     
-    if (c2b_globals.sam->cigar)
-        c2b_sam_delete_cigar_ops(c2b_globals.sam->cigar);
-    
     free(c2b_globals.sam), c2b_globals.sam = NULL;
 
 #ifdef DEBUG
@@ -4703,111 +6371,47 @@ c2b_delete_global_vcf_state()
 }
 
 static void
-c2b_init_global_wig_state()
+c2b_init_wig_state(c2b_wig_state_t *wig, const char *basename)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_wig_state() - enter ---\n");
-#endif
-
-    c2b_globals.wig = malloc(sizeof(c2b_wig_state_t));
-    if (!c2b_globals.wig) {
-        fprintf(stderr, "Error: Could not allocate space for WIG state global\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
-
-    c2b_globals.wig->section = 1;
-    c2b_globals.wig->line = 0;
-    c2b_globals.wig->pos_lines = 0;
-    c2b_globals.wig->span = 0;
-    c2b_globals.wig->step = 0;
-    c2b_globals.wig->start_pos = 0;
-    c2b_globals.wig->end_pos = 0;
-    c2b_globals.wig->score = 0.0f;
-    c2b_globals.wig->chr = NULL;
-    c2b_globals.wig->id = NULL;
-    c2b_globals.wig->is_fixed_step = kFalse;
-    c2b_globals.wig->start_write = kFalse;
-    c2b_globals.wig->basename = NULL;
-    c2b_globals.wig->start_shift = 1;
-    c2b_globals.wig->end_shift = 1;
-
-    c2b_globals.wig->chr = malloc(C2B_MAX_CHROMOSOME_LENGTH);
-    if (!c2b_globals.wig->chr) {
-        fprintf(stderr, "Error: Could not allocate space for global WIG chromosome string\n");
+    wig->section = 1;
+    wig->line = 0;
+    wig->pos_lines = 0;
+    wig->span = 0;
+    wig->step = 0;
+    wig->start_pos = 0;
+    wig->end_pos = 0;
+    wig->score = 0.0f;
+    wig->chr = NULL;
+    wig->id = NULL;
+    wig->is_fixed_step = kFalse;
+    wig->start_write = kFalse;
+
+    wig->chr = malloc(C2B_FIELD_BUFFER_VALUE);
+    if (!wig->chr) {
+        fprintf(stderr, "Error: Could not allocate space for WIG chromosome string\n");
         exit(ENOMEM); /* Not enough space (POSIX.1) */
     }
-    memset(c2b_globals.wig->chr, 0, C2B_MAX_CHROMOSOME_LENGTH);
-
-    c2b_globals.wig->id = malloc(C2B_MAX_FIELD_LENGTH_VALUE);
-    if (!c2b_globals.wig->id) {
-        fprintf(stderr, "Error: Could not allocate space for global WIG ID string\n");
-        exit(ENOMEM); /* Not enough space (POSIX.1) */
-    }
-    memset(c2b_globals.wig->id, 0, C2B_MAX_FIELD_LENGTH_VALUE);
-
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_wig_state() - exit  ---\n");
-#endif
-}
-
-static void
-c2b_delete_global_wig_state()
-{
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_wig_state() - enter ---\n");
-#endif
-
-    if (c2b_globals.wig->chr)
-        free(c2b_globals.wig->chr), c2b_globals.wig->chr = NULL;
-
-    if (c2b_globals.wig->id)
-        free(c2b_globals.wig->id), c2b_globals.wig->id = NULL;
-
-    if (c2b_globals.wig->basename)
-        free(c2b_globals.wig->basename), c2b_globals.wig->basename = NULL;
-
-    free(c2b_globals.wig), c2b_globals.wig = NULL;
+    memset(wig->chr, 0, C2B_FIELD_BUFFER_VALUE);
+    wig->chr_capacity = C2B_FIELD_BUFFER_VALUE;
 
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_wig_state() - exit  ---\n");
-#endif
-}
-
-static void
-c2b_init_global_cat_params()
-{
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_cat_params() - enter ---\n");
-#endif
-
-    c2b_globals.cat = malloc(sizeof(c2b_cat_params_t));
-    if (!c2b_globals.cat) {
-        fprintf(stderr, "Error: Could not allocate space for cat parameters global\n");
+    /* section IDs are the basename followed by a section number */
+    wig->id_capacity = (basename ? (ssize_t) strlen(basename) : 0) + C2B_MAX_NUMERIC_SUFFIX_LENGTH_VALUE;
+    wig->id = malloc(wig->id_capacity);
+    if (!wig->id) {
+        fprintf(stderr, "Error: Could not allocate space for WIG ID string\n");
         exit(ENOMEM); /* Not enough space (POSIX.1) */
     }
-
-    c2b_globals.cat->path = NULL;
-
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_init_global_cat_params() - exit  ---\n");
-#endif
+    memset(wig->id, 0, wig->id_capacity);
 }
 
 static void
-c2b_delete_global_cat_params()
+c2b_delete_wig_state(c2b_wig_state_t *wig)
 {
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_cat_params() - enter ---\n");
-#endif
-
-    if (c2b_globals.cat->path)
-        free(c2b_globals.cat->path), c2b_globals.cat->path = NULL;
+    if (wig->chr)
+        free(wig->chr), wig->chr = NULL;
 
-    free(c2b_globals.cat), c2b_globals.cat = NULL;
-
-#ifdef DEBUG
-    fprintf(stderr, "--- c2b_delete_global_cat_params() - exit  ---\n");
-#endif
+    if (wig->id)
+        free(wig->id), wig->id = NULL;
 }
 
 static void
@@ -4824,9 +6428,9 @@ c2b_init_global_sort_params()
     }
 
     c2b_globals.sort->is_enabled = kTrue;
-    c2b_globals.sort->sort_bed_path = NULL;
-    c2b_globals.sort->max_mem_value = NULL;
+    c2b_globals.sort->max_mem = C2B_MAX_MEM_DEFAULT_VALUE;
     c2b_globals.sort->sort_tmpdir_path = NULL;
+    c2b_globals.sort->order = LEXICOGRAPHIC_SORT_ORDER;
 
 #ifdef DEBUG
     fprintf(stderr, "--- c2b_init_global_sort_params() - exit  ---\n");
@@ -4840,12 +6444,6 @@ c2b_delete_global_sort_params()
     fprintf(stderr, "--- c2b_delete_global_sort_params() - enter ---\n");
 #endif
 
-    if (c2b_globals.sort->max_mem_value)
-        free(c2b_globals.sort->max_mem_value), c2b_globals.sort->max_mem_value = NULL;
-
-    if (c2b_globals.sort->sort_bed_path)
-        free(c2b_globals.sort->sort_bed_path), c2b_globals.sort->sort_bed_path = NULL;
-
     if (c2b_globals.sort->sort_tmpdir_path)
         free(c2b_globals.sort->sort_tmpdir_path), c2b_globals.sort->sort_tmpdir_path = NULL;
 
@@ -4869,7 +6467,6 @@ c2b_init_global_starch_params()
         exit(ENOMEM); /* Not enough space (POSIX.1) */
     }
 
-    c2b_globals.starch->path = NULL;
     c2b_globals.starch->bzip2 = kFalse;
     c2b_globals.starch->gzip = kFalse;
     c2b_globals.starch->note = NULL;
@@ -4886,9 +6483,6 @@ c2b_delete_global_starch_params()
     fprintf(stderr, "--- c2b_delete_global_starch_params() - enter ---\n");
 #endif
 
-    if (c2b_globals.starch->path)
-        free(c2b_globals.starch->path), c2b_globals.starch->path = NULL;
-
     if (c2b_globals.starch->note)
         free(c2b_globals.starch->note), c2b_globals.starch->note = NULL;
 
@@ -4899,6 +6493,115 @@ c2b_delete_global_starch_params()
 #endif
 }
 
+static void
+c2b_init_global_src_map(struct stat *stats)
+{
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_init_global_src_map() - enter ---\n");
+#endif
+
+    c2b_mapped_input_t *src_map = NULL;
+    off_t src_offset = 0;
+    void *src_data = NULL;
+
+    /* 
+       Only regular files can be mapped; BAM input is read by samtools, which
+       takes stdin as it is. If anything goes wrong, we leave the map unset
+       and fall back to read() calls.
+    */
+
+    if ((!S_ISREG(stats->st_mode)) || (stats->st_size <= 0) || (c2b_globals.input_format_idx == BAM_FORMAT))
+        return;
+
+    /* reads through io_uring were asked for explicitly, so we leave stdin alone */
+    if (c2b_globals.io_engine == URING_IO_ENGINE)
+        return;
+
+    if ((uintmax_t) stats->st_size > (uintmax_t) SIZE_MAX)
+        return;
+
+    if ((src_offset = lseek(STDIN_FILENO, 0, SEEK_CUR)) == -1)
+        return;
+
+    src_data = mmap(NULL, (size_t) stats->st_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+    if (src_data == MAP_FAILED)
+        return;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+    madvise(src_data, (size_t) stats->st_size, MADV_SEQUENTIAL);
+    madvise(src_data, (size_t) stats->st_size, MADV_WILLNEED);
+#pragma GCC diagnostic pop
+
+    src_map = malloc(sizeof(c2b_mapped_input_t));
+    if (!src_map) {
+        fprintf(stderr, "Error: Could not allocate space for mapped input globals\n");
+        c2b_print_usage(stderr);
+        exit(ENOMEM); /* Not enough space (POSIX.1) */
+    }
+    src_map->data = (char *) src_data;
+    src_map->size = (size_t) stats->st_size;
+    src_map->offset = ((uintmax_t) src_offset < (uintmax_t) src_map->size) ? (size_t) src_offset : src_map->size;
+
+    c2b_globals.src_map = src_map;
+
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_init_global_src_map() - exit  ---\n");
+#endif
+}
+
+static void
+c2b_delete_global_src_map()
+{
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_delete_global_src_map() - enter ---\n");
+#endif
+
+    munmap(c2b_globals.src_map->data, c2b_globals.src_map->size);
+    free(c2b_globals.src_map), c2b_globals.src_map = NULL;
+
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_delete_global_src_map() - exit  ---\n");
+#endif
+}
+
+static char *
+c2b_next_mapped_lines(ssize_t *lines_size, ssize_t max_size)
+{
+    c2b_mapped_input_t *src_map = c2b_globals.src_map;
+    char *lines = src_map->data + src_map->offset;
+    char *line_end = NULL;
+    ssize_t window_size = 0;
+
+    /* 
+       Windows are capped at the size of a read() buffer, so that destination
+       buffers are sized as before. A window without any newline is stretched
+       to the end of its first line, however long that is. As with read() 
+       input, a trailing partial line is dropped.
+    */
+
+    window_size = ((src_map->size - src_map->offset) < (size_t) max_size) ? (ssize_t) (src_map->size - src_map->offset) : max_size;
+    if (window_size == 0)
+        return NULL;
+
+    c2b_memrchr_offset(lines_size, lines, max_size, window_size, '\n');
+
+    if ((*lines_size == -1) && (window_size == max_size)) {
+        line_end = memchr(lines + window_size, '\n', src_map->size - src_map->offset - window_size);
+        if (line_end)
+            *lines_size = line_end - lines + 1;
+    }
+
+    if (*lines_size == -1) {
+        src_map->offset = src_map->size;
+        return NULL;
+    }
+
+    src_map->offset += *lines_size;
+
+    return lines;
+}
+
 static void
 c2b_init_command_line_options(int argc, char **argv)
 {
@@ -4908,6 +6611,8 @@ c2b_init_command_line_options(int argc, char **argv)
 
     char *input_format = NULL;
     char *output_format = NULL;
+    unsigned long threads_val = 0;
+    char *threads_end = NULL;
     int client_long_index;
     int client_opt = getopt_long(argc,
                                  argv,
@@ -4945,23 +6650,30 @@ c2b_init_command_line_options(int argc, char **argv)
                 free(output_format), output_format = NULL;
                 break;
             case 'm':
-                c2b_globals.sort->max_mem_value = malloc(strlen(optarg) + 1);
-                if (!c2b_globals.sort->max_mem_value) {
-                    fprintf(stderr, "Error: Could not allocate space for sort-bed max-mem argument\n");
+                c2b_globals.sort->max_mem = c2b_to_max_mem(optarg);
+                if (c2b_globals.sort->max_mem == 0) {
+                    fprintf(stderr, "Error: Sort memory must be at least %d bytes (for example, 500M or 2G)\n", C2B_MAX_MEM_MIN_VALUE);
                     c2b_print_usage(stderr);
-                    exit(ENOMEM); /* Not enough space (POSIX.1) */
+                    exit(EINVAL); /* Invalid argument (POSIX.1) */
                 }
-                memcpy(c2b_globals.sort->max_mem_value, optarg, strlen(optarg) + 1);
                 break;
             case 'r':
                 c2b_globals.sort->sort_tmpdir_path = malloc(strlen(optarg) + 1);
                 if (!c2b_globals.sort->sort_tmpdir_path) {
-                    fprintf(stderr, "Error: Could not allocate space for sort-bed temporary directory argument\n");
+                    fprintf(stderr, "Error: Could not allocate space for sort temporary directory argument\n");
                     c2b_print_usage(stderr);
                     exit(ENOMEM); /* Not enough space (POSIX.1) */
                 }
                 memcpy(c2b_globals.sort->sort_tmpdir_path, optarg, strlen(optarg) + 1);
                 break;
+            case 'O':
+                c2b_globals.sort->order = c2b_to_sort_order(optarg);
+                if (c2b_globals.sort->order == UNDEFINED_SORT_ORDER) {
+                    fprintf(stderr, "Error: Sort order must be one of lexicographic, header or natural\n");
+                    c2b_print_usage(stderr);
+                    exit(EINVAL); /* Invalid argument (POSIX.1) */
+                }
+                break;
             case 'e':
                 c2b_globals.starch->note = malloc(strlen(optarg) + 1);
                 if (!c2b_globals.starch->note) {
@@ -4972,13 +6684,13 @@ c2b_init_command_line_options(int argc, char **argv)
                 memcpy(c2b_globals.starch->note, optarg, strlen(optarg) + 1);
                 break;
             case 'b':
-                c2b_globals.wig->basename = malloc(strlen(optarg) + 1);
-                if (!c2b_globals.wig->basename) {
+                c2b_globals.wig_basename = malloc(strlen(optarg) + 1);
+                if (!c2b_globals.wig_basename) {
                     fprintf(stderr, "Error: Could not allocate space for WIG basename\n");
                     c2b_print_usage(stderr);
                     exit(ENOMEM); /* Not enough space (POSIX.1) */
                 }
-                memcpy(c2b_globals.wig->basename, optarg, strlen(optarg) + 1);
+                memcpy(c2b_globals.wig_basename, optarg, strlen(optarg) + 1);
                 break;
             case 's':
                 c2b_globals.split_flag = kTrue;
@@ -5014,10 +6726,33 @@ c2b_init_command_line_options(int argc, char **argv)
                 c2b_globals.starch->gzip = kTrue;
                 break;
             case 'x':
-                c2b_globals.wig->start_shift = 0;
-                c2b_globals.wig->end_shift = 0;
                 c2b_globals.zero_indexed_flag = kTrue;
                 break;
+            case '@':
+                threads_val = strtoul(optarg, &threads_end, 10);
+                if ((*optarg == '\0') || (*threads_end != '\0') || (threads_val < 1) || (threads_val > C2B_MAX_THREADS_VALUE)) {
+                    fprintf(stderr, "Error: Thread count must be an integer between 1 and %d\n", C2B_MAX_THREADS_VALUE);
+                    c2b_print_usage(stderr);
+                    exit(EINVAL); /* Invalid argument (POSIX.1) */
+                }
+                c2b_globals.num_threads = (unsigned int) threads_val;
+                break;
+            case 'c':
+                c2b_globals.io_buffer_size = c2b_to_io_buffer_size(optarg);
+                if (c2b_globals.io_buffer_size == -1) {
+                    fprintf(stderr, "Error: I/O buffer size must be between %d and %d bytes (for example, 256K or 4M)\n", C2B_IO_BUFFER_MIN_VALUE, C2B_IO_BUFFER_MAX_VALUE);
+                    c2b_print_usage(stderr);
+                    exit(EINVAL); /* Invalid argument (POSIX.1) */
+                }
+                break;
+            case 'u':
+                c2b_globals.io_engine = c2b_to_io_engine(optarg);
+                if (c2b_globals.io_engine == UNDEFINED_IO_ENGINE) {
+                    fprintf(stderr, "Error: I/O engine must be one of posix or io_uring\n");
+                    c2b_print_usage(stderr);
+                    exit(EINVAL); /* Invalid argument (POSIX.1) */
+                }
+                break;
             case 'h':
                 c2b_print_usage(stdout);
                 exit(EXIT_SUCCESS);
@@ -5110,6 +6845,12 @@ c2b_init_command_line_options(int argc, char **argv)
         exit(EINVAL); /* Invalid argument (POSIX.1) */
     }
 
+    /* Starch archives hold sorted BED, so --do-not-sort is ignored */
+    if (c2b_globals.output_format_idx == STARCH_FORMAT)
+        c2b_globals.sort->is_enabled = kTrue;
+
+    c2b_init_global_converter_options();
+
 #ifdef DEBUG
     fprintf(stderr, "--- c2b_init_command_line_options() - exit  ---\n");
 #endif
@@ -5326,6 +7067,114 @@ c2b_to_input_format(const char *input_format)
         UNDEFINED_FORMAT;
 }
 
+static c2b_io_engine_t
+c2b_to_io_engine(const char *io_engine)
+{
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_to_io_engine() - enter ---\n");
+    fprintf(stderr, "--- c2b_to_io_engine() - exit  ---\n");
+#endif
+
+    return
+        (strcmp(io_engine, "posix") == 0) ? POSIX_IO_ENGINE :
+        (strcmp(io_engine, "io_uring") == 0) ? URING_IO_ENGINE :
+        UNDEFINED_IO_ENGINE;
+}
+
+static c2b_sort_order_t
+c2b_to_sort_order(const char *sort_order)
+{
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_to_sort_order() - enter ---\n");
+    fprintf(stderr, "--- c2b_to_sort_order() - exit  ---\n");
+#endif
+
+    return
+        (strcmp(sort_order, "lexicographic") == 0) ? LEXICOGRAPHIC_SORT_ORDER :
+        (strcmp(sort_order, "header") == 0) ? HEADER_SORT_ORDER :
+        (strcmp(sort_order, "natural") == 0) ? NATURAL_SORT_ORDER :
+        UNDEFINED_SORT_ORDER;
+}
+
+static ssize_t
+c2b_to_io_buffer_size(const char *io_buffer)
+{
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_to_io_buffer_size() - enter ---\n");
+    fprintf(stderr, "--- c2b_to_io_buffer_size() - exit  ---\n");
+#endif
+
+    char *io_buffer_end = NULL;
+    unsigned long long io_buffer_size = 0;
+
+    /* sizes are bytes, or KiB, MiB or GiB with a K, M or G suffix */
+    if (!isdigit((unsigned char) io_buffer[0]))
+        return -1;
+    io_buffer_size = strtoull(io_buffer, &io_buffer_end, 10);
+    if (io_buffer_size > C2B_IO_BUFFER_MAX_VALUE)
+        return -1;
+    switch (toupper((unsigned char) *io_buffer_end)) {
+        case 'G':
+            io_buffer_size <<= 10;
+            /* fall through */
+        case 'M':
+            io_buffer_size <<= 10;
+            /* fall through */
+        case 'K':
+            io_buffer_size <<= 10;
+            io_buffer_end++;
+            break;
+        default:
+            break;
+    }
+    if ((*io_buffer_end != '\0') || (io_buffer_size < C2B_IO_BUFFER_MIN_VALUE) || (io_buffer_size > C2B_IO_BUFFER_MAX_VALUE))
+        return -1;
+
+    return (ssize_t) io_buffer_size;
+}
+
+static size_t
+c2b_to_max_mem(const char *max_mem)
+{
+#ifdef DEBUG
+    fprintf(stderr, "--- c2b_to_max_mem() - enter ---\n");
+    fprintf(stderr, "--- c2b_to_max_mem() - exit  ---\n");
+#endif
+
+    char *max_mem_end = NULL;
+    unsigned long long max_mem_size = 0;
+    int shift = 0;
+
+    /* sizes are bytes, or KiB, MiB or GiB with a K, M or G suffix */
+    if (!isdigit((unsigned char) max_mem[0]))
+        return 0;
+    errno = 0;
+    max_mem_size = strtoull(max_mem, &max_mem_end, 10);
+    if (errno == ERANGE)
+        return 0;
+    switch (toupper((unsigned char) *max_mem_end)) {
+        case 'G':
+            shift += 10;
+            /* fall through */
+        case 'M':
+            shift += 10;
+            /* fall through */
+        case 'K':
+            shift += 10;
+            max_mem_end++;
+            break;
+        default:
+            break;
+    }
+    if ((*max_mem_end != '\0') || (max_mem_size > (SIZE_MAX >> shift)))
+        return 0;
+    max_mem_size <<= shift;
+    if (max_mem_size < C2B_MAX_MEM_MIN_VALUE)
+        return 0;
+
+    return (size_t) max_mem_size;
+}
+
 static c2b_format_t
 c2b_to_output_format(const char *output_format)
 {
@@ -25,6 +25,20 @@
 
 #define __STDC_FORMAT_MACROS
 
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#define C2B_HAVE_SPLICE
+#define C2B_HAVE_MEMRCHR
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define C2B_HAVE_IO_URING
+#endif
+#endif
+#endif
+
 #ifdef __cplusplus
 #include <cstdio>
 #include <cstdlib>
@@ -34,6 +48,10 @@
 #include <cctype>
 #include <cinttypes>
 #include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <climits>
+#include <ctime>
 #else
 #include <stdio.h>
 #include <stdlib.h>
@@ -43,13 +61,32 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <limits.h>
+#include <time.h>
 #endif
 #include <unistd.h>
 #include <pthread.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/wait.h>
+#include <sys/uio.h>
+#include <spawn.h>
+#include <bzlib.h>
+#include <zlib.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define C2B_HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 8))
+#define C2B_HAVE_LOOP_UNROLL
+#endif
+#ifdef C2B_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
 
 #define C2B_VERSION "1.6"
 
@@ -60,37 +97,65 @@ const boolean kTrue = 1;
 const boolean kFalse = 0;
 
 #define C2B_MAX_FIELD_COUNT_VALUE 64
-#define C2B_MAX_FIELD_LENGTH_VALUE 24576
-#define C2B_MAX_OPERATION_FIELD_LENGTH_VALUE 32
-#define C2B_MAX_STRAND_LENGTH_VALUE 4
-#define C2B_MAX_LINE_LENGTH_VALUE 131072
-#define C2B_MAX_LINES_VALUE 32
+#define C2B_FIELD_BUFFER_VALUE 4096
+#define C2B_MAX_NUMERIC_SUFFIX_LENGTH_VALUE 22
+#define C2B_MAX_UINT64_DIGITS_VALUE 20
+#define C2B_MIN_BATCH_VIEW_SIZE_VALUE 256
+#define C2B_MAX_IOVECS_VALUE 1024
 #define C2B_MAX_OPERATIONS_VALUE 32
-#define C2B_MAX_CHROMOSOME_LENGTH 32
 #define C2B_MAX_PSL_BLOCKS 1024
-#define C2B_MAX_PSL_BLOCK_SIZES_STRING_LENGTH 20
-#define C2B_MAX_PSL_T_STARTS_STRING_LENGTH 20
-
+#define C2B_IO_BUFFER_MIN_VALUE 131072
+#define C2B_IO_BUFFER_DEFAULT_VALUE 1048576
+#define C2B_IO_BUFFER_MAX_VALUE 268435456
+#define C2B_MAX_MEM_MIN_VALUE 1048576
+#define C2B_MAX_MEM_DEFAULT_VALUE 2147483648U
+#define C2B_MAX_SORT_RUNS_VALUE 256
+#define C2B_SORT_INSERTION_RUN_VALUE 16
+#define C2B_SORT_BUCKET_ARENA_MIN_VALUE 65536
+#define C2B_SORT_BUCKET_KEYS_MIN_VALUE 1024
+#define C2B_SORT_SLOTS_MIN_VALUE 1024
+#define C2B_SORT_UNRANKED_VALUE SIZE_MAX
+#define C2B_STARCH_BZIP2_BLOCK_SIZE_VALUE 9
+#define C2B_STARCH_ZLIB_LEVEL_VALUE 1
+#define C2B_STARCH_ZLIB_WINDOW_BITS_VALUE 15
+#define C2B_STARCH_ZLIB_MEM_LEVEL_VALUE 8
+#define C2B_STARCH_TRANSFORM_BUFFER_VALUE 262144
+#define C2B_STARCH_MAGIC_LENGTH_VALUE 4
+#define C2B_STARCH_FOOTER_LENGTH_VALUE 127
+#define C2B_STARCH_OFFSET_DIGITS_VALUE 20
+#define C2B_STARCH_HOSTNAME_LENGTH_VALUE 256
+#define C2B_STARCH_TIMESTAMP_LENGTH_VALUE 64
+#define C2B_SHA1_DIGEST_LENGTH_VALUE 20
+#define C2B_SHA1_BASE64_LENGTH_VALUE 28
+#define C2B_URING_DEPTH_VALUE 8
+#define C2B_URING_BLOCK_LENGTH_VALUE 1048576
+#define C2B_MAX_THREADS_VALUE 1024
+#define C2B_CHUNKS_PER_THREAD_VALUE 4
+#define C2B_MAX_ARGUMENTS_VALUE 16
+#define C2B_MAX_STAGES_VALUE 8
+#define C2B_MAX_STAGE_THREADS_VALUE (3 * C2B_MAX_STAGES_VALUE)
+#define C2B_BLOCK_LINES_VALUE 4096
+#define C2B_BLOCK_FIELDS_PER_LINE_VALUE 16
+
+extern char **environ;
 extern const char *c2b_samtools;
-extern const char *c2b_sort_bed;
-extern const char *c2b_starch;
-extern const char *c2b_cat;
+extern const char *c2b_sort_tmpdir_default;
+extern const char *c2b_sort_run_template;
 extern const char *c2b_default_output_format;
 extern const char *c2b_unmapped_read_chr_name;
 extern const char *c2b_header_chr_name;
-extern const char *sort_bed_max_mem_arg;
-extern const char *sort_bed_max_mem_default_arg;
-extern const char *sort_bed_tmpdir_arg;
-extern const char *sort_bed_stdin;
-extern const char *starch_bzip2_arg;
-extern const char *starch_gzip_arg;
-extern const char *starch_note_prefix_arg;
-extern const char *starch_note_suffix_arg;
-extern const char *starch_stdin_arg;
+extern const char *samtools_view_arg;
+extern const char *samtools_header_arg;
+extern const char *samtools_stdin_arg;
+extern const unsigned char c2b_starch_magic[];
+extern const char *c2b_starch_timestamp_format;
 extern const char c2b_tab_delim;
 extern const char c2b_line_delim;
 extern const char c2b_space_delim;
 extern const char c2b_sam_header_prefix;
+extern const int c2b_sam_field_min;
+extern const char *c2b_sam_sq_prefix;
+extern const char *c2b_sam_sq_name_prefix;
 extern const char *c2b_gff_header;
 extern const char *c2b_gff_fasta;
 extern const int c2b_gff_field_min;
@@ -113,6 +178,8 @@ extern const char *c2b_rmsk_strand_complement;
 extern const char *c2b_rmsk_strand_complement_replacement;
 extern const int c2b_vcf_field_min;
 extern const char c2b_vcf_header_prefix;
+extern const char *c2b_vcf_contig_prefix;
+extern const char *c2b_vcf_contig_id_prefix;
 extern const char c2b_vcf_alt_allele_delim;
 extern const char c2b_vcf_id_prefix;
 extern const char c2b_vcf_id_suffix;
@@ -124,25 +191,23 @@ extern const char *c2b_wig_fixed_step_prefix;
 extern const char *c2b_wig_chr_prefix;
 
 const char *c2b_samtools = "samtools";
-const char *c2b_sort_bed = "sort-bed";
-const char *c2b_starch = "starch";
-const char *c2b_cat = "cat";
+const char *c2b_sort_tmpdir_default = "/tmp";
+const char *c2b_sort_run_template = "/convert2bed.sort.XXXXXX";
 const char *c2b_default_output_format = "bed";
 const char *c2b_unmapped_read_chr_name = "_unmapped";
 const char *c2b_header_chr_name = "_header";
-const char *sort_bed_max_mem_arg = " --max-mem ";
-const char *sort_bed_max_mem_default_arg = " --max-mem 2G ";
-const char *sort_bed_tmpdir_arg = " --tmpdir ";
-const char *sort_bed_stdin = " - ";
-const char *starch_bzip2_arg = " --bzip2 ";
-const char *starch_gzip_arg = " --gzip ";
-const char *starch_note_prefix_arg = " --note=\"";
-const char *starch_note_suffix_arg = "\" ";
-const char *starch_stdin_arg = " - ";
+const char *samtools_view_arg = "view";
+const char *samtools_header_arg = "-h";
+const char *samtools_stdin_arg = "-";
+const unsigned char c2b_starch_magic[] = { 0xca, 0x5c, 0xad, 0xe5 };
+const char *c2b_starch_timestamp_format = "%Y-%m-%dT%H:%M:%S%z";
 const char c2b_tab_delim = '\t';
 const char c2b_line_delim = '\n';
 const char c2b_space_delim = 0x20;
 const char c2b_sam_header_prefix = '@';
+const int c2b_sam_field_min = 11;
+const char *c2b_sam_sq_prefix = "@SQ\t";
+const char *c2b_sam_sq_name_prefix = "SN:";
 const char *c2b_gff_header = "##gff-version 3";
 const char *c2b_gff_fasta = "##FASTA";
 const int c2b_gff_field_min = 9;
@@ -165,6 +230,8 @@ const char *c2b_rmsk_strand_complement = "C";
 const char *c2b_rmsk_strand_complement_replacement = "-";
 const int c2b_vcf_field_min = 8;
 const char c2b_vcf_header_prefix = '#';
+const char *c2b_vcf_contig_prefix = "##contig=<";
+const char *c2b_vcf_contig_id_prefix = "ID=";
 const char c2b_vcf_alt_allele_delim = ',';
 const char c2b_vcf_id_prefix = '<';
 const char c2b_vcf_id_suffix = '>';
@@ -194,6 +261,18 @@ typedef enum format {
     UNDEFINED_FORMAT
 } c2b_format_t;
 
+/* 
+   Converters work on views of the fields of a line: a pointer into the 
+   line and a length. Views are not NUL-terminated, so they are written 
+   out with a "%.*s" conversion, and a NUL-terminated copy is made only 
+   where a library call needs one.
+*/
+
+typedef struct field {
+    const char *str;
+    ssize_t size;
+} c2b_field_t;
+
 /* 
    BAM/SAM CIGAR operations
    -------------------------------------------------------------------------
@@ -238,23 +317,27 @@ const char default_cigar_op_operation = '-';
    9       SEQ
    10      QUAL
    11+     Optional alignment section fields (TAG:TYPE:VALUE)
+
+   When a read is split, block is the (1-based) index of the block, which
+   is written after QNAME; it is zero otherwise.
 */
 
 typedef struct sam {
-    char *qname;
+    c2b_field_t qname;
+    ssize_t block;
     int flag;
-    char *strand;
-    char *rname;
+    c2b_field_t strand;
+    c2b_field_t rname;
     uint64_t start;
     uint64_t stop;
-    char *mapq;
-    char *cigar;
-    char *rnext;
-    char *pnext;
-    char *tlen;
-    char *seq;
-    char *qual;
-    char *opt;
+    c2b_field_t mapq;
+    c2b_field_t cigar;
+    c2b_field_t rnext;
+    c2b_field_t pnext;
+    c2b_field_t tlen;
+    c2b_field_t seq;
+    c2b_field_t qual;
+    c2b_field_t opt;
 } c2b_sam_t;
 
 /* 
@@ -278,16 +361,16 @@ typedef struct sam {
 */
 
 typedef struct gff {
-    char *seqid;
-    char *source;
-    char *type;
+    c2b_field_t seqid;
+    c2b_field_t source;
+    c2b_field_t type;
     uint64_t start;
     uint64_t end;
-    char *score;
-    char *strand;
-    char *phase;
-    char *attributes;
-    char *id;
+    c2b_field_t score;
+    c2b_field_t strand;
+    c2b_field_t phase;
+    c2b_field_t attributes;
+    c2b_field_t id;
 } c2b_gff_t;
 
 /* 
@@ -312,17 +395,17 @@ typedef struct gff {
 */
 
 typedef struct gtf {
-    char *seqname;
-    char *source;
-    char *feature;
+    c2b_field_t seqname;
+    c2b_field_t source;
+    c2b_field_t feature;
     uint64_t start;
     uint64_t end;
-    char *score;
-    char *strand;
-    char *frame;
-    char *attributes;
-    char *id;
-    char *comments;
+    c2b_field_t score;
+    c2b_field_t strand;
+    c2b_field_t frame;
+    c2b_field_t attributes;
+    c2b_field_t id;
+    c2b_field_t comments;
 } c2b_gtf_t;
 
 /* 
@@ -366,19 +449,19 @@ typedef struct psl {
     uint64_t qBaseInsert;
     uint64_t tNumInsert;
     uint64_t tBaseInsert;
-    char *strand;
-    char *qName;
+    c2b_field_t strand;
+    c2b_field_t qName;
     uint64_t qSize;
     uint64_t qStart;
     uint64_t qEnd;
-    char *tName;
+    c2b_field_t tName;
     uint64_t tSize;
     uint64_t tStart;
     uint64_t tEnd;
     uint64_t blockCount;
-    char *blockSizes;
-    char *qStarts;
-    char *tStarts;
+    c2b_field_t blockSizes;
+    c2b_field_t qStarts;
+    c2b_field_t tStarts;
 } c2b_psl_t;
 
 typedef struct block {
@@ -420,22 +503,22 @@ typedef struct block {
 */
 
 typedef struct rmsk {
-    char *sw_score;
-    char *perc_div;
-    char *perc_deleted;
-    char *perc_inserted;
-    char *query_seq;
+    c2b_field_t sw_score;
+    c2b_field_t perc_div;
+    c2b_field_t perc_deleted;
+    c2b_field_t perc_inserted;
+    c2b_field_t query_seq;
     uint64_t query_start;
     uint64_t query_end;
-    char *bases_past_match;
-    char *strand;
-    char *repeat_name;
-    char *repeat_class;
-    char *bases_before_match_comp;
-    char *match_start;
-    char *match_end;
-    char *unique_id;
-    char *higher_score_match;
+    c2b_field_t bases_past_match;
+    c2b_field_t strand;
+    c2b_field_t repeat_name;
+    c2b_field_t repeat_class;
+    c2b_field_t bases_before_match_comp;
+    c2b_field_t match_start;
+    c2b_field_t match_end;
+    c2b_field_t unique_id;
+    c2b_field_t higher_score_match;
 } c2b_rmsk_t;
 
 /* 
@@ -469,23 +552,171 @@ typedef struct rmsk {
 */
 
 typedef struct vcf {
-    char *chrom;
+    c2b_field_t chrom;
     uint64_t pos;
     uint64_t start;
     uint64_t end;
-    char *id;
-    char *ref;
-    char *alt;
-    char *qual;
-    char *filter;
-    char *info;
-    char *format;
-    char *samples;
+    c2b_field_t id;
+    c2b_field_t ref;
+    c2b_field_t alt;
+    c2b_field_t qual;
+    c2b_field_t filter;
+    c2b_field_t info;
+    c2b_field_t format;
+    c2b_field_t samples;
 } c2b_vcf_t;
 
 /* 
-   At most, we need 4 pipes to handle the most complex conversion
-   pipeline used with the BEDOPS suite: 
+   The BED columns written for each format are declared as a schema: an 
+   ordered list of columns, each read from a member of the format's record 
+   struct. Records are written by a single inlined routine that walks the 
+   schema, and as the schemas are constant, the compiler unrolls it into a 
+   straight-line writer for each format.
+
+   Column kinds
+   ---------------------------------------------------------
+   FIELD_COLUMN          a c2b_field_t member, written as-is
+   UINT64_COLUMN         a uint64_t member, written in decimal
+   INT_COLUMN            an int member, written in decimal
+   NAMED_BLOCK_COLUMN    a c2b_field_t member, followed by "/<n>" when the
+                         ssize_t member at block_offset is positive
+
+   An optional column, and every column after it, is written only when the 
+   optional column is non-empty. A column that follows the previous one 
+   names the next input column after it: when both are views into the same
+   line, they are written together as one run, tab included.
+*/
+
+typedef enum column_kind {
+    FIELD_COLUMN = 0,
+    UINT64_COLUMN,
+    INT_COLUMN,
+    NAMED_BLOCK_COLUMN
+} c2b_column_kind_t;
+
+typedef struct column {
+    c2b_column_kind_t kind;
+    size_t offset;
+    size_t block_offset;
+    boolean is_optional;
+    boolean follows_previous;
+} c2b_column_t;
+
+extern const c2b_column_t c2b_sam_columns[];
+extern const c2b_column_t c2b_gff_columns[];
+extern const c2b_column_t c2b_gtf_columns[];
+extern const c2b_column_t c2b_psl_columns[];
+extern const c2b_column_t c2b_rmsk_columns[];
+extern const c2b_column_t c2b_vcf_columns[];
+
+const c2b_column_t c2b_sam_columns[] = {
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, rname),  0,                            0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_sam_t, start),  0,                            0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_sam_t, stop),   0,                            0, 0 },
+    { NAMED_BLOCK_COLUMN, offsetof(c2b_sam_t, qname),  offsetof(c2b_sam_t, block),   0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, mapq),   0,                            0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, strand), 0,                            0, 0 },
+    { INT_COLUMN,         offsetof(c2b_sam_t, flag),   0,                            0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, cigar),  0,                            0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, rnext),  0,                            0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, pnext),  0,                            0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, tlen),   0,                            0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, seq),    0,                            0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, qual),   0,                            0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_sam_t, opt),    0,                            1, 1 }
+};
+
+const c2b_column_t c2b_gff_columns[] = {
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, seqid),      0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_gff_t, start),      0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_gff_t, end),        0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, id),         0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, score),      0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, strand),     0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, source),     0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, type),       0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, phase),      0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gff_t, attributes), 0, 0, 1 }
+};
+
+const c2b_column_t c2b_gtf_columns[] = {
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, seqname),    0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_gtf_t, start),      0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_gtf_t, end),        0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, id),         0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, score),      0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, strand),     0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, source),     0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, feature),    0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, frame),      0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, attributes), 0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_gtf_t, comments),   0, 1, 1 }
+};
+
+const c2b_column_t c2b_psl_columns[] = {
+    { FIELD_COLUMN,       offsetof(c2b_psl_t, tName),       0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, tStart),      0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, tEnd),        0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_psl_t, qName),       0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, matches),     0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_psl_t, strand),      0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, qSize),       0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, misMatches),  0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, repMatches),  0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, nCount),      0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, qNumInsert),  0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, qBaseInsert), 0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, tNumInsert),  0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, tBaseInsert), 0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, qStart),      0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, qEnd),        0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, tSize),       0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_psl_t, blockCount),  0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_psl_t, blockSizes),  0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_psl_t, qStarts),     0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_psl_t, tStarts),     0, 0, 1 }
+};
+
+/* 
+   RepeatMasker columns are separated by runs of spaces, so no column is 
+   marked as following the previous one: runs must not be copied as-is
+*/
+
+const c2b_column_t c2b_rmsk_columns[] = {
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, query_seq),               0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_rmsk_t, query_start),             0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_rmsk_t, query_end),               0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, repeat_name),             0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, sw_score),                0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, strand),                  0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, perc_div),                0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, perc_deleted),            0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, perc_inserted),           0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, bases_past_match),        0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, repeat_class),            0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, bases_before_match_comp), 0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, match_start),             0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, match_end),               0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, unique_id),               0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_rmsk_t, higher_score_match),      0, 1, 0 }
+};
+
+const c2b_column_t c2b_vcf_columns[] = {
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, chrom),   0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_vcf_t, start),   0, 0, 0 },
+    { UINT64_COLUMN,      offsetof(c2b_vcf_t, end),     0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, id),      0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, qual),    0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, ref),     0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, alt),     0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, filter),  0, 0, 0 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, info),    0, 0, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, format),  0, 1, 1 },
+    { FIELD_COLUMN,       offsetof(c2b_vcf_t, samples), 0, 0, 1 }
+};
+
+/* 
+   The most complex conversion pipeline used with the BEDOPS suite is: 
    
     BAM -> SAM -> BED (unsorted) -> BED (sorted) -> Starch
    
@@ -504,8 +735,14 @@ typedef struct vcf {
     XYZ -> BED (unsorted)
 
    Here, XYZ is one of GFF, GTF, PSL, RepeatMasker (OUT), SAM, VCF, or WIG.
-   
-   If a more complex pipeline arises, we can increase the value of MAX_PIPES.
+
+   Each path is declared as a stage graph (see c2b_stage_graph_t, below),
+   and the graph runner works out the pipes and threads it needs. Only the 
+   samtools step is a child process, so only it is connected with pipes,
+   and it always comes before conversion. Conversion, sorting and Starch 
+   compression all run in this process, so converted BED is written 
+   straight to stdout, or to the sorter and then to stdout, as BED or as a
+   Starch archive.
 
    Each pipe has a read and write stream. The write stream handles
    data sent via the out and err file handles. We bundle all the pipes
@@ -515,7 +752,6 @@ typedef struct vcf {
 #define PIPE_READ 0
 #define PIPE_WRITE 1
 #define PIPE_STREAMS 2
-#define MAX_PIPES 4
 
 typedef struct pipeset {
     int **in;
@@ -524,19 +760,143 @@ typedef struct pipeset {
     size_t num;
 } c2b_pipeset_t;
 
+/*
+   Sorted output is sorted in this process, in the order given by BEDOPS 
+   sort-bed: by chromosome name, byte by byte, then by start and stop 
+   position, and then by the rest of the line. A key is taken from the 
+   first three columns of each line as it comes in from the converter, and
+   the line and its key go to the bucket for its chromosome. Lines are only
+   ever compared with others in their bucket, so keys carry no chromosome
+   name; chromosomes are put in order once per pass, bucket by bucket.
+
+   Chromosomes are independent of one another, so buckets are sorted on a
+   pool of --threads workers, claiming buckets in chromosome order, while 
+   the sorter writes out each bucket in turn as soon as it is sorted.
+
+   Input is often sorted already, if in another order of chromosomes (SAM
+   and VCF files in reference order, say). Each line is checked against the
+   last one in its bucket as it comes in, and a bucket that stays in order
+   is never sorted, nor merged from disk: its lines and segments are just 
+   written out in turn. The first line out of order drops its bucket back
+   to a full sort.
+
+   With --sort-order=header, chromosomes are written in the order of SAM 
+   @SQ or VCF ##contig lines instead. Converters pass their raw header lines
+   on to the sorter, which gives each named chromosome's bucket a rank in
+   the order they come; chromosomes the header does not name follow in 
+   sort-bed order. With --sort-order=natural, runs of digits in chromosome 
+   names compare by value, as with sort -V, so chr2 comes before chr10.
+
+   Once the buckets outgrow --max-mem, they are sorted and spilled in the 
+   same way, each as a sorted segment of one unlinked temporary file under
+   --sort-tmpdir. When conversion is done, a bucket with segments on disk
+   is merged with them as it is written out. A bucket's segments are merged
+   down to one whenever it has C2B_MAX_SORT_RUNS_VALUE of them, to keep the
+   number of merge buffers in check.
+*/
+
+typedef enum sort_order {
+    LEXICOGRAPHIC_SORT_ORDER,
+    HEADER_SORT_ORDER,
+    NATURAL_SORT_ORDER,
+    UNDEFINED_SORT_ORDER
+} c2b_sort_order_t;
+
+typedef struct sort_key {
+    uint64_t start;
+    uint64_t stop;
+    size_t offset;
+    uint32_t chr_len;
+    uint32_t len;
+} c2b_sort_key_t;
+
+typedef struct sort_segment {
+    off_t offset;
+    off_t size;
+} c2b_sort_segment_t;
+
+typedef struct sort_run {
+    int fd;
+    off_t offset;
+    off_t end;
+    char *buf;
+    ssize_t capacity;
+    ssize_t pos;
+    ssize_t len;
+    const c2b_sort_key_t *keys;
+    const char *arena;
+    size_t num_keys;
+    size_t next_key;
+    c2b_sort_key_t key;
+    const char *line;
+} c2b_sort_run_t;
+
+typedef struct sort_bucket {
+    char *chr;
+    uint32_t chr_len;
+    char *arena;
+    size_t arena_len;
+    size_t arena_capacity;
+    c2b_sort_key_t *keys;
+    c2b_sort_key_t *spare_keys;
+    c2b_sort_key_t *sorted_keys;
+    size_t num_keys;
+    size_t keys_capacity;
+    c2b_sort_segment_t *segments;
+    size_t num_segments;
+    size_t segments_capacity;
+    size_t rank;
+    struct starch_stream *starch;
+    c2b_sort_key_t last_key;
+    char *last_line;
+    ssize_t last_line_capacity;
+    boolean is_ordered;
+    boolean is_sorted;
+} c2b_sort_bucket_t;
+
+typedef struct sorter {
+    c2b_sort_bucket_t *buckets;
+    size_t num_buckets;
+    size_t buckets_capacity;
+    size_t last_bucket_idx;
+    size_t *slots;
+    size_t slots_capacity;
+    c2b_sort_bucket_t **order;
+    size_t num_ordered;
+    size_t next_claimed;
+    pthread_t *workers;
+    size_t num_workers;
+    pthread_mutex_t lock;
+    pthread_cond_t sorted;
+    char *pending;
+    ssize_t pending_len;
+    ssize_t pending_capacity;
+    size_t mem_used;
+    size_t max_mem;
+    const char *tmpdir;
+    int spill_fd;
+    off_t spill_len;
+    c2b_sort_order_t sort_order;
+    size_t num_ranked;
+    boolean is_starch;
+    boolean is_final;
+} c2b_sorter_t;
+
 /* 
    A pipeline stage contains a pipeset (set of I/O pipes), source
-   and destination stage IDs, and a "line functor" which generally 
-   processes fields from a precursor format to BED. This functor is
+   and destination stage IDs, and a "block converter" which generally 
+   processes fields from a precursor format to BED. This converter is
    specific to the specified input format. This stage is passed to 
-   each processing thread.
+   each processing thread. A stage whose segment ends in a sort writes to
+   its sorter.
 */
 
 typedef struct pipeline_stage {
     c2b_pipeset_t *pipeset;
     unsigned int src;
     unsigned int dest;
-    void (*line_functor)();
+    void (*block_converter)();
+    c2b_sorter_t *sorter;
     int status;
     char *description;
     pid_t pid;
@@ -587,14 +947,18 @@ static const char *general_io_options =                                 \
 static const char *general_options =                                    \
     "  Other processing options:\n\n"                                   \
     "  --do-not-sort (-d)\n"                                            \
-    "      Do not sort BED output with sort-bed (not compatible with --output=starch)\n" \
+    "      Do not sort BED output (ignored with --output=starch, which is always sorted)\n" \
     "  --max-mem=<value> (-m <val>)\n"                                  \
     "      Sets aside <value> memory for sorting BED output. For example, <value> can\n" \
     "      be 8G, 8000M or 8000000000 to specify 8 GB of memory (default is 2G)\n" \
     "  --sort-tmpdir=<dir> (-r <dir>)\n"                                \
-    "      Optionally sets [dir] as temporary directory for sort data, when used in\n" \
-    "      conjunction with --max-mem=[value], instead of the host's operating system\n" \
-    "      default temporary directory\n"                               \
+    "      Optionally sets [dir] as temporary directory for sorted runs of BED data\n" \
+    "      which do not fit in --max-mem=[value], instead of $TMPDIR or /tmp\n" \
+    "  --sort-order=[lexicographic|header|natural] (-O <order>)\n"     \
+    "      Order chromosomes byte by byte, as sort-bed does (default), as they are\n" \
+    "      listed by SAM @SQ or VCF ##contig header lines, or with numbers in their\n" \
+    "      names compared by value, as sort -V does (chr2 before chr10). Chromosomes\n" \
+    "      missing from the header follow, in lexicographic order\n"    \
     "  --starch-bzip2 (-z)\n"                                           \
     "      Used with --output=starch, the compressed output explicitly applies the bzip2\n" \
     "      algorithm to compress intermediate data (default is bzip2)\n" \
@@ -603,6 +967,21 @@ static const char *general_options =                                    \
     "      intermediate data\n"                                         \
     "  --starch-note=\"xyz...\" (-e \"xyz...\")\n"                      \
     "      Used with --output=starch, this adds a note to the Starch archive metadata\n" \
+    "  --threads=<n> (-@ <n>)\n"                                        \
+    "      Convert input lines on <n> worker threads (default is 1). Output is\n" \
+    "      identical to a single-threaded run. GTF, PSL, RepeatMasker and WIG\n" \
+    "      input, and --keep-header, are always converted on one thread. Sorting\n" \
+    "      and Starch compression use the same number of threads, one chromosome\n" \
+    "      at a time\n"                                                 \
+    "  --io-engine=[posix|io_uring] (-u <engine>)\n"                    \
+    "      Read input and write output with plain read() and write() calls, or\n" \
+    "      through io_uring with several requests in flight (default is posix).\n" \
+    "      Falls back to posix where the kernel does not support io_uring\n" \
+    "  --io-buffer=<size> (-c <size>)\n"                                \
+    "      Size of reads, writes and pipe buffers between stages, in bytes or with a\n" \
+    "      K, M or G suffix (default is 1M). Converted lines are written out in\n" \
+    "      batches once this many bytes are pending. Pipe buffers are capped at\n" \
+    "      the size in /proc/sys/fs/pipe-max-size\n"                    \
     "  --help | --help[-bam|-gff|-gtf|-gvf|-psl|-rmsk|-sam|-vcf|-wig] (-h | -h <fmt>)\n" \
     "      Show general help message (or detailed help for a specified input format)\n" \
     "  --version (-w)\n"                                                \
@@ -678,7 +1057,7 @@ static const char *bam_usage =                                          \
     "  $ convert2bed -i bam -o starch < foo.bam > sorted-foo.bam.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the BEDOPS sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -737,7 +1116,7 @@ static const char *gff_usage =                                          \
     "  $ convert2bed -i gff -o starch < foo.gff > sorted-foo.gff.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -761,7 +1140,7 @@ static const char *gtf_usage =                                          \
     "  $ convert2bed -i gtf -o starch < foo.gtf > sorted-foo.gtf.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -855,7 +1234,7 @@ static const char *gvf_usage =                                          \
     "  $ convert2bed -i gvf -o starch < foo.gvf > sorted-foo.gvf.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -877,7 +1256,7 @@ static const char *psl_usage =                                          \
     "  $ convert2bed -i psl -o starch < foo.psl > sorted-foo.psl.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the BEDOPS sort-bed application\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -953,7 +1332,7 @@ static const char *rmsk_usage =                                         \
     "  $ convert2bed -i rmsk -o starch < foo.out > sorted-foo.out.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the BEDOPS sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -1015,7 +1394,7 @@ static const char *sam_usage =                                          \
     "  $ convert2bed -i sam -o starch < foo.sam > sorted-foo.sam.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the BEDOPS sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -1091,7 +1470,7 @@ static const char *vcf_usage =                                          \
     "  $ convert2bed -i vcf -o starch < foo.vcf > sorted-foo.vcf.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the BEDOPS sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -1162,7 +1541,7 @@ static const char *wig_usage =                                          \
     "  $ convert2bed -i wig -o starch < foo.wig > sorted-foo.wig.starch\n" \
     "\n"                                                                \
     "  We make no assumptions about sort order from converted output. Apply\n" \
-    "  the usage case displayed to pass data to the BEDOPS sort-bed application,\n" \
+    "  the usage case displayed to sort data in BEDOPS sort-bed order,\n" \
     "  which generates lexicographically-sorted BED data as output.\n"  \
     "\n"                                                                \
     "  If you want to skip sorting, use the --do-not-sort option:\n"    \
@@ -1175,8 +1554,8 @@ static const char *wig_description =                                    \
     "  We convert either variety to 0-based, half-open [a-1, b) indexing when creating\n" \
     "  BED output.\n"                                                   \
     "\n"                                                                \
-    "  By default, data are passed internally to BEDOPS sort-bed to provide sorted\n" \
-    "  output ready for use with other BEDOPS utilities.\n";
+    "  By default, data are sorted internally in BEDOPS sort-bed order to provide\n" \
+    "  sorted output ready for use with other BEDOPS utilities.\n";
 
 static const char *wig_options =                                        \
     "  WIG conversion options:\n\n"                                     \
@@ -1195,16 +1574,13 @@ static const char *format_undefined_usage =                             \
     "  Note: Please specify format to get detailed usage parameters:\n\n" \
     "  --help[-bam|-gff|-gtf|-gvf|-psl|-rmsk|-sam|-vcf|-wig] (-h <fmt>)\n";
 
-typedef struct gff_state {
-    char *id;
-} c2b_gff_state_t;
-
 typedef struct gtf_state {
     char *id;
+    ssize_t id_size;
+    ssize_t id_capacity;
 } c2b_gtf_state_t;
 
 typedef struct psl_state {
-    boolean is_headered;
     c2b_psl_block_t *block;
 } c2b_psl_state_t;
 
@@ -1216,7 +1592,6 @@ typedef struct rmsk_state {
 
 typedef struct sam_state {
     char *samtools_path;
-    c2b_cigar_t *cigar;
 } c2b_sam_state_t;
 
 typedef struct vcf_state {
@@ -1237,53 +1612,358 @@ typedef struct wig_state {
     uint64_t end_pos;
     double score;
     char *chr;
+    ssize_t chr_capacity;
     char *id;
+    ssize_t id_capacity;
     boolean is_fixed_step;
     boolean start_write;
-    char *basename;
-    int start_shift;
-    int end_shift;
 } c2b_wig_state_t;
 
-typedef struct cat_params {
-    char *path;
-} c2b_cat_params_t;
-
 typedef struct sort_params {
     boolean is_enabled;
-    char *sort_bed_path;
-    char *max_mem_value;
+    c2b_sort_order_t order;
+    size_t max_mem;
     char *sort_tmpdir_path;
 } c2b_sort_params_t;
 
 typedef struct starch_params {
-    char *path;
     boolean bzip2;
     boolean gzip;
     char *note;
 } c2b_starch_params_t;
 
+/*
+   Converters read their settings from a converter options struct, which is
+   filled in once from the command line and never written to afterwards, so
+   that it can be shared between threads. 
+
+   Everything a converter writes to between lines (the header line count,
+   parsed CIGAR operations and PSL blocks, the GTF ID attribute, the
+   RepeatMasker tokenizer flags and the WIG section cursor) lives in a 
+   converter context instead. Each thread that converts lines owns its own
+   context, so any number of converters can run side by side.
+
+   Fields that a converter needs as C strings are copied into the context's
+   field arena. The arena is emptied before each line and grows to fit the
+   longest line seen so far, so neither lines nor fields have a fixed 
+   maximum length. When the arena has to grow partway through a line, the
+   buffer it outgrew is kept on a retired list until the next line, so that
+   fields copied earlier in the line stay valid.
+*/
+
+typedef struct field_arena {
+    char *buf;
+    ssize_t len;
+    ssize_t capacity;
+    char *retired;
+} c2b_field_arena_t;
+
+typedef struct converter_options {
+    boolean all_reads_flag;
+    boolean keep_header_flag;
+    boolean header_sort_order_flag;
+    boolean split_flag;
+    boolean zero_indexed_flag;
+    boolean psl_is_headered;
+    const c2b_vcf_state_t *vcf;
+    const char *wig_basename;
+    int wig_start_shift;
+    int wig_end_shift;
+} c2b_converter_options_t;
+
+typedef struct converter_context {
+    const c2b_converter_options_t *options;
+    unsigned int header_line_idx;
+    c2b_field_arena_t fields;
+    c2b_cigar_t *cigar;
+    c2b_gtf_state_t gtf;
+    c2b_psl_state_t psl;
+    c2b_rmsk_state_t rmsk;
+    c2b_wig_state_t wig;
+} c2b_context_t;
+
+/*
+   Line functors append converted records to an output batch. Appends are
+   bounds-checked: a batch with an output handle is written out once it
+   holds flush_size bytes (checked between input lines), and any batch
+   grows if a single line expands past its remaining capacity, so a SAM
+   --split or VCF allele-split record can never overrun it.
+
+   A batch may also gather views: long columns that are copied verbatim
+   from the input are not copied at all, but recorded as views into the 
+   source buffer and written out with writev(). A view with a NULL string 
+   stands for the next size bytes of buf. viewed_len is how much of buf 
+   the views cover so far, and view_bytes is how many source bytes they 
+   reference. The source must outlive the batch contents, so a gathering 
+   batch is written out before its input buffer is reused.
+*/
+
+typedef struct batch {
+    char *buf;
+    ssize_t len;
+    ssize_t capacity;
+    ssize_t flush_size;
+    struct output *output;
+    c2b_field_t *views;
+    ssize_t num_views;
+    ssize_t views_capacity;
+    ssize_t viewed_len;
+    ssize_t view_bytes;
+} c2b_batch_t;
+
+/*
+   Converters are handed a whole block of input lines at a time. The block
+   is tokenized in one pass beforehand: each line records its start and
+   length, along with the offsets of its tab delimiters relative to the
+   start of the line, followed by the line length and a -1 sentinel.
+   field_idx is the number of tab delimiters, so a line has field_idx + 1
+   fields. Space-delimited formats (RepeatMasker, WIG) ignore the offsets.
+
+   Tabs and newlines are found by the widest tokenizer the processor offers
+   (AVX2 or SSE2 on x86, chosen at startup), or else by a scalar one.
+*/
+
+typedef struct line {
+    char *src;
+    ssize_t size;
+    const ssize_t *field_offsets;
+    int field_idx;
+} c2b_line_t;
+
+typedef struct line_block {
+    c2b_line_t *lines;
+    ssize_t num_lines;
+    ssize_t lines_capacity;
+    ssize_t *field_offsets;
+    ssize_t num_field_offsets;
+    ssize_t field_offsets_capacity;
+} c2b_block_t;
+
+/*
+   A conversion is declared as a stage graph: a chain of stages, from a 
+   source (stdin) to a sink (stdout), connected in the order they are 
+   appended. Converters, filters and the sorter (which also writes Starch
+   archives) run in this process; decoding (BAM to SAM with samtools) runs
+   as a child process, built from its stage's command.
+
+   c2b_run_graph() gives each child process a pipe and fuses each run of 
+   in-process stages between two child processes (or stdin and stdout) 
+   into one segment, so no pipe hop is added between in-process stages.
+   There are two kinds of segment: one that relays stdin into samtools, 
+   and one that converts to stdout, on one thread or on a pool of workers
+   with --threads. A converting segment holds one converter or filter, 
+   optionally followed by a sort stage; a sorted segment hands converted 
+   lines to a sorter and writes them out, in order, as BED or Starch, once
+   its input runs dry.
+*/
+
+typedef enum stage_kind {
+    SOURCE_STAGE,
+    DECODE_STAGE,
+    CONVERT_STAGE,
+    FILTER_STAGE,
+    SORT_STAGE,
+    SINK_STAGE
+} c2b_stage_kind_t;
+
+typedef struct stage_node {
+    c2b_stage_kind_t kind;
+    char *description;
+    void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *);
+    void (*cmd)(char **args);
+} c2b_stage_node_t;
+
+typedef struct stage_graph {
+    c2b_stage_node_t nodes[C2B_MAX_STAGES_VALUE];
+    size_t num_nodes;
+} c2b_stage_graph_t;
+
+/* 
+   The chunk engine (--threads) splits input into line-aligned chunks,
+   converts them on a pool of worker threads and writes the results out in
+   input order. Chunk n lives in slot (n % num_chunks): the reader fills 
+   FREE slots, workers convert READY slots in the order they were read, and
+   the sequencer writes out DONE slots before handing them back as FREE.
+*/
+
+typedef enum chunk_state {
+    CHUNK_FREE,
+    CHUNK_READY,
+    CHUNK_DONE
+} c2b_chunk_state_t;
+
+typedef struct chunk {
+    char *src;
+    char *src_buf;
+    ssize_t src_capacity;
+    ssize_t src_len;
+    c2b_batch_t dest;
+    c2b_chunk_state_t state;
+} c2b_chunk_t;
+
+typedef struct chunk_engine {
+    c2b_chunk_t *chunks;
+    size_t num_chunks;
+    size_t num_read;
+    size_t num_claimed;
+    boolean is_eof;
+    boolean is_mapped;
+    int src_fd;
+    void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *);
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t done;
+    pthread_cond_t freed;
+} c2b_chunk_engine_t;
+
+/* 
+   When stdin is redirected from a regular file, it is mapped into memory
+   and read as a series of line-aligned windows, so that converters 
+   tokenize straight out of the mapping. Lines read on one thread, and the
+   chunks of a worker pool, then point at the window rather than at a copy
+   in their own buffer.
+*/
+
+typedef struct mapped_input {
+    char *data;
+    size_t size;
+    size_t offset;
+} c2b_mapped_input_t;
+
+/* 
+   Stages read their input and write their output through c2b_input_t and 
+   c2b_output_t handles. With the default POSIX engine these are thin 
+   wrappers around read() and write(). With --io-engine=io_uring, each 
+   handle owns a ring with a set of registered blocks: an input keeps up to
+   C2B_URING_DEPTH_VALUE reads in flight on a seekable descriptor (one at a
+   time on a pipe), and an output fills half of its blocks while the other 
+   half is written out as a single linked, and so ordered, batch. If the 
+   kernel does not support io_uring, handles quietly use the POSIX engine.
+*/
+
+typedef enum io_engine {
+    POSIX_IO_ENGINE,
+    URING_IO_ENGINE,
+    UNDEFINED_IO_ENGINE
+} c2b_io_engine_t;
+
+typedef enum io_block_state {
+    IO_BLOCK_IDLE,
+    IO_BLOCK_IN_FLIGHT,
+    IO_BLOCK_DONE
+} c2b_io_block_state_t;
+
+typedef struct io_block {
+    char *buf;
+    ssize_t len;
+    ssize_t pos;
+    off_t offset;
+    int result;
+    c2b_io_block_state_t state;
+} c2b_io_block_t;
+
+#ifdef C2B_HAVE_IO_URING
+typedef struct uring {
+    int fd;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned int in_flight;
+    c2b_io_block_t blocks[C2B_URING_DEPTH_VALUE];
+} c2b_uring_t;
+#else
+typedef struct uring {
+    int fd;
+} c2b_uring_t;
+#endif
+
+typedef struct input {
+    int fd;
+    c2b_uring_t *ring;
+    unsigned int depth;
+    size_t next_block;
+    off_t offset;
+    off_t submit_offset;
+    boolean is_seekable;
+} c2b_input_t;
+
+/*
+   Starch archives are written by the sorter, without the BEDOPS starch 
+   binary. An archive is a four-byte magic number, then one compressed 
+   stream per chromosome (bzip2, or zlib with --starch-gzip), then JSON 
+   metadata and a fixed-length footer: the metadata offset as twenty digits
+   and a base64 SHA-1 digest of the metadata, padded out with spaces.
+
+   A stream holds its chromosome's lines with the chromosome name dropped
+   and the start given relative to the stop of the line before. A "p" line
+   gives the length of the elements that follow, whenever it changes. The
+   metadata records line and base counts gathered as lines are transformed.
+   Streams are compressed on the sorter's workers, one chromosome each, and
+   written out in chromosome order once compressed. This is archive format
+   version 2.0, which unstarch reads.
+*/
+
+typedef struct starch_stream {
+    c2b_batch_t transformed;
+    char *buf;
+    ssize_t len;
+    ssize_t capacity;
+    char *pending;
+    ssize_t pending_len;
+    ssize_t pending_capacity;
+    boolean is_gzip;
+    bz_stream bz;
+    z_stream z;
+    uint64_t num_lines;
+    uint64_t non_unique_bases;
+    uint64_t unique_bases;
+    uint64_t last_stop;
+    uint64_t last_length;
+    uint64_t max_stop;
+} c2b_starch_stream_t;
+
+typedef struct output {
+    int fd;
+    c2b_uring_t *ring;
+    c2b_sorter_t *sorter;
+    c2b_starch_stream_t *starch;
+    size_t fill_block;
+    size_t batch_first;
+    size_t batch_count;
+} c2b_output_t;
+
 static struct globals {
     c2b_format_t help_format_idx;
     char *input_format;
     c2b_format_t input_format_idx;
     char *output_format;
     c2b_format_t output_format_idx;
-    unsigned int header_line_idx;
+    unsigned int num_threads;
+    c2b_io_engine_t io_engine;
+    ssize_t io_buffer_size;
     boolean all_reads_flag;
     boolean keep_header_flag;
     boolean split_flag;
     boolean zero_indexed_flag;
-    c2b_gff_state_t *gff;
-    c2b_gtf_state_t *gtf;
-    c2b_psl_state_t *psl;
-    c2b_rmsk_state_t *rmsk;
     c2b_sam_state_t *sam;
     c2b_vcf_state_t *vcf;
-    c2b_wig_state_t *wig;
-    c2b_cat_params_t *cat;
+    char *wig_basename;
+    c2b_converter_options_t converter_options;
     c2b_sort_params_t *sort;
     c2b_starch_params_t *starch;
+    c2b_mapped_input_t *src_map;
+    void (*tokenize_lines)(c2b_block_t *block, char *src, ssize_t src_size);
 } c2b_globals;
 
 static struct option c2b_client_long_options[] = {
@@ -1302,8 +1982,12 @@ static struct option c2b_client_long_options[] = {
     { "starch-note",    required_argument,   NULL,    'e' },
     { "max-mem",        required_argument,   NULL,    'm' },
     { "sort-tmpdir",    required_argument,   NULL,    'r' },
+    { "sort-order",     required_argument,   NULL,    'O' },
     { "multisplit",     required_argument,   NULL,    'b' },
     { "zero-indexed",   no_argument,         NULL,    'x' },
+    { "threads",        required_argument,   NULL,    '@' },
+    { "io-engine",      required_argument,   NULL,    'u' },
+    { "io-buffer",      required_argument,   NULL,    'c' },
     { "help",           no_argument,         NULL,    'h' },
     { "version",        no_argument,         NULL,    'w' },
     { "help-bam",       no_argument,         NULL,    '1' },
@@ -1318,91 +2002,213 @@ static struct option c2b_client_long_options[] = {
     { NULL,             no_argument,         NULL,     0  }
 };
 
-static const char *c2b_client_opt_string = "i:o:dakspvtnzge:m:r:b:xhw12345678?";
+static const char *c2b_client_opt_string = "i:o:dakspvtnzge:m:r:O:b:x@:u:c:hw12345678?";
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-    static void              c2b_init_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_gff_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_gtf_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_gvf_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_psl_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_rmsk_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_sam_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_vcf_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_wig_conversion(c2b_pipeset_t *p);
-    static void              c2b_init_generic_conversion(c2b_pipeset_t *p, void(*to_bed_line_functor)(char *, ssize_t *, char *, ssize_t));
-    static void              c2b_init_bam_conversion(c2b_pipeset_t *p);
-    static inline void       c2b_cmd_cat_stdin(char *cmd);
-    static inline void       c2b_cmd_bam_to_sam(char *cmd);
-    static inline void       c2b_cmd_sort_bed(char *cmd);
-    static inline void       c2b_cmd_starch_bed(char *cmd);
-    static void              c2b_line_convert_gff_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size);
-    static inline void       c2b_line_convert_gff_to_bed(c2b_gff_t g, char *dest_line, ssize_t *dest_size);
-    static void              c2b_line_convert_gtf_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size);
-    static inline void       c2b_line_convert_gtf_to_bed(c2b_gtf_t g, char *dest_line, ssize_t *dest_size);
-    static void              c2b_line_convert_psl_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size);
-    static inline void       c2b_psl_blockSizes_to_ptr(char *s, uint64_t bc);
-    static inline void       c2b_psl_tStarts_to_ptr(char *s, uint64_t bc);
-    static inline void       c2b_line_convert_psl_to_bed(c2b_psl_t p, char *dest_line, ssize_t *dest_size);
-    static void              c2b_line_convert_rmsk_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size);
-    static inline void       c2b_line_convert_rmsk_to_bed(c2b_rmsk_t r, char *dest_line, ssize_t *dest_size);
-    static void              c2b_line_convert_sam_to_bed_unsorted_without_split_operation(char *dest, ssize_t *dest_size, char *src, ssize_t src_size);
-    static void              c2b_line_convert_sam_to_bed_unsorted_with_split_operation(char *dest, ssize_t *dest_size, char *src, ssize_t src_size); 
-    static inline void       c2b_sam_cigar_str_to_ops(char *s);
+    static void              c2b_init_conversion();
+    static void              c2b_init_gff_conversion();
+    static void              c2b_init_gtf_conversion();
+    static void              c2b_init_gvf_conversion();
+    static void              c2b_init_psl_conversion();
+    static void              c2b_init_rmsk_conversion();
+    static void              c2b_init_sam_conversion();
+    static void              c2b_init_vcf_conversion();
+    static void              c2b_init_wig_conversion();
+    static void              c2b_init_generic_conversion(void(*to_bed_block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *));
+    static void              c2b_init_bam_conversion();
+    static void              c2b_init_graph(c2b_stage_graph_t *g);
+    static void              c2b_graph_append_stage(c2b_stage_graph_t *g, c2b_stage_kind_t kind, char *description, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), void (*cmd)(char **));
+    static void              c2b_graph_append_output_stages(c2b_stage_graph_t *g);
+    static inline boolean    c2b_stage_is_in_process(c2b_stage_kind_t kind);
+    static void              c2b_run_graph(c2b_stage_graph_t *g);
+    static void              c2b_init_stage(c2b_pipeline_stage_t *stage, c2b_pipeset_t *pipes, char *description, unsigned int src, unsigned int dest, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), c2b_sorter_t *sorter, pid_t pid, int status);
+    static inline void       c2b_cmd_bam_to_sam(char **args);
+    static void              c2b_block_convert_gff_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_line_convert_gff_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line);
+    static inline void       c2b_line_convert_gff_to_bed(c2b_gff_t g, c2b_batch_t *dest);
+    static void              c2b_block_convert_gtf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_line_convert_gtf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line);
+    static inline void       c2b_line_convert_gtf_to_bed(c2b_gtf_t g, c2b_batch_t *dest);
+    static void              c2b_block_convert_psl_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_line_convert_psl_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line);
+    static inline void       c2b_psl_blockSizes_to_ptr(c2b_psl_block_t *block, c2b_field_t s, uint64_t bc);
+    static inline void       c2b_psl_tStarts_to_ptr(c2b_psl_block_t *block, c2b_field_t s, uint64_t bc);
+    static inline void       c2b_line_convert_psl_to_bed(c2b_psl_t p, c2b_batch_t *dest);
+    static void              c2b_block_convert_rmsk_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_line_convert_rmsk_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line);
+    static inline void       c2b_line_convert_rmsk_to_bed(c2b_rmsk_t r, c2b_batch_t *dest);
+    static void              c2b_block_convert_sam_to_bed_unsorted_without_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_block_convert_sam_to_bed_unsorted_with_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_line_convert_sam_to_bed_unsorted_without_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line);
+    static void              c2b_line_convert_sam_to_bed_unsorted_with_split_operation(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line); 
+    static inline void       c2b_sam_cigar_str_to_ops(c2b_cigar_t *cigar, c2b_field_t s);
     static void              c2b_sam_init_cigar_ops(c2b_cigar_t **c, const ssize_t size);
     static void              c2b_sam_debug_cigar_ops(c2b_cigar_t *c);
+    static void              c2b_sam_grow_cigar_ops(c2b_cigar_t *c);
     static void              c2b_sam_delete_cigar_ops(c2b_cigar_t *c);
-    static inline void       c2b_line_convert_sam_to_bed(c2b_sam_t s, char *dest_line, ssize_t *dest_size);
-    static void              c2b_line_convert_vcf_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size);
-    static inline boolean    c2b_vcf_allele_is_id(char *s);
-    static inline boolean    c2b_vcf_record_is_snv(char *ref, char *alt);
-    static inline boolean    c2b_vcf_record_is_insertion(char *ref, char *alt);
-    static inline boolean    c2b_vcf_record_is_deletion(char *ref, char *alt);
-    static inline void       c2b_line_convert_vcf_to_bed(c2b_vcf_t v, char *dest_line, ssize_t *dest_size);
-    static void              c2b_line_convert_wig_to_bed_unsorted(char *dest, ssize_t *dest_size, char *src, ssize_t src_size);
+    static inline void       c2b_line_convert_sam_to_bed(c2b_sam_t s, c2b_batch_t *dest);
+    static void              c2b_block_convert_vcf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_line_convert_vcf_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line);
+    static inline boolean    c2b_vcf_allele_is_id(c2b_field_t s);
+    static inline boolean    c2b_vcf_record_is_snv(c2b_field_t ref, c2b_field_t alt);
+    static inline boolean    c2b_vcf_record_is_insertion(c2b_field_t ref, c2b_field_t alt);
+    static inline boolean    c2b_vcf_record_is_deletion(c2b_field_t ref, c2b_field_t alt);
+    static inline void       c2b_line_convert_vcf_to_bed(c2b_vcf_t v, c2b_batch_t *dest);
+    static void              c2b_block_convert_wig_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block);
+    static void              c2b_line_convert_wig_to_bed_unsorted(c2b_context_t *ctx, c2b_batch_t *dest, c2b_line_t *line);
+    static void              c2b_line_append_wig_record(c2b_context_t *ctx, c2b_batch_t *dest, uint64_t start, uint64_t end);
     static void *            c2b_read_bytes_from_stdin(void *arg);
-    static void *            c2b_process_intermediate_bytes_by_lines(void *arg);
-    static void *            c2b_write_in_bytes_to_in_process(void *arg);
-    static void *            c2b_write_out_bytes_to_in_process(void *arg);
-    static void *            c2b_write_in_bytes_to_stdout(void *arg);
-    static void *            c2b_write_out_bytes_to_stdout(void *arg);
+    static inline void       c2b_process_lines(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block, char *src, ssize_t src_size, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *));
+    static void              c2b_init_block(c2b_block_t *block);
+    static void              c2b_delete_block(c2b_block_t *block);
+    static inline void       c2b_block_push_field_offset(c2b_block_t *block, ssize_t offset);
+    static inline void       c2b_block_push_line(c2b_block_t *block, char *line_start, ssize_t line_size, int field_idx);
+    static inline void       c2b_block_push_delimiter(c2b_block_t *block, char *src, ssize_t posn, ssize_t *line_start, int *field_idx);
+    static void              c2b_tokenize_block(c2b_block_t *block, char *src, ssize_t src_size);
+    static void              c2b_tokenize_lines_scalar(c2b_block_t *block, char *src, ssize_t src_size);
+#ifdef C2B_HAVE_X86_SIMD
+    static void              c2b_tokenize_lines_sse2(c2b_block_t *block, char *src, ssize_t src_size);
+    static void              c2b_tokenize_lines_avx2(c2b_block_t *block, char *src, ssize_t src_size);
+#endif
+    static void              c2b_init_tokenizer();
+    static inline c2b_field_t c2b_line_field(const c2b_line_t *line, int idx);
+    static inline boolean    c2b_parse_uint64(c2b_field_t f, uint64_t *val);
+    static inline uint64_t   c2b_field_to_uint64(c2b_field_t f, const char *description);
+    static inline boolean    c2b_field_equals(c2b_field_t f, const char *s);
+    static const char *      c2b_field_find(c2b_field_t f, const char *s);
+    static inline void       c2b_convert_block(c2b_context_t *ctx, c2b_batch_t *dest, c2b_block_t *block, void (*line_converter)(c2b_context_t *, c2b_batch_t *, c2b_line_t *));
+    static void              c2b_init_batch(c2b_batch_t *b, ssize_t capacity, ssize_t flush_size, c2b_output_t *output);
+    static void              c2b_delete_batch(c2b_batch_t *b);
+    static inline void       c2b_batch_reset(c2b_batch_t *b);
+    static void              c2b_batch_reserve(c2b_batch_t *b, ssize_t size);
+    static inline void       c2b_batch_append(c2b_batch_t *b, const char *src, ssize_t src_size);
+    static void              c2b_batch_init_views(c2b_batch_t *b);
+    static void              c2b_batch_push_view(c2b_batch_t *b, const char *str, ssize_t size);
+    static inline void       c2b_batch_append_view(c2b_batch_t *b, const char *str, ssize_t size);
+    static inline void       c2b_batch_append_field(c2b_batch_t *b, c2b_field_t f, char delim);
+    static inline void       c2b_batch_append_str(c2b_batch_t *b, const char *s, char delim);
+    static inline void       c2b_batch_append_uint64(c2b_batch_t *b, uint64_t val, char delim);
+    static inline void       c2b_batch_append_int(c2b_batch_t *b, int val, char delim);
+    static inline void       c2b_batch_append_record(c2b_batch_t *b, const void *record, const c2b_column_t *columns, size_t num_columns);
+    static void              c2b_batch_append_header_line(c2b_batch_t *b, unsigned int line_idx, const char *id, const char *src, ssize_t src_size);
+    static void              c2b_batch_printf(c2b_batch_t *b, const char *format, ...);
+    static void              c2b_batch_flush(c2b_batch_t *b);
+    static void              c2b_process_bytes_by_lines(int src_fd, int dest_fd, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), c2b_sorter_t *sorter);
+    static void *            c2b_process_intermediate_bytes_by_lines_to_stdout(void *arg);
+    static boolean           c2b_chunk_engine_is_enabled();
+    static void              c2b_process_bytes_by_chunks(int src_fd, int dest_fd, void (*block_converter)(c2b_context_t *, c2b_batch_t *, c2b_block_t *), c2b_sorter_t *sorter);
+    static void *            c2b_chunk_engine_read(void *arg);
+    static void *            c2b_chunk_engine_convert(void *arg);
+    static void              c2b_relay_bytes(int src_fd, int dest_fd);
+    static void              c2b_init_sorter(c2b_sorter_t *s);
+    static void              c2b_delete_sorter(c2b_sorter_t *s);
+    static void              c2b_sorter_append(c2b_sorter_t *s, const char *buf, size_t len);
+    static inline void       c2b_sorter_add_line(c2b_sorter_t *s, const char *line, size_t len);
+    static void              c2b_sorter_add_header_line(c2b_sorter_t *s, const char *line, size_t len);
+    static void              c2b_sorter_rank_chromosome(c2b_sorter_t *s, const char *chr, uint32_t chr_len);
+    static c2b_sort_bucket_t * c2b_sorter_find_bucket(c2b_sorter_t *s, const char *chr, uint32_t chr_len);
+    static void              c2b_sorter_grow_slots(c2b_sorter_t *s);
+    static void              c2b_sort_bucket_grow_arena(c2b_sort_bucket_t *b, size_t len);
+    static void              c2b_sort_bucket_grow_keys(c2b_sort_bucket_t *b);
+    static void              c2b_sort_bucket_push_segment(c2b_sort_bucket_t *b, off_t offset, off_t size);
+    static void              c2b_sort_bucket_keep_last_line(c2b_sort_bucket_t *b);
+    static void              c2b_sort_bucket_sort(c2b_sort_bucket_t *b);
+    static inline void       c2b_sort_key_line(c2b_sort_key_t *key, const char *line, size_t len);
+    static inline int        c2b_sort_compare(const c2b_sort_key_t *a, const char *a_line, const c2b_sort_key_t *b, const char *b_line);
+    static c2b_sort_key_t *  c2b_sort_keys(c2b_sort_key_t *keys, c2b_sort_key_t *spare_keys, size_t num_keys, const char *arena);
+    static int               c2b_sort_bucket_compare(const void *a, const void *b);
+    static int               c2b_sort_bucket_compare_natural(const void *a, const void *b);
+    static void              c2b_sorter_start(c2b_sorter_t *s, boolean is_final);
+    static void              c2b_sorter_prepare_bucket(c2b_sorter_t *s, c2b_sort_bucket_t *b);
+    static void              c2b_sorter_write_bucket(c2b_sorter_t *s, c2b_sort_bucket_t *b, c2b_output_t *out);
+    static void *            c2b_sorter_sort_buckets(void *arg);
+    static c2b_sort_bucket_t * c2b_sorter_wait(c2b_sorter_t *s, size_t order_idx);
+    static void              c2b_sorter_finish(c2b_sorter_t *s);
+    static int               c2b_sorter_open_spill_file(c2b_sorter_t *s);
+    static off_t             c2b_sort_bucket_write_keys(c2b_sort_bucket_t *b, c2b_output_t *out);
+    static void              c2b_sorter_spill(c2b_sorter_t *s);
+    static boolean           c2b_sort_run_next(c2b_sort_run_t *r);
+    static void              c2b_sort_bucket_copy_segments(c2b_sorter_t *s, c2b_sort_bucket_t *b, c2b_output_t *out);
+    static off_t             c2b_sort_bucket_merge(c2b_sorter_t *s, c2b_sort_bucket_t *b, boolean with_keys, c2b_output_t *out);
+    static void              c2b_sorter_write_out(c2b_sorter_t *s, int dest_fd);
+    static void              c2b_init_starch_stream(c2b_starch_stream_t *st);
+    static void              c2b_delete_starch_stream(c2b_starch_stream_t *st);
+    static void              c2b_starch_stream_append(c2b_starch_stream_t *st, const char *buf, size_t len);
+    static inline void       c2b_starch_stream_add_line(c2b_starch_stream_t *st, const char *line, size_t len);
+    static void              c2b_starch_stream_compress(c2b_starch_stream_t *st, boolean is_final);
+    static void              c2b_starch_write_metadata(c2b_sorter_t *s, c2b_output_t *out, uint64_t offset);
+    static void              c2b_batch_append_json_str(c2b_batch_t *b, const char *s, size_t len);
+    static void              c2b_sha1(const unsigned char *data, size_t len, unsigned char *digest);
+    static void              c2b_base64_encode(const unsigned char *data, size_t len, char *dest);
     static void              c2b_memrchr_offset(ssize_t *offset, char *buf, ssize_t buf_size, ssize_t len, char delim);
     static void              c2b_init_pipeset(c2b_pipeset_t *p, const size_t num);
     static void              c2b_debug_pipeset(c2b_pipeset_t *p, const size_t num);
+    static void              c2b_debug_args(const char *name, char * const args[]);
     static void              c2b_delete_pipeset(c2b_pipeset_t *p);
     static void              c2b_set_close_exec_flag(int fd);
-    static void              c2b_unset_close_exec_flag(int fd);
     static int               c2b_pipe4(int fd[2], int flags);
-    static pid_t             c2b_popen4(const char* cmd, int pin[2], int pout[2], int perr[2], int flags);
+    static pid_t             c2b_popen4(char * const args[], int pin[2], int pout[2], int perr[2], int flags);
     static void              c2b_test_dependencies();
     static boolean           c2b_print_matches(char *path, char *fn);
     static char *            c2b_strsep(char **stringp, const char *delim);
     static boolean           c2b_is_there(char *candidate);
     static void              c2b_init_globals();
     static void              c2b_delete_globals();
-    static void              c2b_init_global_gff_state();
-    static void              c2b_delete_global_gff_state();
-    static void              c2b_init_global_gtf_state();
-    static void              c2b_delete_global_gtf_state();
-    static void              c2b_init_global_psl_state();
-    static void              c2b_delete_global_psl_state();
-    static void              c2b_init_global_rmsk_state();
-    static void              c2b_delete_global_rmsk_state();
+    static void              c2b_init_global_converter_options();
+    static void              c2b_init_context(c2b_context_t *ctx, const c2b_converter_options_t *options);
+    static void              c2b_delete_context(c2b_context_t *ctx);
+    static void              c2b_init_field_arena(c2b_field_arena_t *arena);
+    static void              c2b_delete_field_arena(c2b_field_arena_t *arena);
+    static void              c2b_reset_fields(c2b_context_t *ctx);
+    static char *            c2b_alloc_field(c2b_context_t *ctx, ssize_t size);
+    static inline char *     c2b_copy_field(c2b_context_t *ctx, const char *src, ssize_t size);
+    static void              c2b_grow_buffer(char **buf, ssize_t *capacity, ssize_t size, const char *description);
+    static void              c2b_init_gtf_state(c2b_gtf_state_t *gtf);
+    static void              c2b_delete_gtf_state(c2b_gtf_state_t *gtf);
+    static void              c2b_init_psl_state(c2b_psl_state_t *psl);
+    static void              c2b_delete_psl_state(c2b_psl_state_t *psl);
+    static void              c2b_init_rmsk_state(c2b_rmsk_state_t *rmsk);
     static void              c2b_init_global_sam_state();
     static void              c2b_delete_global_sam_state();
     static void              c2b_init_global_vcf_state();
     static void              c2b_delete_global_vcf_state();
-    static void              c2b_init_global_wig_state();
-    static void              c2b_delete_global_wig_state();
-    static void              c2b_init_global_cat_params();
-    static void              c2b_delete_global_cat_params();
+    static void              c2b_init_wig_state(c2b_wig_state_t *wig, const char *basename);
+    static void              c2b_delete_wig_state(c2b_wig_state_t *wig);
     static void              c2b_init_global_sort_params();
     static void              c2b_delete_global_sort_params();
     static void              c2b_init_global_starch_params();
     static void              c2b_delete_global_starch_params();
+    static c2b_io_engine_t   c2b_to_io_engine(const char *io_engine);
+    static c2b_sort_order_t  c2b_to_sort_order(const char *sort_order);
+    static void              c2b_init_input(c2b_input_t *in, int fd);
+    static ssize_t           c2b_input_read(c2b_input_t *in, char *buf, size_t len);
+    static void              c2b_delete_input(c2b_input_t *in);
+    static void              c2b_init_output(c2b_output_t *out, int fd);
+    static void              c2b_output_write(c2b_output_t *out, char *buf, size_t len);
+    static void              c2b_output_write_batch(c2b_output_t *out, c2b_batch_t *b);
+    static void              c2b_output_writev(c2b_output_t *out, struct iovec *iov, int iov_count);
+    static void              c2b_delete_output(c2b_output_t *out);
+#ifdef C2B_HAVE_IO_URING
+    static c2b_uring_t *     c2b_uring_init();
+    static void              c2b_uring_delete(c2b_uring_t *ring);
+    static void              c2b_uring_submit(c2b_uring_t *ring, int fd, size_t block_idx, unsigned char opcode, off_t offset, boolean is_linked);
+    static void              c2b_uring_enter(c2b_uring_t *ring, unsigned int to_submit, unsigned int min_complete);
+    static void              c2b_uring_reap(c2b_uring_t *ring);
+    static void              c2b_input_submit(c2b_input_t *in, size_t block_idx);
+    static void              c2b_input_resync(c2b_input_t *in);
+    static void              c2b_output_flush_batch(c2b_output_t *out);
+    static void              c2b_output_submit_batch(c2b_output_t *out, size_t first, size_t count);
+#endif
+    static void              c2b_init_global_src_map(struct stat *stats);
+    static void              c2b_delete_global_src_map();
+    static char *            c2b_next_mapped_lines(ssize_t *lines_size, ssize_t max_size);
+    static ssize_t           c2b_to_io_buffer_size(const char *io_buffer);
+    static size_t            c2b_to_max_mem(const char *max_mem);
+    static long              c2b_pipe_capacity();
+    static void              c2b_set_pipe_capacity(int fd, long capacity);
     static void              c2b_init_command_line_options(int argc, char **argv);
     static void              c2b_print_version(FILE *stream);
     static void              c2b_print_usage(FILE *stream);
@@ -12,6 +12,14 @@ ${gff2bed_bin} < ${sample_gff_fn} > ${observed_sorted_bed_fn} 2> /dev/null
 diff -q ${expected_sorted_bed_fn} ${observed_sorted_bed_fn}
 rm -f ${observed_sorted_bed_fn}
 
+echo "[gff2bed] testing sorted output in natural order..."
+sample_gff_fn="natural_order.gff"
+expected_sorted_bed_fn="natural_order.expected.bed"
+observed_sorted_bed_fn="$(mktemp /tmp/XXXXXX)"
+${gff2bed_bin} --sort-order=natural < ${sample_gff_fn} > ${observed_sorted_bed_fn} 2> /dev/null
+diff -q ${expected_sorted_bed_fn} ${observed_sorted_bed_fn}
+rm -f ${observed_sorted_bed_fn}
+
 echo "[gff2bed] testing starch (bzip2) output..."
 sample_gff_fn="sample.gff"
 expected_starch_fn="sample.expected.starch"
@@ -20,6 +20,28 @@ ${sam2bed_bin} --split < ${split_sam_fn} > ${observed_split_bed_fn} 2> /dev/null
 diff -q ${expected_split_bed_fn} ${observed_split_bed_fn}
 rm -f ${observed_split_bed_fn}
 
+echo "[sam2bed] testing split output with multiple threads..."
+split_sam_fn="split.sam"
+expected_split_bed_fn="split.expected.bed"
+observed_split_bed_fn="$(mktemp /tmp/XXXXXX)"
+${sam2bed_bin} --split --threads=4 < ${split_sam_fn} > ${observed_split_bed_fn} 2> /dev/null
+diff -q ${expected_split_bed_fn} ${observed_split_bed_fn}
+rm -f ${observed_split_bed_fn}
+
+echo "[sam2bed] testing sorted output in header order..."
+sample_sam_fn="header_order.sam"
+expected_sorted_bed_fn="header_order.expected.bed"
+observed_sorted_bed_fn="$(mktemp /tmp/XXXXXX)"
+${sam2bed_bin} --sort-order=header < ${sample_sam_fn} > ${observed_sorted_bed_fn} 2> /dev/null
+diff -q ${expected_sorted_bed_fn} ${observed_sorted_bed_fn}
+rm -f ${observed_sorted_bed_fn}
+
+echo "[sam2bed] testing malformed input..."
+malformed_sam_fn="malformed.sam"
+if ${sam2bed_bin} < ${malformed_sam_fn} > /dev/null 2>&1; then
+    echo "Malformed input ${malformed_sam_fn} was not rejected"
+fi
+
 echo "[sam2bed] testing starch (bzip2) output..."
 sample_sam_fn="sample.sam"
 expected_starch_fn="sample.expected.starch"
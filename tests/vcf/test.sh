@@ -12,6 +12,22 @@ ${vcf2bed_bin} < ${sample_split_vcf_fn} > ${observed_split_sorted_bed_fn} 2> /de
 diff -q ${expected_split_sorted_bed_fn} ${observed_split_sorted_bed_fn}
 rm -f ${observed_split_sorted_bed_fn}
 
+echo "[vcf2bed] testing sorted and split output with multiple threads..."
+sample_split_vcf_fn="sample.vcf"
+expected_split_sorted_bed_fn="sample.expected.split.bed"
+observed_split_sorted_bed_fn="$(mktemp /tmp/XXXXXX)"
+${vcf2bed_bin} --threads=4 < ${sample_split_vcf_fn} > ${observed_split_sorted_bed_fn} 2> /dev/null
+diff -q ${expected_split_sorted_bed_fn} ${observed_split_sorted_bed_fn}
+rm -f ${observed_split_sorted_bed_fn}
+
+echo "[vcf2bed] testing sorted and split output through io_uring..."
+sample_split_vcf_fn="sample.vcf"
+expected_split_sorted_bed_fn="sample.expected.split.bed"
+observed_split_sorted_bed_fn="$(mktemp /tmp/XXXXXX)"
+${vcf2bed_bin} --io-engine=io_uring < ${sample_split_vcf_fn} > ${observed_split_sorted_bed_fn} 2> /dev/null
+diff -q ${expected_split_sorted_bed_fn} ${observed_split_sorted_bed_fn}
+rm -f ${observed_split_sorted_bed_fn}
+
 echo "[vcf2bed] testing sorted and no-split output..."
 sample_nosplit_vcf_fn="sample.vcf"
 expected_nosplit_sorted_bed_fn="sample.expected.nosplit.bed"